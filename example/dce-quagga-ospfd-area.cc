@@ -23,6 +23,11 @@
 #include "ns3/internet-module.h"
 #include "ns3/dce-module.h"
 #include "ns3/quagga-helper.h"
+#include "ns3/linux-link-control-helper.h"
+#include "ns3/ip-batch-helper.h"
+#include "ns3/convergence-monitor.h"
+#include "ns3/fib-snapshot-helper.h"
+#include "ns3/link-address-allocator.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/topology-read-module.h"
 #include <memory>
@@ -58,6 +63,8 @@ SetRlimit ()
 
 // Parameters
 uint32_t stopTime = 200;
+std::string convergenceFile = "";
+double fibSnapshotInterval = 0;
 int area_h = 2; // area row height
 int area_w = 2; // area col width
 int stripes_w = 1; // strip width
@@ -90,80 +97,17 @@ int AreaId(int id) {
   return 1 + ax * area_c + ay;
 }
 
-// Static functions for linux stack
-static void RunIp (Ptr<Node> node, Time at, std::string str)
-{
-  DceApplicationHelper process;
-  ApplicationContainer apps;
-  process.SetBinary ("ip");
-  process.SetStackSize (1 << 16);
-  process.ResetArguments ();
-  process.ParseArguments (str.c_str ());
-  // std::cout << "T = " << at.GetSeconds() << " " << str << std::endl;
-  apps = process.Install (node);
-  apps.Start (at);
-}
-
-static void AddAddress (Ptr<Node> node, Time at, const char *name, const char *address)
-{
-  std::ostringstream oss;
-  oss << "-f inet addr add " << address << " dev " << name;
-  RunIp (node, at, oss.str ());
-}
-
-// Genereate a pair of address of 10.0.0.0/30 by link id
-std::pair<std::string, std::string> RawAddressHelper(int link_id) {
-  int base_ip = link_id * 4;
-  std::stringstream ss1; // 10.0.0.1/30
-  std::stringstream ss2; // 10.0.0.2/30
-  base_ip++;
-  ss1 << "10." << base_ip / (256 * 256) << "." << (base_ip / 256) % 256 << "." << base_ip % 256 << "/30";
-  base_ip++;
-  ss2 << "10." << base_ip / (256 * 256) << "." << (base_ip / 256) % 256 << "." << base_ip % 256 << "/30";
-  return std::make_pair(ss1.str(), ss2.str());
-}
-
-// Genereate a pair of address of 10.<area>.0.0/30 by link id
-std::pair<std::string, std::string> AreaAddressHelper(int area, int link_id) {
-  int base_ip = link_id * 4;
-  std::stringstream ss1; // 10.area.0.1/30
-  std::stringstream ss2; // 10.area.0.2/30
-  base_ip++;
-  ss1 << "10." << area << "." << (base_ip / 256) % 256 << "." << base_ip % 256 << "/30";
-  base_ip++;
-  ss2 << "10." << area << "." << (base_ip / 256) % 256 << "." << base_ip % 256 << "/30";
-  return std::make_pair(ss1.str(), ss2.str());
-}
-
-void AssignIP(int ms, int link_id, NetDeviceContainer nd, bool enabled) {
-  // Assert size
-  auto node1 = nd.Get(0)->GetNode();
-  auto node2 = nd.Get(1)->GetNode();
-  std::string if1 = "sim" + std::to_string(nd.Get(0)->GetIfIndex());
-  std::string if2 = "sim" + std::to_string(nd.Get(1)->GetIfIndex());
-  std::string cmd1 = "link set " + if1 +" up";
-  std::string cmd2 = "link set " + if2 +" up";
-
-  AddAddress (node1, MilliSeconds (ms), if1.c_str(), RawAddressHelper(link_id).first.c_str());
-  if (enabled) {
-    RunIp (node1, MilliSeconds (ms + 1), cmd1.c_str());
-  }
-  AddAddress (node2, MilliSeconds (ms), if2.c_str(), RawAddressHelper(link_id).second.c_str());
-  if (enabled) {
-    RunIp (node2, MilliSeconds (ms + 1), cmd2.c_str());
-  }
-  printf("Assigned addresses: %s %s\n", RawAddressHelper(link_id).first.c_str(), RawAddressHelper(link_id).second.c_str());
-  printf("Assigned commands: %s %s\n", cmd1.c_str(), cmd2.c_str());
-}
+// Address and link state changes go through netlink, no ip process
+LinuxLinkControlHelper linkControl;
+// Route dumps are grouped into one ip -batch process per node and time
+IpBatchHelper ipBatch;
+// One /30 pool per area, 10.<area>.0.0/16
+LinkAddressAllocator addresses;
 
-void AssignIPArea(int ms, int link_id, NetDeviceContainer nd, bool enabled) {
+void AssignIPArea(int ms, NetDeviceContainer nd, bool enabled) {
   // Assert size
   auto node1 = nd.Get(0)->GetNode();
   auto node2 = nd.Get(1)->GetNode();
-  std::string if1 = "sim" + std::to_string(nd.Get(0)->GetIfIndex());
-  std::string if2 = "sim" + std::to_string(nd.Get(1)->GetIfIndex());
-  std::string cmd1 = "link set " + if1 +" up";
-  std::string cmd2 = "link set " + if2 +" up";
 
   // Set area if both nodes are not backbone
   /*
@@ -174,48 +118,38 @@ void AssignIPArea(int ms, int link_id, NetDeviceContainer nd, bool enabled) {
     area = AreaId(node1->GetId()); // both nodes should have same id
     printf("! %d\n", area);
   }
-  AddAddress (node1, MilliSeconds (ms), if1.c_str(), AreaAddressHelper(area, link_id).first.c_str());
-  if (enabled) {
-    RunIp (node1, MilliSeconds (ms + 1), cmd1.c_str());
-  }
-  AddAddress (node2, MilliSeconds (ms), if2.c_str(), AreaAddressHelper(area, link_id).second.c_str());
+  // pool <area> is 10.<area>.0.0/16
+  uint32_t link = addresses.Assign (linkControl, nd, area, MilliSeconds (ms));
   if (enabled) {
-    RunIp (node2, MilliSeconds (ms + 1), cmd2.c_str());
+    linkControl.SetLinkUp (nd, MilliSeconds (ms + 1));
   }
-  printf("Assigned addresses: %s %s\n", AreaAddressHelper(area, link_id).first.c_str(), AreaAddressHelper(AreaId(node2->GetId()), link_id).second.c_str());
-  printf("Assigned commands: %s %s\n", cmd1.c_str(), cmd2.c_str());
+  std::cout << "Assigned addresses: " << addresses.GetAddress (link, 0) << " "
+            << addresses.GetAddress (link, 1) << std::endl;
 }
 
 void LinkUp(int ms, Ptr<Node> node, int if_id) {
-  std::string ifn = "sim" + std::to_string(if_id);;
-  std::string cmd = "link set " + ifn + " up";
-  RunIp (node, MilliSeconds (ms), cmd.c_str());
+  linkControl.SetLinkUp (node->GetDevice(if_id), MilliSeconds (ms));
 }
 
 void LinkDown(int ms, Ptr<Node> node, int if_id) {
-  std::string ifn = "sim" + std::to_string(if_id);
-  std::string cmd = "link set " + ifn + " down";
-  RunIp (node, MilliSeconds (ms), cmd.c_str());
+  linkControl.SetLinkDown (node->GetDevice(if_id), MilliSeconds (ms));
 }
 
 void LinkDown(int ms, NetDeviceContainer ndc) {
   if (ndc.GetN() < 2) return;
-  LinkDown(ms, ndc.Get(0)->GetNode(), ndc.Get(0)->GetIfIndex());
-  LinkDown(ms, ndc.Get(1)->GetNode(), ndc.Get(1)->GetIfIndex());
+  linkControl.SetLinkDown (ndc, MilliSeconds (ms));
 }
 
 void PrintRouteAt(int t, Ptr<Node> node) {
-  RunIp (node, MilliSeconds (t * 1000), "link show");
-  RunIp (node, MilliSeconds (t * 1000 + 10), "route show table all");
-  RunIp (node, MilliSeconds (t * 1000 + 20), "addr list");
+  ipBatch.Add (node, Seconds (t), "link show");
+  ipBatch.Add (node, Seconds (t), "route show table all");
+  ipBatch.Add (node, Seconds (t), "addr list");
 }
 
 void PrintAllRouteAt(int t, NodeContainer nc) {
-  for (int i = 0; i < nc.GetN(); i++) {
-    RunIp (nc.Get(i), MilliSeconds (t * 1000), "link show");
-    RunIp (nc.Get(i), MilliSeconds (t * 1000 + 10), "route show table all");
-    RunIp (nc.Get(i), MilliSeconds (t * 1000 + 20), "addr list");
-  }
+  ipBatch.Add (nc, Seconds (t), "link show");
+  ipBatch.Add (nc, Seconds (t), "route show table all");
+  ipBatch.Add (nc, Seconds (t), "addr list");
 }
 
 void printTime(int t) {
@@ -233,6 +167,8 @@ main (int argc, char *argv[])
 
   CommandLine cmd;
   cmd.AddValue ("stopTime", "Time to stop(seconds)", stopTime);
+  cmd.AddValue ("convergenceFile", "Write the convergence report (CSV, or JSON for *.json) to this file", convergenceFile);
+  cmd.AddValue ("fibSnapshotInterval", "Snapshot all FIBs to fib-snapshots.bin every interval(seconds), 0 to disable", fibSnapshotInterval);
   cmd.Parse (argc,argv);
 
   Ptr<TopologyReader> inFile = 0;
@@ -306,35 +242,30 @@ main (int argc, char *argv[])
                                   "Library", StringValue ("liblinux.so"));
   
   QuaggaHelper quagga;
+  Ptr<ConvergenceMonitor> monitor = CreateObject<ConvergenceMonitor> ();
   processManager.Install (nodes);
 
   // IP Configuration
   // Set up loop backs
-  for (int i = 0; i < row * col; i++) {
-    RunIp (nodes.Get(i), MilliSeconds (10001), "link set lo up");
-  }
+  linkControl.SetLoopbackUp (nodes, MilliSeconds (10001));
 
-  // Set up area 0 as 10.0.0.0/16 each link is /30
+  // Set up area j as 10.j.0.0/16 each link is /30
+  for (int j = 0; j < n_area + 1; j++) {
+    std::string str = "10." + std::to_string(j) + ".0.0";
+    addresses.AddPool (Ipv4Address (str.c_str()), Ipv4Mask ("/16"));
+  }
   for (int i = 0; i < link_intra; i++) {
-    AssignIPArea(10000 + i * 4, i, nd_intra[i], true);
+    AssignIPArea(10000 + i * 4, nd_intra[i], true);
   }
   for (int i = 0; i < link_inter; i++) {
-    AssignIPArea(10000 + i * 4, i, nd_inter[i], true);
+    AssignIPArea(10000 + i * 4, nd_inter[i], true);
   }
   for (int i = 0; i < link_border; i++) {
-    AssignIPArea(10000 + i * 4, link_inter + i, nd_border[i], true);
+    AssignIPArea(10000 + i * 4, nd_border[i], true);
   }
 
-  // for (int i = 0; i < row * col; i++) {
-  //   RunIp (nodes.Get(i), MilliSeconds (10001), "link set lo up");
-  // }
-  // for (int i = 0; i < row * col; i++) {
-  //   AssignIP(10000 + i * 4, i, ndc[i], true);
-  // }
-  // for (int i = 0; i < row * col; i++) {
-  //   AssignIP(10002 + i * 4, row * col + i, ndr[i], true);
-  // }
   LinkDown(135 * 1000, nd_inter[0]);
+  monitor->MarkEvent (Seconds (135), "link-down");
   // LinkDown(100 * 1000, ndc[2]);
   // LinkDown(100 * 1000, ndr[0]);
   // LinkDown(100 * 1000, ndr[6]);
@@ -379,6 +310,22 @@ main (int argc, char *argv[])
   }
   // PrintAllRouteAt(10, nodes);
   // PrintAllRouteAt(80, nodes);
+  ipBatch.Install ();
+
+  // Routing convergence after each event, read from the nodes' FIBs
+  if (!convergenceFile.empty ())
+    {
+      monitor->Install (nodes);
+      monitor->Start (Seconds (10));
+    }
+  // Routing tables read from the stacks, no ip process per node
+  if (fibSnapshotInterval > 0)
+    {
+      Ptr<FibSnapshotHelper> fibSnapshot = CreateObject<FibSnapshotHelper> ();
+      NS_ABORT_MSG_IF (!fibSnapshot->Open ("fib-snapshots.bin"), "cannot create fib-snapshots.bin");
+      fibSnapshot->Install (nodes);
+      fibSnapshot->SnapshotEvery (Seconds (10), Seconds (fibSnapshotInterval), Seconds (stopTime));
+    }
   //
   // Step 9
   // Now It's ready to GO!
@@ -388,6 +335,10 @@ main (int argc, char *argv[])
       Simulator::Stop (Seconds (stopTime));
     }
   Simulator::Run ();
+  if (!convergenceFile.empty ())
+    {
+      monitor->Write (convergenceFile);
+    }
   Simulator::Destroy ();
 
   return 0;
@@ -0,0 +1,295 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+ * One run of the ospfd benchmark: build a topology (grid, LEO torus,
+ * Rocketfuel or CAIDA), run zebra/ospfd on every node with the Linux
+ * stack, fail one link and append a CSV line with the wall time, the
+ * simulated events per second, the peak RSS, the number of processes
+ * and the OSPF convergence times to the results file.
+ *
+ * utils/bench-ospfd.sh sweeps this over topologies, sizes, fiber
+ * managers and loaders.
+ */
+
+#include "ns3/network-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dce-module.h"
+#include "ns3/quagga-helper.h"
+#include "ns3/quagga-start-policy.h"
+#include "ns3/linux-link-control-helper.h"
+#include "ns3/link-address-allocator.h"
+#include "ns3/leo-constellation-helper.h"
+#include "ns3/convergence-monitor.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/topology-read-module.h"
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/time.h>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("quagga-ospfd-bench");
+
+// Parameters
+std::string topology = "grid";
+uint32_t nNodes = 36;
+std::string topoFile = "";
+std::string fiberManager = "UcontextFiberManager";
+std::string loader = "cooja";
+uint32_t stopTime = 200;
+uint32_t failureTime = 135;
+std::string results = "bench-ospfd.csv";
+std::string commit = "unknown";
+std::string configStore = "";
+std::string startPolicy = "ns3::QuaggaUniformStartPolicy";
+
+static void
+SetRlimit ()
+{
+  int ret;
+  struct rlimit limit;
+  limit.rlim_cur = 100000;
+  limit.rlim_max = 100000;
+
+  ret = setrlimit (RLIMIT_NOFILE, &limit);
+  if (ret == -1)
+    {
+      perror ("setrlimit");
+    }
+  return;
+}
+
+static double
+WallClock (void)
+{
+  struct timeval tv;
+  gettimeofday (&tv, 0);
+  return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// rows x cols routers, each linked to its right and lower neighbour
+static NodeContainer
+CreateGrid (uint32_t n, std::vector<NetDeviceContainer> &links)
+{
+  uint32_t cols = std::ceil (std::sqrt (static_cast<double> (n)));
+  uint32_t rows = (n + cols - 1) / cols;
+  NodeContainer nodes;
+  nodes.Create (rows * cols);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  for (uint32_t r = 0; r < rows; r++)
+    {
+      for (uint32_t c = 0; c < cols; c++)
+        {
+          uint32_t i = r * cols + c;
+          if (c + 1 < cols)
+            {
+              links.push_back (p2p.Install (nodes.Get (i), nodes.Get (i + 1)));
+            }
+          if (r + 1 < rows)
+            {
+              links.push_back (p2p.Install (nodes.Get (i), nodes.Get (i + cols)));
+            }
+        }
+    }
+  return nodes;
+}
+
+// the closest square constellation: as many planes as satellites per plane
+static NodeContainer
+CreateLeo (uint32_t n, std::vector<NetDeviceContainer> &links)
+{
+  uint32_t side = std::max (3u, static_cast<uint32_t> (std::ceil (std::sqrt (static_cast<double> (n)))));
+  LeoConstellationHelper leo (side, side);
+  leo.SetIslChannelAttribute ("Delay", StringValue ("2ms"));
+  leo.SetIslDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  NodeContainer nodes = leo.Create ();
+  for (uint32_t i = 0; i < leo.GetNLinks (); i++)
+    {
+      links.push_back (leo.GetLink (i));
+    }
+  return nodes;
+}
+
+// Rocketfuel or Caida file, read with the topology-read module
+static NodeContainer
+ReadTopology (std::string format, std::string input, std::vector<NetDeviceContainer> &links)
+{
+  TopologyReaderHelper topoHelp;
+  topoHelp.SetFileName (input);
+  topoHelp.SetFileType (format);
+  Ptr<TopologyReader> inFile = topoHelp.GetTopologyReader ();
+  NS_ABORT_MSG_IF (inFile == 0, "no " << format << " topology reader");
+
+  NodeContainer nodes = inFile->Read ();
+  NS_ABORT_MSG_IF (nodes.GetN () == 0 || inFile->LinksSize () == 0,
+                   "problems reading the topology file " << input);
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  for (TopologyReader::ConstLinksIterator iter = inFile->LinksBegin ();
+       iter != inFile->LinksEnd (); iter++)
+    {
+      links.push_back (p2p.Install (iter->GetFromNode (), iter->GetToNode ()));
+    }
+  return nodes;
+}
+
+int
+main (int argc, char *argv[])
+{
+  CommandLine cmd;
+  cmd.AddValue ("topology", "Topology: grid, leo, rocketfuel or caida", topology);
+  cmd.AddValue ("nodes", "Number of routers of the grid and leo topologies", nNodes);
+  cmd.AddValue ("topoFile", "Topology file of the rocketfuel and caida topologies", topoFile);
+  cmd.AddValue ("fiberManager", "Fiber manager: PthreadFiberManager or UcontextFiberManager", fiberManager);
+  cmd.AddValue ("loader", "Loader: cooja or dlm (dlm has to run under dce-runner)", loader);
+  cmd.AddValue ("stopTime", "Time to stop(seconds)", stopTime);
+  cmd.AddValue ("failureTime", "Time to bring one link down(seconds), 0 for no failure", failureTime);
+  cmd.AddValue ("results", "CSV file the results are appended to", results);
+  cmd.AddValue ("commit", "Revision the results are recorded for", commit);
+  cmd.AddValue ("startPolicy", "Daemon start-time policy (ns3::Quagga*StartPolicy)", startPolicy);
+  cmd.AddValue ("configStore", "Directory (e.g. on /dev/shm) to keep the daemon configs in", configStore);
+  cmd.Parse (argc,argv);
+
+  SetRlimit ();
+  double wallStart = WallClock ();
+
+  // Set up topology
+  std::vector<NetDeviceContainer> links;
+  NodeContainer nodes;
+  if (topology == "grid")
+    {
+      nodes = CreateGrid (nNodes, links);
+    }
+  else if (topology == "leo")
+    {
+      nodes = CreateLeo (nNodes, links);
+    }
+  else if (topology == "rocketfuel")
+    {
+      nodes = ReadTopology ("Rocketfuel", topoFile.empty ()
+                            ? "myscripts/ns-3-dce-quagga/example/3967.weights.intra" : topoFile,
+                            links);
+    }
+  else if (topology == "caida")
+    {
+      nodes = ReadTopology ("Caida", topoFile.empty ()
+                            ? "myscripts/ns-3-dce-quagga/example/asrel-as2500.txt" : topoFile,
+                            links);
+    }
+  else
+    {
+      NS_ABORT_MSG ("unknown topology " << topology);
+    }
+  NS_ABORT_MSG_IF (links.empty (), "topology " << topology << " has no links");
+
+  // Internet stack installation
+  DceManagerHelper processManager;
+  processManager.SetTaskManagerAttribute ("FiberManagerType",
+                                          StringValue (fiberManager));
+  if (loader == "dlm")
+    {
+      processManager.SetLoader ("ns3::DlmLoaderFactory");
+    }
+  else
+    {
+      NS_ABORT_MSG_IF (loader != "cooja", "unknown loader " << loader);
+      processManager.SetLoader ("ns3::CoojaLoaderFactory");
+    }
+  processManager.SetNetworkStack ("ns3::LinuxSocketFdFactory",
+                                  "Library", StringValue ("liblinux.so"));
+  processManager.Install (nodes);
+
+  // Address configuration through netlink, at 10 s
+  LinuxLinkControlHelper linkControl;
+  LinkAddressAllocator addresses;
+  uint32_t pool = addresses.AddPool (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"));
+  NS_ABORT_MSG_IF (addresses.GetNFree (pool) < links.size (), "too many links for 10.0.0.0/8");
+  addresses.Reserve (pool, links.size ());
+  linkControl.SetLoopbackUp (nodes, Seconds (10));
+  for (uint32_t i = 0; i < links.size (); i++)
+    {
+      addresses.Assign (linkControl, links[i], pool, Seconds (10));
+      linkControl.SetLinkUp (links[i], Seconds (10) + MilliSeconds (1));
+    }
+
+  QuaggaHelper quagga;
+  quagga.SetConfigStore (configStore);
+  ObjectFactory policy;
+  policy.SetTypeId (startPolicy);
+  quagga.SetStartPolicy (policy.Create<QuaggaStartPolicy> ());
+  quagga.EnableOspf (nodes, "10.0.0.0/8");
+  ApplicationContainer apps = quagga.Install (nodes);
+  quagga.PrintMemoryReport (std::cout);
+
+  // Initial convergence and convergence after the failure of one link
+  Ptr<ConvergenceMonitor> monitor = CreateObject<ConvergenceMonitor> ();
+  monitor->Install (nodes);
+  monitor->Start (Seconds (10));
+  if (failureTime > 0 && failureTime < stopTime)
+    {
+      linkControl.SetLinkDown (links[links.size () / 2], Seconds (failureTime));
+      monitor->MarkEvent (Seconds (failureTime), "link-down");
+    }
+
+  double wallSetup = WallClock ();
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+  double wallEnd = WallClock ();
+  uint64_t events = Simulator::GetEventCount ();
+
+  struct rusage usage;
+  getrusage (RUSAGE_SELF, &usage);
+
+  std::ostringstream line;
+  line << commit << "," << topology << "," << nodes.GetN () << "," << links.size ()
+       << "," << fiberManager << "," << loader << "," << stopTime
+       << "," << wallSetup - wallStart << "," << wallEnd - wallSetup
+       << "," << events << "," << events / std::max (wallEnd - wallSetup, 1e-6)
+       << "," << usage.ru_maxrss << "," << apps.GetN ()
+       << "," << monitor->GetConvergenceTime (0).GetSeconds ()
+       << "," << (monitor->GetNEvents () > 1 ? monitor->GetConvergenceTime (1).GetSeconds () : 0)
+       << "," << monitor->GetNUpdates (0) << "," << startPolicy;
+
+  // header only for a new file, so runs of many revisions share one file
+  std::ifstream existing (results.c_str ());
+  bool header = !existing.good () || existing.peek () == std::ifstream::traits_type::eof ();
+  existing.close ();
+  std::ofstream os (results.c_str (), std::ios::app);
+  NS_ABORT_MSG_IF (!os, "cannot write " << results);
+  if (header)
+    {
+      os << "commit,topology,nodes,links,fiber_manager,loader,stop_time_s,setup_s,wall_s,"
+         << "events,events_per_s,peak_rss_kb,processes,initial_convergence_s,"
+         << "failure_convergence_s,initial_fib_updates,start_policy" << std::endl;
+    }
+  os << line.str () << std::endl;
+  std::cout << line.str () << std::endl;
+
+  Simulator::Destroy ();
+
+  return 0;
+}
@@ -23,6 +23,14 @@
 #include "ns3/internet-module.h"
 #include "ns3/dce-module.h"
 #include "ns3/quagga-helper.h"
+#include "ns3/linux-link-control-helper.h"
+#include "ns3/leo-constellation-helper.h"
+#include "ns3/leo-isl-delay-updater.h"
+#include "ns3/link-event-trace-replayer.h"
+#include "ns3/ip-batch-helper.h"
+#include "ns3/convergence-monitor.h"
+#include "ns3/fib-snapshot-helper.h"
+#include "ns3/ospf-cost-updater.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/topology-read-module.h"
 #include <memory>
@@ -58,90 +66,64 @@ SetRlimit ()
 
 // Parameters
 uint32_t stopTime = 200;
-
-// Static functions for linux stack
-static void RunIp (Ptr<Node> node, Time at, std::string str)
-{
-  DceApplicationHelper process;
-  ApplicationContainer apps;
-  process.SetBinary ("ip");
-  process.SetStackSize (1 << 16);
-  process.ResetArguments ();
-  process.ParseArguments (str.c_str ());
-  // std::cout << "T = " << at.GetSeconds() << " " << str << std::endl;
-  apps = process.Install (node);
-  apps.Start (at);
-}
-
-static void AddAddress (Ptr<Node> node, Time at, const char *name, const char *address)
-{
-  std::ostringstream oss;
-  oss << "-f inet addr add " << address << " dev " << name;
-  RunIp (node, at, oss.str ());
-}
-
-// Genereate a pair of address of 10.0.0.0/30 by link id
-std::pair<std::string, std::string> RawAddressHelper(int link_id) {
-  int base_ip = link_id * 4;
-  std::stringstream ss1; // 10.0.0.1/30
-  std::stringstream ss2; // 10.0.0.2/30
-  base_ip++;
-  ss1 << "10." << base_ip / (256 * 256) << "." << (base_ip / 256) % 256 << "." << base_ip % 256 << "/30";
-  base_ip++;
-  ss2 << "10." << base_ip / (256 * 256) << "." << (base_ip / 256) % 256 << "." << base_ip % 256 << "/30";
-  return std::make_pair(ss1.str(), ss2.str());
-}
-
-void AssignIP(int ms, int link_id, NetDeviceContainer nd, bool enabled) {
-  // Assert size
-  auto node1 = nd.Get(0)->GetNode();
-  auto node2 = nd.Get(1)->GetNode();
-  std::string if1 = "sim" + std::to_string(nd.Get(0)->GetIfIndex());
-  std::string if2 = "sim" + std::to_string(nd.Get(1)->GetIfIndex());
-  std::string cmd1 = "link set " + if1 +" up";
-  std::string cmd2 = "link set " + if2 +" up";
-
-  AddAddress (node1, MilliSeconds (ms), if1.c_str(), RawAddressHelper(link_id).first.c_str());
-  if (enabled) {
-    RunIp (node1, MilliSeconds (ms + 1), cmd1.c_str());
-  }
-  AddAddress (node2, MilliSeconds (ms), if2.c_str(), RawAddressHelper(link_id).second.c_str());
-  if (enabled) {
-    RunIp (node2, MilliSeconds (ms + 1), cmd2.c_str());
-  }
-  printf("Assigned addresses: %s %s\n", RawAddressHelper(link_id).first.c_str(), RawAddressHelper(link_id).second.c_str());
-  printf("Assigned commands: %s %s\n", cmd1.c_str(), cmd2.c_str());
-}
+std::string convergenceFile = "";
+double fibSnapshotInterval = 0;
+uint32_t planes = 6;
+uint32_t satsPerPlane = 6;
+uint32_t phasing = 1;
+double altitude = 550.0;
+double inclination = 53.0;
+double delayStep = 0.1;
+std::string linkTrace = "";
+uint32_t helloInterval = 0;
+uint32_t deadInterval = 0;
+double costInterval = 0;
+uint32_t costThreshold = 1;
+uint32_t neighborTime = 0;
+
+// Address and link state changes go through netlink, no ip process
+LinuxLinkControlHelper linkControl;
+// Route dumps are grouped into one ip -batch process per node and time
+IpBatchHelper ipBatch;
 
 void LinkUp(int ms, Ptr<Node> node, int if_id) {
-  std::string ifn = "sim" + std::to_string(if_id);;
-  std::string cmd = "link set " + ifn + " up";
-  RunIp (node, MilliSeconds (ms), cmd.c_str());
+  linkControl.SetLinkUp (node->GetDevice(if_id), MilliSeconds (ms));
 }
 
 void LinkDown(int ms, Ptr<Node> node, int if_id) {
-  std::string ifn = "sim" + std::to_string(if_id);
-  std::string cmd = "link set " + ifn + " down";
-  RunIp (node, MilliSeconds (ms), cmd.c_str());
+  linkControl.SetLinkDown (node->GetDevice(if_id), MilliSeconds (ms));
 }
 
 void LinkDown(int ms, NetDeviceContainer ndc) {
   if (ndc.GetN() < 2) return;
-  LinkDown(ms, ndc.Get(0)->GetNode(), ndc.Get(0)->GetIfIndex());
-  LinkDown(ms, ndc.Get(1)->GetNode(), ndc.Get(1)->GetIfIndex());
+  linkControl.SetLinkDown (ndc, MilliSeconds (ms));
 }
 
 void PrintRouteAt(int t, Ptr<Node> node) {
-  RunIp (node, MilliSeconds (t * 1000), "link show");
-  RunIp (node, MilliSeconds (t * 1000 + 10), "route show table all");
-  RunIp (node, MilliSeconds (t * 1000 + 20), "addr list");
+  ipBatch.Add (node, Seconds (t), "link show");
+  ipBatch.Add (node, Seconds (t), "route show table all");
+  ipBatch.Add (node, Seconds (t), "addr list");
 }
 
 void PrintAllRouteAt(int t, NodeContainer nc) {
-  for (int i = 0; i < nc.GetN(); i++) {
-    RunIp (nc.Get(i), MilliSeconds (t * 1000), "link show");
-    RunIp (nc.Get(i), MilliSeconds (t * 1000 + 10), "route show table all");
-    RunIp (nc.Get(i), MilliSeconds (t * 1000 + 20), "addr list");
+  ipBatch.Add (nc, Seconds (t), "link show");
+  ipBatch.Add (nc, Seconds (t), "route show table all");
+  ipBatch.Add (nc, Seconds (t), "addr list");
+}
+
+// Full adjacencies and nodes answering "show ip ospf neighbor"
+uint32_t fullNeighbors = 0;
+uint32_t neighborAnswers = 0;
+
+void CountNeighbors (uint32_t nodeId, std::string command, bool ok, std::string output) {
+  if (!ok) {
+    NS_LOG_WARN ("node " << nodeId << ": no answer to " << command);
+    return;
+  }
+  neighborAnswers++;
+  for (std::string::size_type i = output.find ("Full/"); i != std::string::npos;
+       i = output.find ("Full/", i + 1)) {
+    fullNeighbors++;
   }
 }
 
@@ -153,47 +135,28 @@ main (int argc, char *argv[])
 {
   // SetRlimit ();
   //  LogComponentEnable ("quagga-ospfd-rocketfuel", LOG_LEVEL_INFO);
-  int row = 6;
-  int col = 6;
   CommandLine cmd;
   cmd.AddValue ("stopTime", "Time to stop(seconds)", stopTime);
+  cmd.AddValue ("convergenceFile", "Write the convergence report (CSV, or JSON for *.json) to this file", convergenceFile);
+  cmd.AddValue ("fibSnapshotInterval", "Snapshot all FIBs to fib-snapshots.bin every interval(seconds), 0 to disable", fibSnapshotInterval);
+  cmd.AddValue ("planes", "Number of orbital planes", planes);
+  cmd.AddValue ("satsPerPlane", "Number of satellites per plane", satsPerPlane);
+  cmd.AddValue ("phasing", "Walker phasing factor", phasing);
+  cmd.AddValue ("altitude", "Orbit altitude(km)", altitude);
+  cmd.AddValue ("inclination", "Orbit inclination(degrees)", inclination);
+  cmd.AddValue ("delayStep", "ISL delay update interval(seconds), 0 for fixed delays; off with a linkTrace", delayStep);
+  cmd.AddValue ("linkTrace", "Link event trace (CSV or binary) to replay on the ISLs, which also sets their delays", linkTrace);
+  cmd.AddValue ("helloInterval", "OSPF hello interval(seconds), 0 for the Quagga default", helloInterval);
+  cmd.AddValue ("deadInterval", "OSPF dead interval(seconds), 0 for the Quagga default", deadInterval);
+  cmd.AddValue ("costInterval", "Push the ISL delays as OSPF costs (100us per unit) every interval(seconds), 0 to disable", costInterval);
+  cmd.AddValue ("costThreshold", "Smallest OSPF cost change pushed", costThreshold);
+  cmd.AddValue ("neighborTime", "Count the Full OSPF adjacencies through the vty at this time(seconds), 0 to disable", neighborTime);
   cmd.Parse (argc,argv);
 
-  Ptr<TopologyReader> inFile = 0;
-
-
-  NodeContainer nodes;
-  nodes.Create(row * col);
-  // Prepare topology
-  int i, j, k = 0;
-  int link_count = 0;
-
-  // Set up topology
-  NetDeviceContainer ndc[row * col];
-  NetDeviceContainer ndr[row * col];
-  PointToPointHelper p2p;
-
-  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
-  p2p.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
-  
-  for (i = 0; i < row; i++) {
-    for (j = 0; j < col; j++) {
-      int id = i * col + j;
-      int id1 = i * col + (j+1)%col;
-      int id2 = ((i+1)%row) * col + j;
-      // printf("Node %d %d - %d\n",i, j, time);
-      ndc[id].Add(p2p.Install (nodes.Get(id), nodes.Get(id1)));
-      ndr[id].Add(p2p.Install (nodes.Get(id), nodes.Get(id2)));
-      // void AddISL(int ms, int link_id, int* if_count, Ptr<Node> n1, Ptr<Node> n2);
-      // AssignIP(10, link_count++, nodes.Get(id), nodes.Get(id1), if_count[id]++, if_count[id1]++, 10);
-      // Simulator::Schedule (Seconds(10), &AddLink, 11000, id, nodes.Get(id), nodes.Get(id1));
-      
-      // AssignIP(10, link_count++, nodes.Get(id), nodes.Get(id2), if_count[id]++, if_count[id2]++, 10);
-      // Simulator::Schedule (Seconds(100), &AddLink, 110000, id, nodes.Get(id), nodes.Get(id2));
-      // Simulator::Schedule (Seconds(0), &AddISL, ipv4AddrHelper,
-      //                     nodes, id, id2);
-    }
-  }
+  // Set up topology: +grid ISLs of a Walker-delta constellation
+  LeoConstellationHelper leo (planes, satsPerPlane, phasing, altitude, inclination);
+  leo.SetIslChannelAttribute ("Delay", StringValue ("2ms"));
+  leo.SetIslDeviceAttribute ("DataRate", StringValue ("5Mbps"));
 
   // Internet stack installation
   DceManagerHelper processManager;
@@ -201,31 +164,41 @@ main (int argc, char *argv[])
                                               EnumValue (0));
   processManager.SetNetworkStack ("ns3::LinuxSocketFdFactory",
                                   "Library", StringValue ("liblinux.so"));
-  
-  QuaggaHelper quagga;
-  processManager.Install (nodes);
-
-  // IP Configuration
-  // Set up sim0-3
-  for (int i = 0; i < row * col; i++) {
-    RunIp (nodes.Get(i), MilliSeconds (10001), "link set lo up");
-  }
-  for (int i = 0; i < row * col; i++) {
-    AssignIP(10000 + i * 4, i, ndc[i], true);
-  }
-  for (int i = 0; i < row * col; i++) {
-    AssignIP(10002 + i * 4, row * col + i, ndr[i], true);
-  }
-  LinkDown(135 * 1000, ndc[0]);
-  // LinkDown(100 * 1000, ndc[2]);
-  // LinkDown(100 * 1000, ndr[0]);
-  // LinkDown(100 * 1000, ndr[6]);
-  
 
+  // Nodes, ISLs, stack, addresses (at 10 s) and ospfd in one go
+  QuaggaHelper quagga;
+  Ptr<ConvergenceMonitor> monitor = CreateObject<ConvergenceMonitor> ();
+  NodeContainer nodes = leo.Create ();
+  // ISL failures are detected within the dead interval
+  quagga.SetOspfTimers (nodes, helloInterval, deadInterval, 0);
+  leo.Install (processManager, quagga, Seconds (10));
+  // the delay events of a trace would be overwritten within delayStep
+  if (delayStep > 0 && linkTrace.empty ())
+    {
+      leo.EnableIslDelayUpdates (Seconds (delayStep));
+    }
+  // OSPF costs follow the ISL delays once the adjacencies are up
+  Ptr<OspfCostUpdater> costUpdater;
+  if (costInterval > 0)
+    {
+      costUpdater = quagga.EnableOspfCostUpdates (nodes, MicroSeconds (100), Seconds (costInterval));
+      costUpdater->SetAttribute ("Threshold", UintegerValue (costThreshold));
+      costUpdater->Start (Seconds (60));
+    }
 
-  // Install Quagga
-  quagga.EnableOspf (nodes, "10.0.0.0/8");
-  quagga.Install (nodes);
+  if (!linkTrace.empty ())
+    {
+      Ptr<LinkEventTraceReplayer> replayer = CreateObject<LinkEventTraceReplayer> ();
+      replayer->AddLinks (leo);
+      NS_ABORT_MSG_IF (!replayer->Open (linkTrace), "cannot open " << linkTrace);
+      replayer->Start ();
+    }
+  else
+    {
+      LinkDown(135 * 1000, leo.GetLink (leo.GetIntraPlaneLink (0, 0)));
+      monitor->MarkEvent (Seconds (135), "link-down");
+    }
+  // LinkDown(100 * 1000, leo.GetLink (leo.GetInterPlaneLink (0, 0)));
 
   // Install Application
   // DceApplicationHelper dce;
@@ -245,6 +218,7 @@ main (int argc, char *argv[])
 
 
   // Enable pcap
+  PointToPointHelper p2p;
   p2p.EnablePcapAll ("leo-linux-test");
 
   // Debug
@@ -253,6 +227,27 @@ main (int argc, char *argv[])
   }
   // PrintAllRouteAt(10, nodes);
   // PrintAllRouteAt(80, nodes);
+  ipBatch.Install ();
+  if (neighborTime > 0)
+    {
+      quagga.QueryVty (nodes, "ospfd", Seconds (neighborTime), "show ip ospf neighbor",
+                       MakeCallback (&CountNeighbors));
+    }
+
+  // Routing convergence after each event, read from the nodes' FIBs
+  if (!convergenceFile.empty ())
+    {
+      monitor->Install (nodes);
+      monitor->Start (Seconds (10));
+    }
+  // Routing tables read from the stacks, no ip process per node
+  if (fibSnapshotInterval > 0)
+    {
+      Ptr<FibSnapshotHelper> fibSnapshot = CreateObject<FibSnapshotHelper> ();
+      NS_ABORT_MSG_IF (!fibSnapshot->Open ("fib-snapshots.bin"), "cannot create fib-snapshots.bin");
+      fibSnapshot->Install (nodes);
+      fibSnapshot->SnapshotEvery (Seconds (10), Seconds (fibSnapshotInterval), Seconds (stopTime));
+    }
   //
   // Step 9
   // Now It's ready to GO!
@@ -262,6 +257,21 @@ main (int argc, char *argv[])
       Simulator::Stop (Seconds (stopTime));
     }
   Simulator::Run ();
+  if (neighborTime > 0)
+    {
+      std::cout << "OSPF Full adjacencies at " << neighborTime << "s: " << fullNeighbors / 2
+                << " (" << neighborAnswers << "/" << nodes.GetN () << " nodes answered)" << std::endl;
+    }
+  if (costUpdater)
+    {
+      std::cout << "OSPF cost changes: " << costUpdater->GetNChanges ()
+                << ", vty sessions: " << costUpdater->GetVtyClient ()->GetNCompleted ()
+                << " (" << costUpdater->GetVtyClient ()->GetNFailed () << " failed)" << std::endl;
+    }
+  if (!convergenceFile.empty ())
+    {
+      monitor->Write (convergenceFile);
+    }
   Simulator::Destroy ();
 
   return 0;
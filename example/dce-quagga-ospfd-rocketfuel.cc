@@ -25,9 +25,13 @@
 #include "ns3/quagga-helper.h"
 #include "ns3/point-to-point-helper.h"
 #include "ns3/topology-read-module.h"
+#include "ns3/ospf-area-partitioner.h"
 
 #include "ns3/v4ping.h"
 
+#include <cmath>
+#include <cstdlib>
+#include <vector>
 #include <sys/resource.h>
 #undef NS3_MPI
 #ifdef NS3_MPI
@@ -40,6 +44,9 @@ NS_LOG_COMPONENT_DEFINE ("quagga-ospfd-rocketfuel");
 
 // Parameters
 uint32_t stopTime = 3600;
+uint32_t areas = 0;
+std::string costs = "none";
+bool weightDelays = false;
 
 #ifdef UNUSE
 static void
@@ -77,7 +84,12 @@ main (int argc, char *argv[])
   CommandLine cmd;
   cmd.AddValue ("stopTime", "Time to stop(seconds)", stopTime);
   cmd.AddValue ("topoFile", "topology file of rocketfuel dataset", topoFile);
+  cmd.AddValue ("areas", "Number of OSPF areas to split the topology in (0: single area)", areas);
+  cmd.AddValue ("costs", "OSPF interface costs: none, weights (of the topology file) or delay (of the links), in units of half a weight or 0.5ms", costs);
+  cmd.AddValue ("weightDelays", "Set the delay of each link to its weight in ms instead of 2ms", weightDelays);
   cmd.Parse (argc,argv);
+  NS_ABORT_MSG_IF (costs != "none" && costs != "weights" && costs != "delay",
+                   "unknown OSPF costs " << costs);
 
   //
   // Step o
@@ -152,11 +164,16 @@ main (int argc, char *argv[])
   int totlinks = inFile->LinksSize ();
   NS_LOG_INFO ("creating node containers");
   NodeContainer nc[totlinks];
+  std::vector<double> weight (totlinks);
   TopologyReader::ConstLinksIterator iter;
   int i = 0;
   for ( iter = inFile->LinksBegin (); iter != inFile->LinksEnd (); iter++, i++ )
     {
       nc[i] = NodeContainer (iter->GetFromNode (), iter->GetToNode ());
+      // the Rocketfuel reader keeps the weight of the link as "OSPF";
+      // many weights are halves (2.5, 3.5, ...)
+      std::string value;
+      weight[i] = iter->GetAttributeFailSafe ("OSPF", value) ? std::atof (value.c_str ()) : 0;
     }
 
 
@@ -165,19 +182,43 @@ main (int argc, char *argv[])
   PointToPointHelper p2p;
   for (int i = 0; i < totlinks; i++)
     {
-      // p2p.SetChannelAttribute ("Delay", TimeValue(MilliSeconds(weight[i])));
-      p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+      if (weightDelays && weight[i] > 0)
+        {
+          p2p.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (weight[i] * 1000)));
+        }
+      else
+        {
+          p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+        }
       p2p.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
       ndc[i] = p2p.Install (nc[i]);
     }
 //  p2p.EnablePcapAll ("quagga-rocketfuel");
 
+  // Split the routers in OSPF areas, each area numbered from its own prefix
+  OspfAreaPartitioner partitioner (nodes);
+  std::vector<Ipv4AddressHelper> areaAddress;
+  if (areas > 0)
+    {
+      for (int i = 0; i < totlinks; i++)
+        {
+          partitioner.AddLink (ndc[i]);
+        }
+      partitioner.Partition (areas);
+      areaAddress.resize (areas + 1);
+      for (uint32_t a = 0; a <= areas; a++)
+        {
+          areaAddress[a].SetBase (partitioner.GetAreaNetwork (a), "255.255.255.252");
+        }
+    }
+
   NS_LOG_INFO ("creating ipv4 interfaces");
   Ipv4InterfaceContainer ipic[totlinks];
   for (int i = 0; i < totlinks; i++)
     {
-      ipic[i] = address.Assign (ndc[i]);
-      address.NewNetwork ();
+      Ipv4AddressHelper &linkAddress = areas > 0 ? areaAddress[partitioner.GetLinkArea (i)] : address;
+      ipic[i] = linkAddress.Assign (ndc[i]);
+      linkAddress.NewNetwork ();
     }
 
 
@@ -208,6 +249,27 @@ main (int argc, char *argv[])
     app->SetStopTime (Seconds (stopTime));
   }
 
+  if (areas > 0)
+    {
+      partitioner.EnableOspf (quagga);
+    }
+  if (costs == "weights")
+    {
+      for (int i = 0; i < totlinks; i++)
+        {
+          if (weight[i] > 0)
+            {
+              // a cost unit of half a weight keeps the halves apart
+              double cost = std::floor (weight[i] * 2 + 0.5);
+              quagga.SetOspfCost (ndc[i], std::min<double> (std::max<double> (cost, 1), 65535));
+            }
+        }
+    }
+  else if (costs == "delay")
+    {
+      // the same unit as the weights: 0.5 ms
+      quagga.SetOspfCostFromDelay (nodes, MicroSeconds (500));
+    }
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
 #ifdef NS3_MPI
@@ -216,7 +278,10 @@ main (int argc, char *argv[])
       {
         //     std::cout << "[" << systemId << "] start quagga Node " << i << std::endl;
         processManager.Install (nodes.Get (i));
-        quagga.EnableOspf (nodes.Get (i), "10.0.0.0/8"); // FIXME
+        if (areas == 0)
+          {
+            quagga.EnableOspf (nodes.Get (i), "10.0.0.0/8"); // FIXME
+          }
         quagga.EnableOspfDebug (nodes.Get (i));
         quagga.Install (nodes.Get (i));
       }
@@ -10,6 +10,7 @@
 cpp_examples = [
     ("dce-zebra-simple", "True", "True"),
     ("dce-quagga-ospfd-rocketfuel", "False", "False"),
+    ("dce-quagga-ospfd-bench", "False", "False"),
     ("dce-quagga-bgpd-caida", "False", "False"),
     ("dce-quagga-bgpd", "True", "True"),
     ("dce-quagga-ospf6d --netStack=linux", "True", "True"),
@@ -0,0 +1,469 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "convergence-monitor.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/linux-socket-fd-factory.h"
+#include "ns3/unix-fd.h"
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string.h>
+
+NS_LOG_COMPONENT_DEFINE ("ConvergenceMonitor");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (ConvergenceMonitor);
+
+// one netlink read; route notifications are ~100 bytes each
+static const uint32_t NETLINK_BUFFER_SIZE = 16384;
+
+static uint64_t
+HashWord (uint64_t hash, uint32_t word)
+{
+  // FNV-1a, one byte at a time
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      hash ^= (word >> (8 * i)) & 0xff;
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+// RFC 4180: quoted, with quotes doubled, if it has a comma, a quote or
+// a line break
+static std::string
+CsvField (const std::string &text)
+{
+  if (text.find_first_of (",\"\r\n") == std::string::npos)
+    {
+      return text;
+    }
+  std::string field = "\"";
+  for (std::string::const_iterator c = text.begin (); c != text.end (); ++c)
+    {
+      field += *c;
+      if (*c == '"')
+        {
+          field += '"';
+        }
+    }
+  return field + "\"";
+}
+
+// quoted, with quotes, backslashes and control characters escaped
+static std::string
+JsonString (const std::string &text)
+{
+  std::ostringstream field;
+  field << '"';
+  for (std::string::const_iterator c = text.begin (); c != text.end (); ++c)
+    {
+      if (*c == '"' || *c == '\\')
+        {
+          field << '\\' << *c;
+        }
+      else if ((unsigned char)*c < 0x20)
+        {
+          field << "\\u" << std::hex << std::setw (4) << std::setfill ('0') << (int)*c
+                << std::dec;
+        }
+      else
+        {
+          field << *c;
+        }
+    }
+  field << '"';
+  return field.str ();
+}
+
+TypeId
+ConvergenceMonitor::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ConvergenceMonitor")
+    .SetParent<Object> ()
+    .AddConstructor<ConvergenceMonitor> ()
+    .AddAttribute ("PollInterval",
+                   "Time between two reads of the FIB changes of a node.",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&ConvergenceMonitor::m_pollInterval),
+                   MakeTimeChecker ())
+    .AddTraceSource ("FibChange",
+                     "The FIB of a node changed.",
+                     MakeTraceSourceAccessor (&ConvergenceMonitor::m_fibChangeTrace),
+                     "ns3::ConvergenceMonitor::FibChangeCallback")
+  ;
+  return tid;
+}
+
+ConvergenceMonitor::ConvergenceMonitor ()
+  : m_running (false)
+{
+}
+
+ConvergenceMonitor::~ConvergenceMonitor ()
+{
+}
+
+void
+ConvergenceMonitor::DoDispose (void)
+{
+  m_running = false;
+  m_kernels.clear ();
+  m_routing.clear ();
+  m_nodes = NodeContainer ();
+  Object::DoDispose ();
+}
+
+void
+ConvergenceMonitor::Install (NodeContainer nodes)
+{
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      m_nodes.Add (*i);
+      m_kernels.push_back ((*i)->GetObject<LinuxSocketFdFactory> ());
+      m_fds.push_back (0);
+      m_routing.push_back (0);
+      m_routes.push_back (std::vector<uint64_t> ());
+      m_lastEvent.push_back (0xffffffff);
+    }
+}
+
+void
+ConvergenceMonitor::Start (Time at)
+{
+  Simulator::Schedule (at, &ConvergenceMonitor::DoStart, Ptr<ConvergenceMonitor> (this));
+}
+
+void
+ConvergenceMonitor::DoStart (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_running)
+    {
+      return;
+    }
+  m_running = true;
+  DoMarkEvent ("start");
+  m_buffer.resize (NETLINK_BUFFER_SIZE);
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      uint32_t nodeId = m_nodes.Get (i)->GetId ();
+      if (m_kernels[i])
+        {
+          Simulator::ScheduleWithContext (nodeId, Seconds (0),
+                                          &LinuxSocketFdFactory::ScheduleTask, m_kernels[i],
+                                          MakeEvent (&ConvergenceMonitor::OpenSocket,
+                                                     Ptr<ConvergenceMonitor> (this), i));
+        }
+      Simulator::ScheduleWithContext (nodeId, m_pollInterval, &ConvergenceMonitor::Poll,
+                                      Ptr<ConvergenceMonitor> (this), i);
+    }
+}
+
+void
+ConvergenceMonitor::Stop (Time at)
+{
+  Simulator::Schedule (at, &ConvergenceMonitor::Poll, Ptr<ConvergenceMonitor> (this),
+                       m_nodes.GetN ());
+}
+
+void
+ConvergenceMonitor::MarkEvent (Time at, std::string label)
+{
+  Simulator::Schedule (at, &ConvergenceMonitor::DoMarkEvent, Ptr<ConvergenceMonitor> (this),
+                       label);
+}
+
+void
+ConvergenceMonitor::DoMarkEvent (std::string label)
+{
+  NS_LOG_FUNCTION (this << label);
+  Event event;
+  event.m_time = Simulator::Now ();
+  event.m_label = label;
+  event.m_last = event.m_time;
+  event.m_updates = 0;
+  event.m_nodes = 0;
+  m_events.push_back (event);
+}
+
+/*
+ * Poll (i) reads the FIB changes of node i and reschedules itself;
+ * Poll (GetN ()) is the stop request.
+ */
+void
+ConvergenceMonitor::Poll (uint32_t i)
+{
+  if (i == m_nodes.GetN ())
+    {
+      NS_LOG_FUNCTION (this << "stop");
+      m_running = false;
+      return;
+    }
+  if (!m_running)
+    {
+      if (m_fds[i])
+        {
+          m_kernels[i]->ScheduleTask (MakeEvent (&ConvergenceMonitor::CloseSocket,
+                                                 Ptr<ConvergenceMonitor> (this), i));
+        }
+      return;
+    }
+  if (m_kernels[i])
+    {
+      m_kernels[i]->ScheduleTask (MakeEvent (&ConvergenceMonitor::DrainSocket,
+                                             Ptr<ConvergenceMonitor> (this), i));
+    }
+  else
+    {
+      CompareRoutes (i);
+    }
+  Simulator::Schedule (m_pollInterval, &ConvergenceMonitor::Poll,
+                       Ptr<ConvergenceMonitor> (this), i);
+}
+
+void
+ConvergenceMonitor::OpenSocket (uint32_t i)
+{
+  UnixFd *fd = m_kernels[i]->CreateSocket (AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+  if (fd == 0)
+    {
+      NS_LOG_WARN ("node " << m_nodes.Get (i)->GetId () << ": unable to open a NETLINK_ROUTE socket");
+      return;
+    }
+  struct sockaddr_nl addr;
+  ::memset (&addr, 0, sizeof (addr));
+  addr.nl_family = AF_NETLINK;
+  addr.nl_groups = RTMGRP_IPV4_ROUTE | RTMGRP_IPV6_ROUTE;
+  if (fd->Bind ((struct sockaddr *)&addr, sizeof (addr)) < 0)
+    {
+      NS_LOG_WARN ("node " << m_nodes.Get (i)->GetId () << ": cannot join the route groups");
+      fd->Close ();
+      fd->Unref ();
+      return;
+    }
+  m_fds[i] = fd;
+}
+
+void
+ConvergenceMonitor::CloseSocket (uint32_t i)
+{
+  m_fds[i]->Close ();
+  m_fds[i]->Unref ();
+  m_fds[i] = 0;
+}
+
+void
+ConvergenceMonitor::DrainSocket (uint32_t i)
+{
+  UnixFd *fd = m_fds[i];
+  if (fd == 0)
+    {
+      return;
+    }
+  uint32_t n = 0;
+  for (;;)
+    {
+      struct iovec iov;
+      iov.iov_base = &m_buffer[0];
+      iov.iov_len = m_buffer.size ();
+      struct msghdr msg;
+      ::memset (&msg, 0, sizeof (msg));
+      msg.msg_iov = &iov;
+      msg.msg_iovlen = 1;
+      ssize_t length = fd->Recvmsg (&msg, MSG_DONTWAIT);
+      if (length <= 0)
+        {
+          // EAGAIN once drained; ENOBUFS means notifications were lost
+          break;
+        }
+      int remaining = length;
+      for (struct nlmsghdr *h = (struct nlmsghdr *)&m_buffer[0]; NLMSG_OK (h, remaining);
+           h = NLMSG_NEXT (h, remaining))
+        {
+          if (h->nlmsg_type != RTM_NEWROUTE && h->nlmsg_type != RTM_DELROUTE)
+            {
+              continue;
+            }
+          struct rtmsg *rtm = (struct rtmsg *)NLMSG_DATA (h);
+          if (rtm->rtm_table == RT_TABLE_MAIN)
+            {
+              n++;
+            }
+        }
+    }
+  RecordChanges (i, n);
+}
+
+void
+ConvergenceMonitor::CompareRoutes (uint32_t i)
+{
+  if (m_routing[i] == 0)
+    {
+      Ptr<Ipv4> ipv4 = m_nodes.Get (i)->GetObject<Ipv4> ();
+      if (ipv4 == 0 || ipv4->GetRoutingProtocol () == 0)
+        {
+          return;
+        }
+      m_routing[i] = Ipv4RoutingHelper::GetRouting<Ipv4StaticRouting> (ipv4->GetRoutingProtocol ());
+      NS_ABORT_MSG_IF (m_routing[i] == 0,
+                       "node " << m_nodes.Get (i)->GetId () << " has no static routing to watch");
+    }
+
+  m_scratch.clear ();
+  for (uint32_t r = 0; r < m_routing[i]->GetNRoutes (); r++)
+    {
+      Ipv4RoutingTableEntry route = m_routing[i]->GetRoute (r);
+      uint64_t hash = 14695981039346656037ULL;
+      hash = HashWord (hash, route.GetDest ().Get ());
+      hash = HashWord (hash, route.GetDestNetworkMask ().Get ());
+      hash = HashWord (hash, route.GetGateway ().Get ());
+      hash = HashWord (hash, route.GetInterface ());
+      hash = HashWord (hash, m_routing[i]->GetMetric (r));
+      m_scratch.push_back (hash);
+    }
+  std::sort (m_scratch.begin (), m_scratch.end ());
+
+  // size of the symmetric difference of the sorted tables
+  std::vector<uint64_t> &old = m_routes[i];
+  uint32_t n = 0;
+  std::vector<uint64_t>::const_iterator a = old.begin (), b = m_scratch.begin ();
+  while (a != old.end () || b != m_scratch.end ())
+    {
+      if (b == m_scratch.end () || (a != old.end () && *a < *b))
+        {
+          ++a;
+          n++;
+        }
+      else if (a == old.end () || *b < *a)
+        {
+          ++b;
+          n++;
+        }
+      else
+        {
+          ++a;
+          ++b;
+        }
+    }
+  old.swap (m_scratch);
+  RecordChanges (i, n);
+}
+
+void
+ConvergenceMonitor::RecordChanges (uint32_t i, uint32_t n)
+{
+  if (n == 0 || m_events.empty ())
+    {
+      return;
+    }
+  uint32_t current = m_events.size () - 1;
+  Event &event = m_events[current];
+  event.m_updates += n;
+  event.m_last = Simulator::Now ();
+  if (m_lastEvent[i] != current)
+    {
+      m_lastEvent[i] = current;
+      event.m_nodes++;
+    }
+  NS_LOG_LOGIC ("node " << m_nodes.Get (i)->GetId () << ": " << n << " FIB updates");
+  m_fibChangeTrace (m_nodes.Get (i)->GetId (), n);
+}
+
+uint32_t
+ConvergenceMonitor::GetNEvents (void) const
+{
+  return m_events.size ();
+}
+
+Time
+ConvergenceMonitor::GetConvergenceTime (uint32_t event) const
+{
+  return m_events[event].m_last - m_events[event].m_time;
+}
+
+uint64_t
+ConvergenceMonitor::GetNUpdates (uint32_t event) const
+{
+  return m_events[event].m_updates;
+}
+
+uint32_t
+ConvergenceMonitor::GetNNodesTouched (uint32_t event) const
+{
+  return m_events[event].m_nodes;
+}
+
+void
+ConvergenceMonitor::WriteCsv (std::ostream &os) const
+{
+  os << "event,label,time_s,convergence_s,fib_updates,nodes_touched" << std::endl;
+  for (uint32_t e = 0; e < m_events.size (); e++)
+    {
+      const Event &event = m_events[e];
+      os << e << "," << CsvField (event.m_label) << "," << event.m_time.GetSeconds () << ","
+         << GetConvergenceTime (e).GetSeconds () << "," << event.m_updates << ","
+         << event.m_nodes << std::endl;
+    }
+}
+
+void
+ConvergenceMonitor::WriteJson (std::ostream &os) const
+{
+  os << "[";
+  for (uint32_t e = 0; e < m_events.size (); e++)
+    {
+      const Event &event = m_events[e];
+      os << (e ? ",\n " : "\n ")
+         << "{\"event\": " << e
+         << ", \"label\": " << JsonString (event.m_label)
+         << ", \"time_s\": " << event.m_time.GetSeconds ()
+         << ", \"convergence_s\": " << GetConvergenceTime (e).GetSeconds ()
+         << ", \"fib_updates\": " << event.m_updates
+         << ", \"nodes_touched\": " << event.m_nodes << "}";
+    }
+  os << "\n]" << std::endl;
+}
+
+void
+ConvergenceMonitor::Write (std::string filename) const
+{
+  std::ofstream os (filename.c_str ());
+  std::string::size_type dot = filename.rfind ('.');
+  if (dot != std::string::npos && filename.substr (dot) == ".json")
+    {
+      WriteJson (os);
+    }
+  else
+    {
+      WriteCsv (os);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,155 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef CONVERGENCE_MONITOR_H
+#define CONVERGENCE_MONITOR_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/node-container.h"
+#include "ns3/traced-callback.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class LinuxSocketFdFactory;
+class Ipv4StaticRouting;
+class UnixFd;
+
+/**
+ * \brief measure how long routing takes to converge after each event.
+ *
+ * The monitor watches the FIB of every node it is installed on:
+ *
+ * - with the Linux stack, a NETLINK_ROUTE socket subscribed to the
+ *   IPv4/IPv6 route groups is opened in the kernel of the node and
+ *   drained every PollInterval by a kernel task, counting RTM_NEWROUTE
+ *   and RTM_DELROUTE messages for the main table;
+ * - with the ns-3 stack (Ipv4DceRouting), the static routing table is
+ *   compared every PollInterval with the previous one, counting added
+ *   and removed routes.
+ *
+ * Route changes are charged to the last event marked with MarkEvent ()
+ * (the first one being "start").  For each event the report gives the
+ * time from the event to the last route change before the next event,
+ * the number of FIB updates and the number of nodes whose FIB changed.
+ * Times are accurate to PollInterval.
+ */
+class ConvergenceMonitor : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /**
+   * \param nodeId The node whose FIB changed.
+   * \param nUpdates The number of route additions and removals seen.
+   */
+  typedef void (* FibChangeCallback)(uint32_t nodeId, uint32_t nUpdates);
+
+  ConvergenceMonitor ();
+  virtual ~ConvergenceMonitor ();
+
+  /**
+   * \brief Watch the FIB of the nodes.  The network stack has to be
+   * installed on them.
+   */
+  void Install (NodeContainer nodes);
+
+  /**
+   * \brief Start watching, and mark the "start" event, at the given time.
+   */
+  void Start (Time at);
+
+  /**
+   * \brief Stop watching at the given time.
+   */
+  void Stop (Time at);
+
+  /**
+   * \brief Mark an event (link failure, cost change...) at the given time;
+   * route changes after it are charged to it.
+   */
+  void MarkEvent (Time at, std::string label);
+
+  uint32_t GetNEvents (void) const;
+
+  /**
+   * \returns The time from the event to the last route change it caused.
+   */
+  Time GetConvergenceTime (uint32_t event) const;
+  uint64_t GetNUpdates (uint32_t event) const;
+  uint32_t GetNNodesTouched (uint32_t event) const;
+
+  /**
+   * \brief Write one line per event:
+   * event,label,time_s,convergence_s,fib_updates,nodes_touched
+   *
+   * Labels with a comma, a quote or a line break are quoted.
+   */
+  void WriteCsv (std::ostream &os) const;
+
+  /**
+   * \brief Write the same report as a JSON array of objects.
+   */
+  void WriteJson (std::ostream &os) const;
+
+  /**
+   * \brief Write the report to a file, as JSON if its name ends with
+   * ".json" and as CSV otherwise.
+   */
+  void Write (std::string filename) const;
+
+private:
+  struct Event
+  {
+    Time m_time;
+    std::string m_label;
+    Time m_last;
+    uint64_t m_updates;
+    uint32_t m_nodes;
+  };
+
+  virtual void DoDispose (void);
+  void DoMarkEvent (std::string label);
+  void DoStart (void);
+  void Poll (uint32_t i);
+  void OpenSocket (uint32_t i);
+  void CloseSocket (uint32_t i);
+  void DrainSocket (uint32_t i);
+  void CompareRoutes (uint32_t i);
+  void RecordChanges (uint32_t i, uint32_t n);
+
+  Time m_pollInterval;
+  bool m_running;
+  NodeContainer m_nodes;
+  std::vector<Ptr<LinuxSocketFdFactory> > m_kernels;
+  std::vector<UnixFd *> m_fds;
+  std::vector<Ptr<Ipv4StaticRouting> > m_routing;
+  std::vector<std::vector<uint64_t> > m_routes;
+  std::vector<uint64_t> m_scratch;
+  std::vector<uint8_t> m_buffer;
+  std::vector<uint32_t> m_lastEvent;
+  std::vector<Event> m_events;
+
+  /// node id, number of FIB updates seen in one poll
+  TracedCallback<uint32_t, uint32_t> m_fibChangeTrace;
+};
+
+} // namespace ns3
+
+#endif /* CONVERGENCE_MONITOR_H */
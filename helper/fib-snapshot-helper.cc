@@ -0,0 +1,412 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "fib-snapshot-helper.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-static-routing.h"
+#include "ns3/ipv4-routing-helper.h"
+#include "ns3/linux-socket-fd-factory.h"
+#include "ns3/unix-fd.h"
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <algorithm>
+#include <iterator>
+#include <string.h>
+
+NS_LOG_COMPONENT_DEFINE ("FibSnapshotHelper");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (FibSnapshotHelper);
+
+static const char SNAPSHOT_MAGIC[8] = { 'F', 'I', 'B', 'S', 'N', 'A', 'P', '1' };
+// netlink dumps are sent in chunks of at most a few pages
+static const uint32_t NETLINK_BUFFER_SIZE = 32768;
+
+bool
+FibSnapshotHelper::Route::operator < (const Route &o) const
+{
+  return ::memcmp (this, &o, sizeof (Route)) < 0;
+}
+
+bool
+FibSnapshotHelper::Route::operator == (const Route &o) const
+{
+  return ::memcmp (this, &o, sizeof (Route)) == 0;
+}
+
+TypeId
+FibSnapshotHelper::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FibSnapshotHelper")
+    .SetParent<Object> ()
+    .AddConstructor<FibSnapshotHelper> ()
+    .AddAttribute ("DeltaEncoding",
+                   "Only write the routes changed since the previous snapshot of a node.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&FibSnapshotHelper::m_delta),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+FibSnapshotHelper::FibSnapshotHelper ()
+  : m_delta (true),
+    m_file (0),
+    m_nSnapshots (0)
+{
+}
+
+FibSnapshotHelper::~FibSnapshotHelper ()
+{
+  if (m_file)
+    {
+      fclose (m_file);
+    }
+}
+
+void
+FibSnapshotHelper::DoDispose (void)
+{
+  m_periodic.Cancel ();
+  if (m_file)
+    {
+      fclose (m_file);
+      m_file = 0;
+    }
+  m_kernels.clear ();
+  m_nodes = NodeContainer ();
+  Object::DoDispose ();
+}
+
+bool
+FibSnapshotHelper::Open (std::string filename)
+{
+  if (m_file)
+    {
+      fclose (m_file);
+    }
+  m_file = fopen (filename.c_str (), "wb");
+  if (!m_file)
+    {
+      NS_LOG_WARN ("cannot create " << filename);
+      return false;
+    }
+  fwrite (SNAPSHOT_MAGIC, 1, sizeof (SNAPSHOT_MAGIC), m_file);
+  // a new file starts with full tables again
+  for (uint32_t i = 0; i < m_tables.size (); i++)
+    {
+      m_tables[i].clear ();
+    }
+  return true;
+}
+
+void
+FibSnapshotHelper::Install (NodeContainer nodes)
+{
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      m_nodes.Add (*i);
+      m_kernels.push_back ((*i)->GetObject<LinuxSocketFdFactory> ());
+      m_tables.push_back (std::vector<Route> ());
+    }
+}
+
+void
+FibSnapshotHelper::Snapshot (void)
+{
+  NS_ABORT_MSG_IF (!m_file, "no snapshot file opened");
+  uint32_t snapshot = m_nSnapshots++;
+  std::vector<Route> routes;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      if (m_kernels[i])
+        {
+          // the dump runs in the kernel of the node and writes its own record
+          Simulator::ScheduleWithContext (m_nodes.Get (i)->GetId (), Seconds (0),
+                                          &LinuxSocketFdFactory::ScheduleTask, m_kernels[i],
+                                          MakeEvent (&FibSnapshotHelper::DumpKernel,
+                                                     Ptr<FibSnapshotHelper> (this), i, snapshot));
+        }
+      else
+        {
+          ReadStaticRouting (i, routes);
+          WriteRecord (i, snapshot, routes);
+        }
+    }
+}
+
+void
+FibSnapshotHelper::SnapshotAt (Time at)
+{
+  Simulator::Schedule (at, &FibSnapshotHelper::Snapshot, Ptr<FibSnapshotHelper> (this));
+}
+
+void
+FibSnapshotHelper::SnapshotEvery (Time start, Time interval, Time stop)
+{
+  m_periodic.Cancel ();
+  m_periodic = Simulator::Schedule (start, &FibSnapshotHelper::Periodic,
+                                    Ptr<FibSnapshotHelper> (this), interval, stop);
+}
+
+void
+FibSnapshotHelper::Periodic (Time interval, Time stop)
+{
+  Snapshot ();
+  if (Simulator::Now () + interval <= stop)
+    {
+      m_periodic = Simulator::Schedule (interval, &FibSnapshotHelper::Periodic,
+                                        Ptr<FibSnapshotHelper> (this), interval, stop);
+    }
+}
+
+uint32_t
+FibSnapshotHelper::GetNSnapshots (void) const
+{
+  return m_nSnapshots;
+}
+
+void
+FibSnapshotHelper::DumpKernel (uint32_t i, uint32_t snapshot)
+{
+  Ptr<LinuxSocketFdFactory> kernel = m_kernels[i];
+  UnixFd *fd = kernel->CreateSocket (AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+  if (fd == 0)
+    {
+      NS_LOG_WARN ("node " << m_nodes.Get (i)->GetId () << ": unable to open a NETLINK_ROUTE socket");
+      return;
+    }
+
+  struct
+  {
+    struct nlmsghdr m_nlh;
+    struct rtmsg m_rtm;
+  } req;
+  ::memset (&req, 0, sizeof (req));
+  req.m_nlh.nlmsg_len = NLMSG_LENGTH (sizeof (struct rtmsg));
+  req.m_nlh.nlmsg_type = RTM_GETROUTE;
+  req.m_nlh.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+  req.m_rtm.rtm_family = AF_UNSPEC;
+  if (fd->Write (&req, req.m_nlh.nlmsg_len) != (ssize_t)req.m_nlh.nlmsg_len)
+    {
+      NS_LOG_WARN ("node " << m_nodes.Get (i)->GetId () << ": RTM_GETROUTE failed");
+      fd->Close ();
+      fd->Unref ();
+      return;
+    }
+
+  m_buffer.resize (NETLINK_BUFFER_SIZE);
+  std::vector<Route> routes;
+  bool done = false;
+  while (!done)
+    {
+      struct iovec iov;
+      iov.iov_base = &m_buffer[0];
+      iov.iov_len = m_buffer.size ();
+      struct msghdr msg;
+      ::memset (&msg, 0, sizeof (msg));
+      msg.msg_iov = &iov;
+      msg.msg_iovlen = 1;
+      // every read lets the kernel fill in the next part of the dump
+      ssize_t length = fd->Recvmsg (&msg, MSG_DONTWAIT);
+      if (length <= 0)
+        {
+          break;
+        }
+      int remaining = length;
+      for (struct nlmsghdr *h = (struct nlmsghdr *)&m_buffer[0]; NLMSG_OK (h, remaining);
+           h = NLMSG_NEXT (h, remaining))
+        {
+          if (h->nlmsg_type == NLMSG_DONE || h->nlmsg_type == NLMSG_ERROR)
+            {
+              done = true;
+              break;
+            }
+          struct rtmsg *rtm = (struct rtmsg *)NLMSG_DATA (h);
+          if (h->nlmsg_type != RTM_NEWROUTE || rtm->rtm_table != RT_TABLE_MAIN)
+            {
+              continue;
+            }
+          Route route;
+          ::memset (&route, 0, sizeof (route));
+          route.m_family = rtm->rtm_family;
+          route.m_prefixLength = rtm->rtm_dst_len;
+          route.m_protocol = rtm->rtm_protocol;
+          int attrLength = RTM_PAYLOAD (h);
+          for (struct rtattr *rta = RTM_RTA (rtm); RTA_OK (rta, attrLength);
+               rta = RTA_NEXT (rta, attrLength))
+            {
+              uint32_t size = std::min<uint32_t> (RTA_PAYLOAD (rta), 16);
+              switch (rta->rta_type)
+                {
+                case RTA_DST:
+                  ::memcpy (route.m_destination, RTA_DATA (rta), size);
+                  break;
+                case RTA_GATEWAY:
+                  ::memcpy (route.m_gateway, RTA_DATA (rta), size);
+                  break;
+                case RTA_OIF:
+                  ::memcpy (&route.m_interface, RTA_DATA (rta), sizeof (uint32_t));
+                  break;
+                case RTA_PRIORITY:
+                  ::memcpy (&route.m_metric, RTA_DATA (rta), sizeof (uint32_t));
+                  break;
+                default:
+                  break;
+                }
+            }
+          routes.push_back (route);
+        }
+    }
+  fd->Close ();
+  fd->Unref ();
+  WriteRecord (i, snapshot, routes);
+}
+
+void
+FibSnapshotHelper::ReadStaticRouting (uint32_t i, std::vector<Route> &routes)
+{
+  routes.clear ();
+  Ptr<Ipv4> ipv4 = m_nodes.Get (i)->GetObject<Ipv4> ();
+  if (ipv4 == 0 || ipv4->GetRoutingProtocol () == 0)
+    {
+      return;
+    }
+  Ptr<Ipv4StaticRouting> routing =
+    Ipv4RoutingHelper::GetRouting<Ipv4StaticRouting> (ipv4->GetRoutingProtocol ());
+  if (routing == 0)
+    {
+      return;
+    }
+  for (uint32_t r = 0; r < routing->GetNRoutes (); r++)
+    {
+      Ipv4RoutingTableEntry entry = routing->GetRoute (r);
+      Route route;
+      ::memset (&route, 0, sizeof (route));
+      route.m_family = AF_INET;
+      route.m_prefixLength = entry.GetDestNetworkMask ().GetPrefixLength ();
+      route.m_interface = entry.GetInterface ();
+      route.m_metric = routing->GetMetric (r);
+      entry.GetDest ().Serialize (route.m_destination);
+      entry.GetGateway ().Serialize (route.m_gateway);
+      routes.push_back (route);
+    }
+}
+
+void
+FibSnapshotHelper::WriteRecord (uint32_t i, uint32_t snapshot, std::vector<Route> &routes)
+{
+  std::sort (routes.begin (), routes.end ());
+  std::vector<Route> &previous = m_tables[i];
+  RecordHeader header;
+  ::memset (&header, 0, sizeof (header));
+  header.m_time = Simulator::Now ().GetNanoSeconds ();
+  header.m_snapshot = snapshot;
+  header.m_nodeId = m_nodes.Get (i)->GetId ();
+
+  m_removed.clear ();
+  m_added.clear ();
+  if (!m_delta || (previous.empty () && !routes.empty ()))
+    {
+      header.m_flags = FULL;
+      m_added = routes;
+    }
+  else
+    {
+      std::set_difference (previous.begin (), previous.end (), routes.begin (), routes.end (),
+                           std::back_inserter (m_removed));
+      std::set_difference (routes.begin (), routes.end (), previous.begin (), previous.end (),
+                           std::back_inserter (m_added));
+      if (m_removed.empty () && m_added.empty ())
+        {
+          return;
+        }
+    }
+  header.m_nRemoved = m_removed.size ();
+  header.m_nAdded = m_added.size ();
+  fwrite (&header, sizeof (header), 1, m_file);
+  if (!m_removed.empty ())
+    {
+      fwrite (&m_removed[0], sizeof (Route), m_removed.size (), m_file);
+    }
+  if (!m_added.empty ())
+    {
+      fwrite (&m_added[0], sizeof (Route), m_added.size (), m_file);
+    }
+  previous.swap (routes);
+}
+
+static void
+PrintRoute (std::ostream &os, const FibSnapshotHelper::Route &route)
+{
+  char dst[INET6_ADDRSTRLEN];
+  char gw[INET6_ADDRSTRLEN];
+  int family = route.m_family == AF_INET6 ? AF_INET6 : AF_INET;
+  ::inet_ntop (family, route.m_destination, dst, sizeof (dst));
+  ::inet_ntop (family, route.m_gateway, gw, sizeof (gw));
+  os << dst << "/" << (uint32_t) route.m_prefixLength << " via " << gw
+     << " dev " << route.m_interface << " metric " << route.m_metric
+     << " proto " << (uint32_t) route.m_protocol;
+}
+
+bool
+FibSnapshotHelper::Print (std::string filename, std::ostream &os)
+{
+  FILE *file = fopen (filename.c_str (), "rb");
+  if (!file)
+    {
+      return false;
+    }
+  char magic[sizeof (SNAPSHOT_MAGIC)];
+  if (fread (magic, 1, sizeof (magic), file) != sizeof (magic)
+      || ::memcmp (magic, SNAPSHOT_MAGIC, sizeof (magic)) != 0)
+    {
+      fclose (file);
+      return false;
+    }
+  RecordHeader header;
+  Route route;
+  while (fread (&header, sizeof (header), 1, file) == 1)
+    {
+      os << "# t=" << NanoSeconds (header.m_time).GetSeconds () << " snapshot "
+         << header.m_snapshot << " node " << header.m_nodeId
+         << ((header.m_flags & FULL) ? " full" : " delta") << std::endl;
+      for (uint32_t r = 0; r < header.m_nRemoved + header.m_nAdded; r++)
+        {
+          if (fread (&route, sizeof (route), 1, file) != 1)
+            {
+              fclose (file);
+              return false;
+            }
+          os << (r < header.m_nRemoved ? "- " : "+ ");
+          PrintRoute (os, route);
+          os << std::endl;
+        }
+    }
+  fclose (file);
+  return true;
+}
+
+} // namespace ns3
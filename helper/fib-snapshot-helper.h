@@ -0,0 +1,156 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef FIB_SNAPSHOT_HELPER_H
+#define FIB_SNAPSHOT_HELPER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/node-container.h"
+#include <stdio.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class LinuxSocketFdFactory;
+class Ipv4StaticRouting;
+
+/**
+ * \brief write the routing tables of many nodes to one binary file
+ * without running ip(8).
+ *
+ * With the Linux stack the main table is dumped with one RTM_GETROUTE
+ * request on a NETLINK_ROUTE socket opened in a kernel task of the node;
+ * with the ns-3 stack the static routing of Ipv4DceRouting is read
+ * directly.  Snapshots are taken on demand (Snapshot ()), at given times
+ * (SnapshotAt ()) or periodically (SnapshotEvery ()).
+ *
+ * The file starts with the 8-byte magic "FIBSNAP1" and holds one record
+ * per node and snapshot:
+ *
+ * - a RecordHeader (time in ns, snapshot number, node id, flags, number
+ *   of removed and added routes),
+ * - the removed Route entries, then the added ones.
+ *
+ * With DeltaEncoding (the default) a record only lists the routes that
+ * changed since the previous snapshot of the node, and nodes whose table
+ * did not change write nothing; the first record of a node, or every
+ * record without delta encoding, has the FULL flag and lists the whole
+ * table.  Print () decodes a file back to text.
+ */
+class FibSnapshotHelper : public Object
+{
+public:
+  enum
+  {
+    FULL = 1
+  };
+
+  struct RecordHeader
+  {
+    int64_t m_time;
+    uint32_t m_snapshot;
+    uint32_t m_nodeId;
+    uint32_t m_flags;
+    uint32_t m_nRemoved;
+    uint32_t m_nAdded;
+    uint32_t m_reserved;
+  };
+
+  struct Route
+  {
+    uint8_t m_family;        // AF_INET or AF_INET6
+    uint8_t m_prefixLength;
+    uint8_t m_protocol;      // rtm_protocol, 0 with the ns-3 stack
+    uint8_t m_reserved;
+    uint32_t m_interface;    // ifindex (Linux) or interface number (ns-3)
+    uint32_t m_metric;
+    uint8_t m_destination[16];
+    uint8_t m_gateway[16];
+
+    bool operator < (const Route &o) const;
+    bool operator == (const Route &o) const;
+  };
+
+  static TypeId GetTypeId (void);
+
+  FibSnapshotHelper ();
+  virtual ~FibSnapshotHelper ();
+
+  /**
+   * \brief Create the snapshot file.
+   *
+   * \returns false if it cannot be created.
+   */
+  bool Open (std::string filename);
+
+  /**
+   * \brief Snapshot the routing tables of these nodes.
+   */
+  void Install (NodeContainer nodes);
+
+  /**
+   * \brief Take a snapshot now (e.g. from a trace sink).
+   */
+  void Snapshot (void);
+
+  /**
+   * \brief Take a snapshot at the given time.
+   */
+  void SnapshotAt (Time at);
+
+  /**
+   * \brief Take a snapshot every interval, from start until stop.
+   */
+  void SnapshotEvery (Time start, Time interval, Time stop);
+
+  /**
+   * \returns The number of snapshots taken.
+   */
+  uint32_t GetNSnapshots (void) const;
+
+  /**
+   * \brief Decode a snapshot file to text, one line per route change.
+   *
+   * \returns false if the file cannot be read.
+   */
+  static bool Print (std::string filename, std::ostream &os);
+
+private:
+  virtual void DoDispose (void);
+  void Periodic (Time interval, Time stop);
+  void DumpKernel (uint32_t i, uint32_t snapshot);
+  void ReadStaticRouting (uint32_t i, std::vector<Route> &routes);
+  void WriteRecord (uint32_t i, uint32_t snapshot, std::vector<Route> &routes);
+
+  bool m_delta;
+  FILE *m_file;
+  uint32_t m_nSnapshots;
+  EventId m_periodic;
+  NodeContainer m_nodes;
+  std::vector<Ptr<LinuxSocketFdFactory> > m_kernels;
+  std::vector<std::vector<Route> > m_tables;   // last snapshot of each node
+  std::vector<Route> m_removed;
+  std::vector<Route> m_added;
+  std::vector<uint8_t> m_buffer;
+};
+
+} // namespace ns3
+
+#endif /* FIB_SNAPSHOT_HELPER_H */
@@ -0,0 +1,168 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ip-batch-helper.h"
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+NS_LOG_COMPONENT_DEFINE ("IpBatchHelper");
+
+namespace ns3 {
+
+// batch files are numbered globally so that several helpers never collide
+static uint32_t g_ipBatchIndex = 0;
+
+/*
+ * Split "-f inet addr add ..." into the global options ("-f inet"),
+ * which have to be given on the ip command line, and the batch line
+ * ("addr add ...").
+ */
+static void
+SplitIpOptions (const std::string &command, std::string &options, std::string &line)
+{
+  std::istringstream iss (command);
+  std::string token;
+  options.clear ();
+  line.clear ();
+  while (iss >> token)
+    {
+      if (!line.empty () || token[0] != '-')
+        {
+          line += line.empty () ? token : " " + token;
+          continue;
+        }
+      options += options.empty () ? token : " " + token;
+      if (token == "-f" || token == "-family" || token == "-l" || token == "-loops"
+          || token == "-rc" || token == "-rcvbuf" || token == "-n" || token == "-netns")
+        {
+          if (iss >> token)
+            {
+              options += " " + token;
+            }
+        }
+    }
+}
+
+bool
+IpBatchHelper::BatchKey::operator < (const BatchKey &o) const
+{
+  if (m_nodeId != o.m_nodeId)
+    {
+      return m_nodeId < o.m_nodeId;
+    }
+  if (m_ts != o.m_ts)
+    {
+      return m_ts < o.m_ts;
+    }
+  return m_options < o.m_options;
+}
+
+IpBatchHelper::IpBatchHelper ()
+  : m_nCommands (0),
+    m_stackSize (1 << 16)
+{
+}
+
+void
+IpBatchHelper::SetStackSize (uint32_t stackSize)
+{
+  m_stackSize = stackSize;
+}
+
+void
+IpBatchHelper::Add (Ptr<Node> node, Time at, std::string command)
+{
+  NS_LOG_FUNCTION (node->GetId () << at << command);
+  BatchKey key;
+  std::string line;
+  SplitIpOptions (command, key.m_options, line);
+  key.m_nodeId = node->GetId ();
+  key.m_ts = at.GetTimeStep ();
+
+  Batch &batch = m_batches[key];
+  if (batch.m_commands.empty ())
+    {
+      batch.m_node = node;
+      batch.m_at = at;
+    }
+  batch.m_commands.push_back (line);
+  m_nCommands++;
+}
+
+void
+IpBatchHelper::Add (NodeContainer nodes, Time at, std::string command)
+{
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Add (*i, at, command);
+    }
+}
+
+uint32_t
+IpBatchHelper::GetNCommands (void) const
+{
+  return m_nCommands;
+}
+
+ApplicationContainer
+IpBatchHelper::Install (void)
+{
+  ApplicationContainer apps;
+  DceApplicationHelper process;
+  process.SetBinary ("ip");
+  process.SetStackSize (m_stackSize);
+
+  for (BatchMap::iterator i = m_batches.begin (); i != m_batches.end (); ++i)
+    {
+      const BatchKey &key = i->first;
+      Batch &batch = i->second;
+
+      std::ostringstream dir, file;
+      dir << "files-" << key.m_nodeId;
+      ::mkdir (dir.str ().c_str (), S_IRWXU | S_IRWXG);
+      file << "/tmp/ip-batch-" << g_ipBatchIndex++;
+      ::mkdir ((dir.str () + "/tmp").c_str (), S_IRWXU | S_IRWXG);
+
+      std::ofstream conf ((dir.str () + file.str ()).c_str ());
+      for (std::vector<std::string>::const_iterator c = batch.m_commands.begin ();
+           c != batch.m_commands.end (); ++c)
+        {
+          conf << *c << std::endl;
+        }
+      conf.close ();
+
+      process.ResetArguments ();
+      if (!key.m_options.empty ())
+        {
+          process.ParseArguments (key.m_options);
+        }
+      process.AddArguments ("-force", "-batch", file.str ());
+      ApplicationContainer app = process.Install (batch.m_node);
+      app.Start (batch.m_at);
+      apps.Add (app);
+    }
+
+  NS_LOG_INFO (m_nCommands << " ip commands in " << apps.GetN () << " processes");
+  m_batches.clear ();
+  m_nCommands = 0;
+  return apps;
+}
+
+} // namespace ns3
@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef IP_BATCH_HELPER_H
+#define IP_BATCH_HELPER_H
+
+#include "ns3/dce-application-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/nstime.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief group ip(8) commands into one "ip -batch" process per node and time.
+ *
+ * Every command added for the same node, the same start time and the
+ * same global options (e.g. "-f inet") is written to one batch file
+ * under files-N/tmp/ and executed by a single ip process, instead of one
+ * process, ELF load and fiber stack per command.  Commands keep the
+ * order in which they were added.
+ */
+class IpBatchHelper
+{
+public:
+  IpBatchHelper ();
+
+  /**
+   * \brief Queue an ip command for the node.
+   *
+   * \param node The node to run the command on.
+   * \param at The simulation time to run the command.
+   * \param command The arguments of ip, as given to RunIp (e.g.
+   *                "-f inet addr add 10.0.0.1/30 dev sim0").
+   */
+  void Add (Ptr<Node> node, Time at, std::string command);
+
+  /**
+   * \brief Queue an ip command for every node in the container.
+   *
+   * \param nodes The nodes to run the command on.
+   * \param at The simulation time to run the command.
+   * \param command The arguments of ip.
+   */
+  void Add (NodeContainer nodes, Time at, std::string command);
+
+  /**
+   * \brief Set the stack size of the ip processes (default 64 KiB).
+   *
+   * \param stackSize The stack size in bytes.
+   */
+  void SetStackSize (uint32_t stackSize);
+
+  /**
+   * \brief Write the batch files and install one ip process per batch.
+   *
+   * Queued commands are consumed, so the helper can be reused for a
+   * later set of commands.
+   *
+   * \returns The ip applications created.
+   */
+  ApplicationContainer Install (void);
+
+  /**
+   * \returns The number of commands waiting to be installed.
+   */
+  uint32_t GetNCommands (void) const;
+
+private:
+  struct BatchKey
+  {
+    uint32_t m_nodeId;
+    int64_t m_ts;
+    std::string m_options;
+    bool operator < (const BatchKey &o) const;
+  };
+  struct Batch
+  {
+    Ptr<Node> m_node;
+    Time m_at;
+    std::vector<std::string> m_commands;
+  };
+  typedef std::map<BatchKey, Batch> BatchMap;
+
+  BatchMap m_batches;
+  uint32_t m_nCommands;
+  uint32_t m_stackSize;
+};
+
+} // namespace ns3
+
+#endif /* IP_BATCH_HELPER_H */
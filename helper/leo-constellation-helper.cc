@@ -0,0 +1,243 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "leo-constellation-helper.h"
+#include "leo-isl-delay-updater.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/string.h"
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("LeoConstellationHelper");
+
+namespace ns3 {
+
+LeoConstellationHelper::LeoConstellationHelper (uint32_t planes, uint32_t satsPerPlane,
+                                                uint32_t phasing, double altitude,
+                                                double inclination)
+  : m_planes (planes),
+    m_satsPerPlane (satsPerPlane),
+    m_phasing (phasing),
+    m_altitude (altitude),
+    m_inclination (inclination),
+    m_network ("10.0.0.0"),
+    m_networkMask ("255.0.0.0")
+{
+  NS_ABORT_MSG_IF (planes < 3 || satsPerPlane < 3,
+                   "a +grid needs at least 3 planes of 3 satellites");
+  NS_ABORT_MSG_IF (phasing >= planes, "Walker phasing factor must be below the number of planes");
+  m_p2p.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  m_p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+}
+
+void
+LeoConstellationHelper::SetIslDeviceAttribute (std::string name, const AttributeValue &value)
+{
+  m_p2p.SetDeviceAttribute (name, value);
+}
+
+void
+LeoConstellationHelper::SetIslChannelAttribute (std::string name, const AttributeValue &value)
+{
+  m_p2p.SetChannelAttribute (name, value);
+}
+
+void
+LeoConstellationHelper::SetAddressBase (Ipv4Address network, Ipv4Mask mask)
+{
+  m_network = network.CombineMask (mask);
+  m_networkMask = mask;
+}
+
+NodeContainer
+LeoConstellationHelper::Create (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nSats = GetNSatellites ();
+  m_nodes.Create (nSats);
+
+  // reserve up front: a constellation shell has thousands of ISLs
+  m_links.clear ();
+  m_links.reserve (2 * nSats);
+  for (uint32_t i = 0; i < 2 * nSats; i++)
+    {
+      m_links.push_back (m_p2p.Install (m_nodes.Get (GetLinkSatelliteA (i)),
+                                        m_nodes.Get (GetLinkSatelliteB (i))));
+    }
+  NS_LOG_INFO ("created " << nSats << " satellites and " << m_links.size () << " ISLs");
+  return m_nodes;
+}
+
+void
+LeoConstellationHelper::AssignAddresses (Time at)
+{
+  NS_LOG_FUNCTION (this << at);
+  NS_ABORT_MSG_IF (m_addresses.GetNLinks () > 0, "ISL addresses already assigned");
+  uint32_t pool = m_addresses.AddPool (m_network, m_networkMask);
+  NS_ABORT_MSG_IF (m_addresses.GetNFree (pool) < m_links.size (),
+                   "address pool too small for " << m_links.size () << " ISLs");
+  m_addresses.Reserve (pool, m_links.size ());
+
+  m_linkControl.SetLoopbackUp (m_nodes, at);
+  for (uint32_t i = 0; i < m_links.size (); i++)
+    {
+      // allocated in ISL order, so allocator link i is ISL i
+      m_addresses.Assign (m_linkControl, m_links[i], pool, at);
+      m_linkControl.SetLinkUp (m_links[i], at + MilliSeconds (1));
+    }
+}
+
+void
+LeoConstellationHelper::EnableOspf (QuaggaHelper &quagga)
+{
+  std::ostringstream network;
+  network << m_network << "/" << m_networkMask.GetPrefixLength ();
+  quagga.EnableOspf (m_nodes, network.str ().c_str ());
+}
+
+ApplicationContainer
+LeoConstellationHelper::Install (DceManagerHelper &dce, QuaggaHelper &quagga, Time at)
+{
+  if (m_nodes.GetN () == 0)
+    {
+      Create ();
+    }
+  dce.Install (m_nodes);
+  AssignAddresses (at);
+  EnableOspf (quagga);
+  return quagga.Install (m_nodes);
+}
+
+Ptr<LeoIslDelayUpdater>
+LeoConstellationHelper::EnableIslDelayUpdates (Time interval)
+{
+  NS_ABORT_MSG_IF (m_links.empty (), "create the constellation before enabling delay updates");
+  Ptr<LeoIslDelayUpdater> updater = CreateObject<LeoIslDelayUpdater> ();
+  updater->SetAttribute ("Interval", TimeValue (interval));
+  updater->Setup (*this);
+  updater->Start (interval);
+  return updater;
+}
+
+NodeContainer
+LeoConstellationHelper::GetNodes (void) const
+{
+  return m_nodes;
+}
+
+uint32_t
+LeoConstellationHelper::GetNPlanes (void) const
+{
+  return m_planes;
+}
+
+uint32_t
+LeoConstellationHelper::GetNSatellitesPerPlane (void) const
+{
+  return m_satsPerPlane;
+}
+
+uint32_t
+LeoConstellationHelper::GetNSatellites (void) const
+{
+  return m_planes * m_satsPerPlane;
+}
+
+uint32_t
+LeoConstellationHelper::GetPhasing (void) const
+{
+  return m_phasing;
+}
+
+double
+LeoConstellationHelper::GetAltitude (void) const
+{
+  return m_altitude;
+}
+
+double
+LeoConstellationHelper::GetInclination (void) const
+{
+  return m_inclination;
+}
+
+uint32_t
+LeoConstellationHelper::GetSatelliteIndex (uint32_t plane, uint32_t slot) const
+{
+  return plane * m_satsPerPlane + slot;
+}
+
+uint32_t
+LeoConstellationHelper::GetNLinks (void) const
+{
+  return m_links.size ();
+}
+
+NetDeviceContainer
+LeoConstellationHelper::GetLink (uint32_t i) const
+{
+  return m_links[i];
+}
+
+uint32_t
+LeoConstellationHelper::GetIntraPlaneLink (uint32_t plane, uint32_t slot) const
+{
+  return 2 * GetSatelliteIndex (plane, slot);
+}
+
+uint32_t
+LeoConstellationHelper::GetInterPlaneLink (uint32_t plane, uint32_t slot) const
+{
+  return 2 * GetSatelliteIndex (plane, slot) + 1;
+}
+
+uint32_t
+LeoConstellationHelper::GetLinkSatelliteA (uint32_t i) const
+{
+  return i / 2;
+}
+
+uint32_t
+LeoConstellationHelper::GetLinkSatelliteB (uint32_t i) const
+{
+  uint32_t plane = (i / 2) / m_satsPerPlane;
+  uint32_t slot = (i / 2) % m_satsPerPlane;
+  if (i % 2 == 0)
+    {
+      return GetSatelliteIndex (plane, (slot + 1) % m_satsPerPlane);
+    }
+  if (plane + 1 < m_planes)
+    {
+      return GetSatelliteIndex (plane + 1, slot);
+    }
+  // seam: plane 0 is ahead by the phasing factor
+  return GetSatelliteIndex (0, (slot + m_phasing) % m_satsPerPlane);
+}
+
+Ipv4Address
+LeoConstellationHelper::GetLinkAddress (uint32_t i, uint32_t side) const
+{
+  return m_addresses.GetAddress (i, side);
+}
+
+const LinkAddressAllocator &
+LeoConstellationHelper::GetAddressAllocator (void) const
+{
+  return m_addresses;
+}
+
+} // namespace ns3
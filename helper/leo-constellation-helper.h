@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef LEO_CONSTELLATION_HELPER_H
+#define LEO_CONSTELLATION_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/dce-manager-helper.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "quagga-helper.h"
+#include "linux-link-control-helper.h"
+#include "link-address-allocator.h"
+#include <vector>
+
+namespace ns3 {
+
+class LeoIslDelayUpdater;
+
+/**
+ * \brief build a Walker-delta LEO constellation with a +grid of
+ * inter-satellite links (ISLs).
+ *
+ * The constellation has \c planes orbital planes of \c satsPerPlane
+ * satellites each, with Walker phasing factor \c phasing (i:t/p/f
+ * notation, t = planes * satsPerPlane, p = planes, f = phasing).
+ * Satellite (plane, slot) is node plane * satsPerPlane + slot.  Every
+ * satellite has four ISLs: to the next and previous slot in its plane,
+ * and to the same slot in the adjacent planes.  Across the seam between
+ * the last and the first plane the slot is shifted by the phasing
+ * factor, so the grid follows the satellites actually facing each other.
+ *
+ * ISL i connects satellite i / 2 either to the next slot in its plane
+ * (even i) or to the next plane (odd i), so link lookups are arithmetic
+ * and nothing is stored per link besides its devices.
+ */
+class LeoConstellationHelper
+{
+public:
+  /**
+   * \param planes The number of orbital planes (>= 3).
+   * \param satsPerPlane The number of satellites in each plane (>= 3).
+   * \param phasing The Walker phasing factor f, in [0, planes).
+   * \param altitude The orbit altitude in km.
+   * \param inclination The orbit inclination in degrees.
+   */
+  LeoConstellationHelper (uint32_t planes, uint32_t satsPerPlane, uint32_t phasing = 1,
+                          double altitude = 550.0, double inclination = 53.0);
+
+  /**
+   * \brief Set an attribute of the ISL PointToPointNetDevices.
+   */
+  void SetIslDeviceAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * \brief Set an attribute of the ISL PointToPointChannels.
+   */
+  void SetIslChannelAttribute (std::string name, const AttributeValue &value);
+
+  /**
+   * \brief Set the network the ISL /30 subnets are taken from
+   * (10.0.0.0/8 by default).
+   */
+  void SetAddressBase (Ipv4Address network, Ipv4Mask mask);
+
+  /**
+   * \brief Create the satellites and the ISLs between them.
+   *
+   * \returns The satellite nodes, indexed by plane * satsPerPlane + slot.
+   */
+  NodeContainer Create (void);
+
+  /**
+   * \brief Address both ends of every ISL, bring them and the loopback up.
+   *
+   * The network stack has to be installed on the nodes beforehand.
+   *
+   * \param at The simulation time to configure the interfaces.
+   */
+  void AssignAddresses (Time at);
+
+  /**
+   * \brief Enable ospfd on every satellite for the ISL address pool.
+   *
+   * \param quagga The helper to configure.
+   */
+  void EnableOspf (QuaggaHelper &quagga);
+
+  /**
+   * \brief Create the constellation and bring it up in one call: create
+   * nodes and ISLs, install the network stack, address the ISLs at
+   * \c at, enable OSPF on the ISL pool and install the Quagga daemons.
+   *
+   * \returns The Quagga applications.
+   */
+  ApplicationContainer Install (DceManagerHelper &dce, QuaggaHelper &quagga, Time at);
+
+  /**
+   * \brief Derive the ISL delays from the orbits instead of the fixed
+   * channel Delay, and keep them updated while the satellites move.
+   *
+   * Has to be called after Create () (or Install ()).
+   *
+   * \param interval The time between two updates.
+   * \returns The updater, already started.
+   */
+  Ptr<LeoIslDelayUpdater> EnableIslDelayUpdates (Time interval);
+
+  NodeContainer GetNodes (void) const;
+  uint32_t GetNPlanes (void) const;
+  uint32_t GetNSatellitesPerPlane (void) const;
+  uint32_t GetNSatellites (void) const;
+  uint32_t GetPhasing (void) const;
+  double GetAltitude (void) const;
+  double GetInclination (void) const;
+
+  /**
+   * \returns The node index of satellite (plane, slot).
+   */
+  uint32_t GetSatelliteIndex (uint32_t plane, uint32_t slot) const;
+
+  uint32_t GetNLinks (void) const;
+
+  /**
+   * \returns The devices of ISL i, satellite A first.
+   */
+  NetDeviceContainer GetLink (uint32_t i) const;
+
+  /**
+   * \returns The ISL from satellite (plane, slot) to the next slot of its plane.
+   */
+  uint32_t GetIntraPlaneLink (uint32_t plane, uint32_t slot) const;
+
+  /**
+   * \returns The ISL from satellite (plane, slot) to the next plane.
+   */
+  uint32_t GetInterPlaneLink (uint32_t plane, uint32_t slot) const;
+
+  /**
+   * \returns The node indexes of the two ends of ISL i.
+   */
+  uint32_t GetLinkSatelliteA (uint32_t i) const;
+  uint32_t GetLinkSatelliteB (uint32_t i) const;
+
+  /**
+   * \returns The address of the end of ISL i on satellite A (side 0) or B
+   * (side 1), once AssignAddresses () was called.
+   */
+  Ipv4Address GetLinkAddress (uint32_t i, uint32_t side) const;
+
+  /**
+   * \returns The allocator of the ISL addresses; its link numbers are the
+   * ISL numbers, so LookupLink () maps an interface address to its ISL.
+   */
+  const LinkAddressAllocator &GetAddressAllocator (void) const;
+
+private:
+  uint32_t m_planes;
+  uint32_t m_satsPerPlane;
+  uint32_t m_phasing;
+  double m_altitude;
+  double m_inclination;
+  Ipv4Address m_network;
+  Ipv4Mask m_networkMask;
+  LinkAddressAllocator m_addresses;
+  PointToPointHelper m_p2p;
+  LinuxLinkControlHelper m_linkControl;
+  NodeContainer m_nodes;
+  std::vector<NetDeviceContainer> m_links;
+};
+
+} // namespace ns3
+
+#endif /* LEO_CONSTELLATION_HELPER_H */
@@ -0,0 +1,205 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "leo-isl-delay-updater.h"
+#include "leo-constellation-helper.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/net-device.h"
+#include "ns3/point-to-point-channel.h"
+#include <cmath>
+
+NS_LOG_COMPONENT_DEFINE ("LeoIslDelayUpdater");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (LeoIslDelayUpdater);
+
+static const double EARTH_RADIUS = 6371.0e3;      // m
+static const double EARTH_MU = 3.986004418e14;    // m^3/s^2
+static const double SPEED_OF_LIGHT = 299792458.0; // m/s
+
+TypeId
+LeoIslDelayUpdater::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoIslDelayUpdater")
+    .SetParent<Object> ()
+    .AddConstructor<LeoIslDelayUpdater> ()
+    .AddAttribute ("Interval",
+                   "Time between two delay updates.",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&LeoIslDelayUpdater::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Tolerance",
+                   "Smallest delay change written to a channel.",
+                   TimeValue (MicroSeconds (1)),
+                   MakeTimeAccessor (&LeoIslDelayUpdater::m_tolerance),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+LeoIslDelayUpdater::LeoIslDelayUpdater ()
+  : m_meanMotion (0),
+    m_zScale (0)
+{
+  TypeId::AttributeInformation info;
+  bool found = PointToPointChannel::GetTypeId ().LookupAttributeByName ("Delay", &info);
+  NS_ASSERT (found);
+  m_delayAccessor = info.accessor;
+}
+
+LeoIslDelayUpdater::~LeoIslDelayUpdater ()
+{
+}
+
+void
+LeoIslDelayUpdater::DoDispose (void)
+{
+  m_event.Cancel ();
+  m_channels.clear ();
+  Object::DoDispose ();
+}
+
+void
+LeoIslDelayUpdater::Setup (const LeoConstellationHelper &leo)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t planes = leo.GetNPlanes ();
+  uint32_t sats = leo.GetNSatellitesPerPlane ();
+  uint32_t total = leo.GetNSatellites ();
+  double r = EARTH_RADIUS + leo.GetAltitude () * 1e3;
+  double inclination = leo.GetInclination () * M_PI / 180.0;
+
+  m_meanMotion = std::sqrt (EARTH_MU / (r * r * r));
+  m_zScale = r * std::sin (inclination);
+  m_phase.resize (total);
+  m_ax.resize (total);
+  m_bx.resize (total);
+  m_ay.resize (total);
+  m_by.resize (total);
+  m_x.resize (total);
+  m_y.resize (total);
+  m_z.resize (total);
+  for (uint32_t p = 0; p < planes; p++)
+    {
+      double raan = 2 * M_PI * p / planes;
+      for (uint32_t k = 0; k < sats; k++)
+        {
+          uint32_t s = leo.GetSatelliteIndex (p, k);
+          m_phase[s] = 2 * M_PI * k / sats + 2 * M_PI * leo.GetPhasing () * p / total;
+          m_ax[s] = r * std::cos (raan);
+          m_bx[s] = r * std::cos (inclination) * std::sin (raan);
+          m_ay[s] = r * std::sin (raan);
+          m_by[s] = r * std::cos (inclination) * std::cos (raan);
+        }
+    }
+
+  uint32_t nLinks = leo.GetNLinks ();
+  m_linkA.resize (nLinks);
+  m_linkB.resize (nLinks);
+  m_delay.assign (nLinks, -1);
+  m_channels.resize (nLinks);
+  for (uint32_t i = 0; i < nLinks; i++)
+    {
+      m_linkA[i] = leo.GetLinkSatelliteA (i);
+      m_linkB[i] = leo.GetLinkSatelliteB (i);
+      m_channels[i] = leo.GetLink (i).Get (0)->GetChannel ();
+    }
+
+  Update (Seconds (0));
+}
+
+void
+LeoIslDelayUpdater::Start (Time at)
+{
+  m_event.Cancel ();
+  // the pending event keeps the updater alive even if nobody holds it
+  m_event = Simulator::Schedule (at, &LeoIslDelayUpdater::DoUpdate,
+                                 Ptr<LeoIslDelayUpdater> (this));
+}
+
+void
+LeoIslDelayUpdater::Stop (void)
+{
+  m_event.Cancel ();
+}
+
+void
+LeoIslDelayUpdater::DoUpdate (void)
+{
+  Update (Simulator::Now ());
+  m_event = Simulator::Schedule (m_interval, &LeoIslDelayUpdater::DoUpdate,
+                                 Ptr<LeoIslDelayUpdater> (this));
+}
+
+uint32_t
+LeoIslDelayUpdater::Update (Time t)
+{
+  uint32_t total = m_phase.size ();
+  uint32_t nLinks = m_linkA.size ();
+  double nt = m_meanMotion * t.GetSeconds ();
+
+  // satellite positions (ECI, circular orbits)
+  for (uint32_t s = 0; s < total; s++)
+    {
+      double cu = std::cos (m_phase[s] + nt);
+      double su = std::sin (m_phase[s] + nt);
+      m_x[s] = cu * m_ax[s] - su * m_bx[s];
+      m_y[s] = cu * m_ay[s] + su * m_by[s];
+      m_z[s] = su * m_zScale;
+    }
+
+  // ISL lengths, written back only where the delay moved enough
+  const double nsPerMeter = 1e9 / SPEED_OF_LIGHT;
+  int64_t tolerance = m_tolerance.GetNanoSeconds ();
+  uint32_t updated = 0;
+  for (uint32_t i = 0; i < nLinks; i++)
+    {
+      uint32_t a = m_linkA[i];
+      uint32_t b = m_linkB[i];
+      double dx = m_x[a] - m_x[b];
+      double dy = m_y[a] - m_y[b];
+      double dz = m_z[a] - m_z[b];
+      int64_t delay = (int64_t)(std::sqrt (dx * dx + dy * dy + dz * dz) * nsPerMeter);
+      int64_t diff = delay - m_delay[i];
+      if (m_delay[i] >= 0 && diff < tolerance && -diff < tolerance)
+        {
+          continue;
+        }
+      m_delay[i] = delay;
+      m_delayAccessor->Set (PeekPointer (m_channels[i]), TimeValue (NanoSeconds (delay)));
+      updated++;
+    }
+  NS_LOG_LOGIC ("t=" << t.GetSeconds () << " updated " << updated << "/" << nLinks << " ISLs");
+  return updated;
+}
+
+Time
+LeoIslDelayUpdater::GetDelay (uint32_t i) const
+{
+  return NanoSeconds (m_delay[i]);
+}
+
+uint32_t
+LeoIslDelayUpdater::GetNLinks (void) const
+{
+  return m_linkA.size ();
+}
+
+} // namespace ns3
@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef LEO_ISL_DELAY_UPDATER_H
+#define LEO_ISL_DELAY_UPDATER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/channel.h"
+#include "ns3/attribute.h"
+#include <vector>
+
+namespace ns3 {
+
+class LeoConstellationHelper;
+
+/**
+ * \brief keep the propagation delay of every ISL channel in line with
+ * the orbital positions of its two satellites.
+ *
+ * Satellites move on circular orbits of a Walker-delta constellation
+ * (RAAN spread over 360 degrees).  Every Interval the positions of all
+ * satellites are computed once into flat coordinate arrays, then the
+ * length of every ISL is computed from its endpoint indexes in a single
+ * pass.  Only channels whose delay moved by at least Tolerance are
+ * written, through a cached attribute accessor, so in-plane ISLs (whose
+ * length is constant) cost nothing after the first update.
+ */
+class LeoIslDelayUpdater : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LeoIslDelayUpdater ();
+  virtual ~LeoIslDelayUpdater ();
+
+  /**
+   * \brief Take the orbits and the ISLs of a constellation created by
+   * the helper, and set every ISL delay for time zero.
+   */
+  void Setup (const LeoConstellationHelper &leo);
+
+  /**
+   * \brief Update the delays every Interval from \c at on.
+   */
+  void Start (Time at);
+
+  void Stop (void);
+
+  /**
+   * \brief Recompute the positions for time \c t and write the delays
+   * that changed.
+   *
+   * \returns The number of channels updated.
+   */
+  uint32_t Update (Time t);
+
+  /**
+   * \returns The current delay of ISL i.
+   */
+  Time GetDelay (uint32_t i) const;
+
+  uint32_t GetNLinks (void) const;
+
+private:
+  virtual void DoDispose (void);
+  void DoUpdate (void);
+
+  Time m_interval;
+  Time m_tolerance;
+  EventId m_event;
+
+  double m_meanMotion;
+  double m_zScale;
+  // per satellite: initial argument of latitude, orbit basis and position
+  std::vector<double> m_phase;
+  std::vector<double> m_ax, m_bx, m_ay, m_by;
+  std::vector<double> m_x, m_y, m_z;
+  // per ISL: endpoints, current delay in ns and channel
+  std::vector<uint32_t> m_linkA, m_linkB;
+  std::vector<int64_t> m_delay;
+  std::vector<Ptr<Channel> > m_channels;
+  Ptr<const AttributeAccessor> m_delayAccessor;
+};
+
+} // namespace ns3
+
+#endif /* LEO_ISL_DELAY_UPDATER_H */
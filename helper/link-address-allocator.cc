@@ -0,0 +1,304 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "link-address-allocator.h"
+#include "linux-link-control-helper.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("LinkAddressAllocator");
+
+namespace ns3 {
+
+static void
+MaskAddress (bool v6, uint8_t prefixLength, uint64_t &hi, uint64_t &lo)
+{
+  if (!v6)
+    {
+      lo &= prefixLength == 0 ? 0 : (0xffffffffULL << (32 - prefixLength)) & 0xffffffffULL;
+    }
+  else if (prefixLength <= 64)
+    {
+      lo = 0;
+      hi &= prefixLength == 0 ? 0 : ~0ULL << (64 - prefixLength);
+    }
+  else
+    {
+      lo &= ~0ULL << (128 - prefixLength);
+    }
+}
+
+static void
+SplitIpv6 (Ipv6Address address, uint64_t &hi, uint64_t &lo)
+{
+  uint8_t buf[16];
+  address.GetBytes (buf);
+  hi = 0;
+  lo = 0;
+  for (uint32_t i = 0; i < 8; i++)
+    {
+      hi = (hi << 8) | buf[i];
+      lo = (lo << 8) | buf[i + 8];
+    }
+}
+
+LinkAddressAllocator::LinkAddressAllocator ()
+{
+}
+
+uint32_t
+LinkAddressAllocator::AddPool (Ipv4Address network, Ipv4Mask mask, uint8_t linkPrefixLength)
+{
+  NS_ABORT_MSG_IF (linkPrefixLength != 30 && linkPrefixLength != 31,
+                   "IPv4 link subnets are /30 or /31");
+  NS_ABORT_MSG_IF (mask.GetPrefixLength () > linkPrefixLength,
+                   "pool " << network << " smaller than a link subnet");
+  return AddPool (false, 0, network.Get (), mask.GetPrefixLength (), linkPrefixLength);
+}
+
+uint32_t
+LinkAddressAllocator::AddPool (Ipv6Address network, Ipv6Prefix prefix)
+{
+  NS_ABORT_MSG_IF (prefix.GetPrefixLength () > 127,
+                   "pool " << network << " smaller than a link subnet");
+  uint64_t hi, lo;
+  SplitIpv6 (network, hi, lo);
+  return AddPool (true, hi, lo, prefix.GetPrefixLength (), 127);
+}
+
+uint32_t
+LinkAddressAllocator::AddPool (bool v6, uint64_t hi, uint64_t lo, uint8_t prefixLength,
+                               uint8_t linkPrefixLength)
+{
+  Pool pool;
+  MaskAddress (v6, prefixLength, hi, lo);
+  pool.m_v6 = v6;
+  pool.m_prefixLength = prefixLength;
+  pool.m_linkPrefixLength = linkPrefixLength;
+  pool.m_shift = (v6 ? 128 : 32) - linkPrefixLength;
+  pool.m_hostOffset = pool.m_shift == 2 ? 1 : 0;
+  pool.m_hi = hi;
+  pool.m_lo = lo;
+  uint32_t subnetBits = linkPrefixLength - prefixLength;
+  pool.m_capacity = subnetBits >= 32 ? 0xffffffff : 1U << subnetBits;
+
+  uint32_t index = m_pools.size ();
+  std::vector<PrefixTable>::iterator table = m_prefixes.begin ();
+  while (table != m_prefixes.end ()
+         && (table->m_v6 != v6 || table->m_prefixLength != prefixLength))
+    {
+      ++table;
+    }
+  if (table == m_prefixes.end ())
+    {
+      PrefixTable t;
+      t.m_v6 = v6;
+      t.m_prefixLength = prefixLength;
+      table = m_prefixes.insert (m_prefixes.end (), t);
+    }
+  bool inserted = table->m_pools.insert (std::make_pair (std::make_pair (hi, lo), index)).second;
+  NS_ABORT_MSG_IF (!inserted, "address pool added twice");
+
+  m_pools.push_back (pool);
+  NS_LOG_INFO ("pool " << index << ": " << pool.m_capacity << " /"
+               << (uint32_t) linkPrefixLength << " subnets");
+  return index;
+}
+
+void
+LinkAddressAllocator::Reserve (uint32_t pool, uint32_t nLinks)
+{
+  NS_ABORT_MSG_IF (pool >= m_pools.size (), "no address pool " << pool);
+  Pool &p = m_pools[pool];
+  p.m_links.reserve (std::min<uint64_t> (p.m_links.size () + (uint64_t) nLinks, p.m_capacity));
+  m_linkPool.reserve (m_linkPool.size () + nLinks);
+  m_linkSubnet.reserve (m_linkSubnet.size () + nLinks);
+}
+
+uint32_t
+LinkAddressAllocator::Allocate (uint32_t pool)
+{
+  NS_ABORT_MSG_IF (pool >= m_pools.size (), "no address pool " << pool);
+  Pool &p = m_pools[pool];
+  uint32_t subnet = p.m_links.size ();
+  NS_ABORT_MSG_IF (subnet >= p.m_capacity,
+                   "address pool " << pool << " exhausted after " << subnet << " links");
+  uint32_t link = m_linkPool.size ();
+  NS_ABORT_MSG_IF (link == NO_LINK, "too many links");
+  p.m_links.push_back (link);
+  m_linkPool.push_back (pool);
+  m_linkSubnet.push_back (subnet);
+  return link;
+}
+
+uint32_t
+LinkAddressAllocator::Assign (LinuxLinkControlHelper &control, NetDeviceContainer link,
+                              uint32_t pool, Time at)
+{
+  NS_ASSERT (link.GetN () == 2);
+  uint32_t index = Allocate (pool);
+  uint8_t prefixLength = m_pools[pool].m_linkPrefixLength;
+  for (uint32_t side = 0; side < 2; side++)
+    {
+      if (m_pools[pool].m_v6)
+        {
+          control.AddAddress (link.Get (side), at, GetAddress6 (index, side), prefixLength);
+        }
+      else
+        {
+          control.AddAddress (link.Get (side), at, GetAddress (index, side), prefixLength);
+        }
+    }
+  return index;
+}
+
+void
+LinkAddressAllocator::GetHostAddress (uint32_t link, uint32_t side,
+                                      uint64_t &hi, uint64_t &lo) const
+{
+  NS_ABORT_MSG_IF (link >= m_linkPool.size (), "no link " << link);
+  NS_ASSERT (side < 2);
+  const Pool &p = m_pools[m_linkPool[link]];
+  // pools hold at most 2^32 subnets, so the host part never carries into m_hi
+  hi = p.m_hi;
+  lo = p.m_lo + ((uint64_t) m_linkSubnet[link] << p.m_shift) + p.m_hostOffset + side;
+}
+
+Ipv4Address
+LinkAddressAllocator::GetAddress (uint32_t link, uint32_t side) const
+{
+  uint64_t hi, lo;
+  GetHostAddress (link, side, hi, lo);
+  NS_ASSERT (!m_pools[m_linkPool[link]].m_v6);
+  return Ipv4Address ((uint32_t) lo);
+}
+
+Ipv6Address
+LinkAddressAllocator::GetAddress6 (uint32_t link, uint32_t side) const
+{
+  uint64_t hi, lo;
+  GetHostAddress (link, side, hi, lo);
+  NS_ASSERT (m_pools[m_linkPool[link]].m_v6);
+  uint8_t buf[16];
+  for (int i = 7; i >= 0; i--)
+    {
+      buf[i] = hi & 0xff;
+      buf[i + 8] = lo & 0xff;
+      hi >>= 8;
+      lo >>= 8;
+    }
+  return Ipv6Address (buf);
+}
+
+uint8_t
+LinkAddressAllocator::GetPrefixLength (uint32_t link) const
+{
+  return m_pools[GetPool (link)].m_linkPrefixLength;
+}
+
+uint32_t
+LinkAddressAllocator::GetPool (uint32_t link) const
+{
+  NS_ABORT_MSG_IF (link >= m_linkPool.size (), "no link " << link);
+  return m_linkPool[link];
+}
+
+uint32_t
+LinkAddressAllocator::LookupLink (Ipv4Address address) const
+{
+  return LookupLink (false, 0, address.Get ());
+}
+
+uint32_t
+LinkAddressAllocator::LookupLink (Ipv6Address address) const
+{
+  uint64_t hi, lo;
+  SplitIpv6 (address, hi, lo);
+  return LookupLink (true, hi, lo);
+}
+
+uint32_t
+LinkAddressAllocator::LookupLink (bool v6, uint64_t hi, uint64_t lo) const
+{
+  // one probe per distinct pool prefix length, usually a single one
+  for (std::vector<PrefixTable>::const_iterator t = m_prefixes.begin ();
+       t != m_prefixes.end (); ++t)
+    {
+      if (t->m_v6 != v6)
+        {
+          continue;
+        }
+      uint64_t mhi = hi, mlo = lo;
+      MaskAddress (v6, t->m_prefixLength, mhi, mlo);
+      std::map<std::pair<uint64_t, uint64_t>, uint32_t>::const_iterator i =
+        t->m_pools.find (std::make_pair (mhi, mlo));
+      if (i == t->m_pools.end ())
+        {
+          continue;
+        }
+      const Pool &p = m_pools[i->second];
+      if (hi != p.m_hi)
+        {
+          return NO_LINK;
+        }
+      uint64_t offset = lo - p.m_lo;
+      uint64_t subnet = offset >> p.m_shift;
+      uint64_t host = (offset & ((1U << p.m_shift) - 1)) - p.m_hostOffset;
+      if (subnet >= p.m_links.size () || host > 1)
+        {
+          return NO_LINK;
+        }
+      return p.m_links[subnet];
+    }
+  return NO_LINK;
+}
+
+uint32_t
+LinkAddressAllocator::GetNPools (void) const
+{
+  return m_pools.size ();
+}
+
+uint32_t
+LinkAddressAllocator::GetNLinks (void) const
+{
+  return m_linkPool.size ();
+}
+
+uint32_t
+LinkAddressAllocator::GetNFree (uint32_t pool) const
+{
+  NS_ABORT_MSG_IF (pool >= m_pools.size (), "no address pool " << pool);
+  return m_pools[pool].m_capacity - m_pools[pool].m_links.size ();
+}
+
+Ipv4Address
+LinkAddressAllocator::GetPoolNetwork (uint32_t pool) const
+{
+  NS_ABORT_MSG_IF (pool >= m_pools.size () || m_pools[pool].m_v6, "no IPv4 pool " << pool);
+  return Ipv4Address ((uint32_t) m_pools[pool].m_lo);
+}
+
+uint8_t
+LinkAddressAllocator::GetPoolPrefixLength (uint32_t pool) const
+{
+  NS_ABORT_MSG_IF (pool >= m_pools.size (), "no address pool " << pool);
+  return m_pools[pool].m_prefixLength;
+}
+
+} // namespace ns3
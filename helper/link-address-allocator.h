@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef LINK_ADDRESS_ALLOCATOR_H
+#define LINK_ADDRESS_ALLOCATOR_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+class LinuxLinkControlHelper;
+
+/**
+ * \brief hand out point-to-point subnets (IPv4 /30 or /31, IPv6 /127)
+ * from a set of address pools.
+ *
+ * Typical use is one pool per OSPF area (e.g. 10.<area>.0.0/16) or a
+ * single pool for a flat topology.  Links are numbered in allocation
+ * order across all pools.  Addresses are computed from the pool base
+ * and the subnet index, so allocating a link only appends two integers
+ * (and nothing at all once Reserve () was called); exhausting a pool
+ * aborts instead of wrapping into the next network.
+ *
+ * LookupLink () maps an interface address back to its link without
+ * scanning the links: the pool is found by its prefix and the subnet
+ * index gives the link directly.
+ */
+class LinkAddressAllocator
+{
+public:
+  /// returned by LookupLink () for addresses outside of any allocated link
+  static const uint32_t NO_LINK = 0xffffffff;
+
+  LinkAddressAllocator ();
+
+  /**
+   * \brief Add an IPv4 pool.
+   *
+   * \param network The pool network.
+   * \param mask The pool mask.
+   * \param linkPrefixLength The prefix length of each link subnet, 30 or 31.
+   * \returns The pool index.
+   */
+  uint32_t AddPool (Ipv4Address network, Ipv4Mask mask, uint8_t linkPrefixLength = 30);
+
+  /**
+   * \brief Add an IPv6 pool of /127 link subnets.
+   *
+   * \param network The pool network.
+   * \param prefix The pool prefix, at most /126.
+   * \returns The pool index.
+   */
+  uint32_t AddPool (Ipv6Address network, Ipv6Prefix prefix);
+
+  /**
+   * \brief Pre-allocate the bookkeeping for nLinks more links from the pool.
+   */
+  void Reserve (uint32_t pool, uint32_t nLinks);
+
+  /**
+   * \brief Take the next free subnet of the pool.
+   *
+   * \returns The link index.
+   */
+  uint32_t Allocate (uint32_t pool);
+
+  /**
+   * \brief Allocate a subnet and address both ends of the link with it.
+   *
+   * \param control The helper used to configure the interfaces.
+   * \param link The two devices of the link.
+   * \param pool The pool to take the subnet from.
+   * \param at The simulation time to configure the interfaces.
+   * \returns The link index.
+   */
+  uint32_t Assign (LinuxLinkControlHelper &control, NetDeviceContainer link,
+                   uint32_t pool, Time at);
+
+  /**
+   * \returns The address of side 0 or 1 of an IPv4 link.
+   */
+  Ipv4Address GetAddress (uint32_t link, uint32_t side) const;
+
+  /**
+   * \returns The address of side 0 or 1 of an IPv6 link.
+   */
+  Ipv6Address GetAddress6 (uint32_t link, uint32_t side) const;
+
+  /**
+   * \returns The prefix length of the link subnet.
+   */
+  uint8_t GetPrefixLength (uint32_t link) const;
+
+  /**
+   * \returns The pool the link was allocated from.
+   */
+  uint32_t GetPool (uint32_t link) const;
+
+  /**
+   * \returns The link that has the address, or NO_LINK.
+   */
+  uint32_t LookupLink (Ipv4Address address) const;
+  uint32_t LookupLink (Ipv6Address address) const;
+
+  uint32_t GetNPools (void) const;
+  uint32_t GetNLinks (void) const;
+
+  /**
+   * \returns The number of subnets left in the pool.
+   */
+  uint32_t GetNFree (uint32_t pool) const;
+
+  /**
+   * \returns The network and prefix length of an IPv4 pool, e.g. for
+   * QuaggaHelper::EnableOspfArea ().
+   */
+  Ipv4Address GetPoolNetwork (uint32_t pool) const;
+  uint8_t GetPoolPrefixLength (uint32_t pool) const;
+
+private:
+  struct Pool
+  {
+    bool m_v6;
+    uint8_t m_prefixLength;
+    uint8_t m_linkPrefixLength;
+    uint8_t m_shift;        // log2 of the addresses per link subnet
+    uint8_t m_hostOffset;   // side 0 address within the subnet
+    uint64_t m_hi;          // network, IPv4 in the low 32 bits of m_lo
+    uint64_t m_lo;
+    uint32_t m_capacity;
+    std::vector<uint32_t> m_links; // subnet index -> link
+  };
+  // pools are found by (family, prefix length) then by network
+  struct PrefixTable
+  {
+    bool m_v6;
+    uint8_t m_prefixLength;
+    std::map<std::pair<uint64_t, uint64_t>, uint32_t> m_pools;
+  };
+
+  uint32_t AddPool (bool v6, uint64_t hi, uint64_t lo, uint8_t prefixLength,
+                    uint8_t linkPrefixLength);
+  uint32_t LookupLink (bool v6, uint64_t hi, uint64_t lo) const;
+  void GetHostAddress (uint32_t link, uint32_t side, uint64_t &hi, uint64_t &lo) const;
+
+  std::vector<Pool> m_pools;
+  std::vector<PrefixTable> m_prefixes;
+  std::vector<uint32_t> m_linkPool;
+  std::vector<uint32_t> m_linkSubnet;
+};
+
+} // namespace ns3
+
+#endif /* LINK_ADDRESS_ALLOCATOR_H */
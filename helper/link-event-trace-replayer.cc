@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "link-event-trace-replayer.h"
+#include "leo-constellation-helper.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/net-device.h"
+#include "ns3/point-to-point-channel.h"
+#include <stdlib.h>
+#include <string.h>
+
+NS_LOG_COMPONENT_DEFINE ("LinkEventTraceReplayer");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (LinkEventTraceReplayer);
+
+static const char TRACE_MAGIC[8] = { 'L', 'N', 'K', 'E', 'V', 'T', '1', '\n' };
+
+/*
+ * Parse one CSV line "time,link,event[,delay]".  Returns false for
+ * blank lines and comments; aborts on malformed lines.
+ */
+static bool
+ParseCsvLine (char *line, uint32_t lineNo, LinkEventTraceReplayer::Record &record)
+{
+  char *p = line;
+  while (*p == ' ' || *p == '\t')
+    {
+      p++;
+    }
+  if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0')
+    {
+      return false;
+    }
+
+  char *end;
+  double t = strtod (p, &end);
+  NS_ABORT_MSG_IF (end == p || *end != ',', "link event trace line " << lineNo << ": bad time");
+  p = end + 1;
+  unsigned long link = strtoul (p, &end, 10);
+  NS_ABORT_MSG_IF (end == p || *end != ',', "link event trace line " << lineNo << ": bad link");
+  p = end + 1;
+  end = p + strcspn (p, ",\r\n");
+
+  record.m_time = (int64_t)(t * 1e9 + 0.5);
+  record.m_link = link;
+  record.m_value = 0;
+  if (end - p == 4 && strncmp (p, "down", 4) == 0)
+    {
+      record.m_type = LinkEventTraceReplayer::LINK_DOWN;
+    }
+  else if (end - p == 2 && strncmp (p, "up", 2) == 0)
+    {
+      record.m_type = LinkEventTraceReplayer::LINK_UP;
+    }
+  else if (end - p == 5 && strncmp (p, "delay", 5) == 0 && *end == ',')
+    {
+      char *v = end + 1;
+      double delay = strtod (v, &end);
+      NS_ABORT_MSG_IF (end == v, "link event trace line " << lineNo << ": bad delay");
+      record.m_type = LinkEventTraceReplayer::LINK_DELAY;
+      record.m_value = (int64_t)(delay * 1e9 + 0.5);
+    }
+  else
+    {
+      NS_ABORT_MSG ("link event trace line " << lineNo << ": unknown event");
+    }
+  return true;
+}
+
+static void
+SetChannelDelay (Ptr<const AttributeAccessor> accessor, Ptr<Channel> channel, Time delay)
+{
+  accessor->Set (PeekPointer (channel), TimeValue (delay));
+}
+
+TypeId
+LinkEventTraceReplayer::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LinkEventTraceReplayer")
+    .SetParent<Object> ()
+    .AddConstructor<LinkEventTraceReplayer> ()
+    .AddAttribute ("Window",
+                   "Span of the trace read and scheduled at once.",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&LinkEventTraceReplayer::m_window),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+LinkEventTraceReplayer::LinkEventTraceReplayer ()
+  : m_file (0),
+    m_binary (false),
+    m_havePending (false),
+    m_lineNo (0),
+    m_nEvents (0)
+{
+  TypeId::AttributeInformation info;
+  bool found = PointToPointChannel::GetTypeId ().LookupAttributeByName ("Delay", &info);
+  NS_ASSERT (found);
+  m_delayAccessor = info.accessor;
+}
+
+LinkEventTraceReplayer::~LinkEventTraceReplayer ()
+{
+  if (m_file)
+    {
+      fclose (m_file);
+    }
+}
+
+void
+LinkEventTraceReplayer::DoDispose (void)
+{
+  m_loadEvent.Cancel ();
+  m_links.clear ();
+  if (m_file)
+    {
+      fclose (m_file);
+      m_file = 0;
+    }
+  Object::DoDispose ();
+}
+
+void
+LinkEventTraceReplayer::AddLink (NetDeviceContainer link)
+{
+  m_links.push_back (link);
+}
+
+void
+LinkEventTraceReplayer::AddLinks (const LeoConstellationHelper &leo)
+{
+  m_links.reserve (m_links.size () + leo.GetNLinks ());
+  for (uint32_t i = 0; i < leo.GetNLinks (); i++)
+    {
+      m_links.push_back (leo.GetLink (i));
+    }
+}
+
+bool
+LinkEventTraceReplayer::Open (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+  if (m_file)
+    {
+      fclose (m_file);
+    }
+  m_havePending = false;
+  m_lineNo = 0;
+  m_file = fopen (filename.c_str (), "rb");
+  if (!m_file)
+    {
+      NS_LOG_WARN ("cannot open " << filename);
+      return false;
+    }
+  char magic[sizeof (TRACE_MAGIC)];
+  m_binary = fread (magic, 1, sizeof (magic), m_file) == sizeof (magic)
+    && memcmp (magic, TRACE_MAGIC, sizeof (magic)) == 0;
+  if (!m_binary)
+    {
+      rewind (m_file);
+    }
+  return true;
+}
+
+void
+LinkEventTraceReplayer::Start (void)
+{
+  NS_ABORT_MSG_IF (!m_file, "no link event trace opened");
+  m_loadEvent.Cancel ();
+  // the pending load keeps the replayer alive even if nobody holds it
+  m_loadEvent = Simulator::Schedule (Seconds (0), &LinkEventTraceReplayer::LoadWindow,
+                                     Ptr<LinkEventTraceReplayer> (this));
+}
+
+uint64_t
+LinkEventTraceReplayer::GetNEvents (void) const
+{
+  return m_nEvents;
+}
+
+bool
+LinkEventTraceReplayer::ReadRecord (Record &record)
+{
+  if (m_binary)
+    {
+      return fread (&record, sizeof (record), 1, m_file) == 1;
+    }
+  char line[256];
+  while (fgets (line, sizeof (line), m_file))
+    {
+      if (ParseCsvLine (line, ++m_lineNo, record))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+LinkEventTraceReplayer::LoadWindow (void)
+{
+  Time now = Simulator::Now ();
+  int64_t end = (now + m_window).GetNanoSeconds ();
+  uint32_t loaded = 0;
+
+  while (m_havePending || ReadRecord (m_pending))
+    {
+      m_havePending = true;
+      if (m_pending.m_time >= end)
+        {
+          break;
+        }
+      m_havePending = false;
+      NS_ABORT_MSG_IF (m_pending.m_link >= m_links.size (),
+                       "link event for unknown link " << m_pending.m_link);
+
+      Time delay = NanoSeconds (m_pending.m_time) - now;
+      if (delay.IsStrictlyNegative ())
+        {
+          NS_LOG_WARN ("link event at " << m_pending.m_time << "ns is out of order");
+          delay = Seconds (0);
+        }
+      const NetDeviceContainer &link = m_links[m_pending.m_link];
+      switch (m_pending.m_type)
+        {
+        case LINK_DOWN:
+          m_linkControl.SetLinkDown (link, delay);
+          break;
+        case LINK_UP:
+          m_linkControl.SetLinkUp (link, delay);
+          break;
+        case LINK_DELAY:
+          Simulator::Schedule (delay, &SetChannelDelay, m_delayAccessor,
+                               link.Get (0)->GetChannel (), NanoSeconds (m_pending.m_value));
+          break;
+        default:
+          NS_ABORT_MSG ("bad link event type " << m_pending.m_type);
+        }
+      loaded++;
+    }
+
+  m_nEvents += loaded;
+  NS_LOG_LOGIC ("t=" << now.GetSeconds () << " loaded " << loaded << " link events");
+  if (m_havePending)
+    {
+      m_loadEvent = Simulator::Schedule (NanoSeconds (end) - now,
+                                         &LinkEventTraceReplayer::LoadWindow,
+                                         Ptr<LinkEventTraceReplayer> (this));
+    }
+}
+
+int64_t
+LinkEventTraceReplayer::ConvertToBinary (std::string csv, std::string binary)
+{
+  FILE *in = fopen (csv.c_str (), "r");
+  if (!in)
+    {
+      return -1;
+    }
+  FILE *out = fopen (binary.c_str (), "wb");
+  if (!out)
+    {
+      fclose (in);
+      return -1;
+    }
+
+  int64_t n = 0;
+  uint32_t lineNo = 0;
+  char line[256];
+  Record record;
+  memset (&record, 0, sizeof (record));
+  fwrite (TRACE_MAGIC, 1, sizeof (TRACE_MAGIC), out);
+  while (fgets (line, sizeof (line), in))
+    {
+      if (ParseCsvLine (line, ++lineNo, record))
+        {
+          fwrite (&record, sizeof (record), 1, out);
+          n++;
+        }
+    }
+  fclose (in);
+  fclose (out);
+  return n;
+}
+
+} // namespace ns3
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef LINK_EVENT_TRACE_REPLAYER_H
+#define LINK_EVENT_TRACE_REPLAYER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/attribute.h"
+#include "ns3/net-device-container.h"
+#include "linux-link-control-helper.h"
+#include <stdio.h>
+#include <vector>
+#include <string>
+
+namespace ns3 {
+
+class LeoConstellationHelper;
+
+/**
+ * \brief replay link up/down and delay-change events from a trace file,
+ * reading it lazily one time window at a time.
+ *
+ * Two trace formats are accepted:
+ *
+ * - CSV, one event per line, '#' starts a comment:
+ *   \verbatim
+     # time(s),link,event[,delay(s)]
+     135.0,0,down
+     150.0,0,up
+     150.0,17,delay,0.0123
+     \endverbatim
+ *
+ * - binary, the 8-byte magic "LNKEVT1\n" followed by fixed 24-byte
+ *   records in host byte order (see LinkEventTraceReplayer::Record);
+ *   ConvertToBinary () produces it from a CSV trace.
+ *
+ * Events have to be sorted by time.  Links are numbered in the order
+ * they were added.  Only the events of the next Window are read and
+ * put in the scheduler; at the end of the window the following one is
+ * loaded, so a multi-day trace never has more than one window of
+ * events pending.
+ */
+class LinkEventTraceReplayer : public Object
+{
+public:
+  enum EventType
+  {
+    LINK_DOWN = 0,
+    LINK_UP = 1,
+    LINK_DELAY = 2
+  };
+
+  struct Record
+  {
+    int64_t m_time;     // ns
+    uint32_t m_link;
+    uint32_t m_type;    // EventType
+    int64_t m_value;    // new delay in ns for LINK_DELAY
+  };
+
+  static TypeId GetTypeId (void);
+
+  LinkEventTraceReplayer ();
+  virtual ~LinkEventTraceReplayer ();
+
+  /**
+   * \brief Register a link; its id is the number of links added before.
+   */
+  void AddLink (NetDeviceContainer link);
+
+  /**
+   * \brief Register every ISL of the constellation, with the ids of the helper.
+   */
+  void AddLinks (const LeoConstellationHelper &leo);
+
+  /**
+   * \brief Open a CSV or binary trace.
+   *
+   * \returns false if the file cannot be opened.
+   */
+  bool Open (std::string filename);
+
+  /**
+   * \brief Start replaying at simulation time zero.
+   */
+  void Start (void);
+
+  /**
+   * \returns The number of events read and scheduled so far.
+   */
+  uint64_t GetNEvents (void) const;
+
+  /**
+   * \brief Convert a CSV trace to the binary format.
+   *
+   * \returns The number of records written, or -1 on error.
+   */
+  static int64_t ConvertToBinary (std::string csv, std::string binary);
+
+private:
+  virtual void DoDispose (void);
+  bool ReadRecord (Record &record);
+  void LoadWindow (void);
+
+  Time m_window;
+  FILE *m_file;
+  bool m_binary;
+  bool m_havePending;
+  Record m_pending;
+  uint32_t m_lineNo;
+  uint64_t m_nEvents;
+  EventId m_loadEvent;
+  std::vector<NetDeviceContainer> m_links;
+  LinuxLinkControlHelper m_linkControl;
+  Ptr<const AttributeAccessor> m_delayAccessor;
+};
+
+} // namespace ns3
+
+#endif /* LINK_EVENT_TRACE_REPLAYER_H */
@@ -0,0 +1,394 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "linux-link-control-helper.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv6.h"
+#include "ns3/linux-socket-fd-factory.h"
+#include "ns3/unix-fd.h"
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+NS_LOG_COMPONENT_DEFINE ("LinuxLinkControlHelper");
+
+namespace ns3 {
+
+/*
+ * A self-contained rtnetlink request.  The message is built in place
+ * when the command is scheduled; the only thing resolved inside the
+ * kernel task is the ifindex, which is patched at m_indexOffset.  Every
+ * request asks for an ack, read back in the same task.
+ */
+struct RtnlRequest
+{
+  char m_ifname[IFNAMSIZ];
+  uint32_t m_indexOffset;
+  uint32_t m_length;
+  uint8_t m_buffer[NLMSG_SPACE (sizeof (struct ifaddrmsg)) + 2 * RTA_SPACE (16)];
+
+  void
+  Begin (const char *ifname, uint16_t type, uint16_t flags, uint32_t bodyLength)
+  {
+    ::memset (this, 0, sizeof (*this));
+    ::strncpy (m_ifname, ifname, IFNAMSIZ - 1);
+    struct nlmsghdr *nlh = (struct nlmsghdr *)m_buffer;
+    nlh->nlmsg_len = NLMSG_LENGTH (bodyLength);
+    nlh->nlmsg_type = type;
+    nlh->nlmsg_flags = NLM_F_REQUEST | NLM_F_ACK | flags;
+    m_length = NLMSG_ALIGN (nlh->nlmsg_len);
+  }
+
+  void *
+  Body (void)
+  {
+    return NLMSG_DATA ((struct nlmsghdr *)m_buffer);
+  }
+
+  void
+  AddAttribute (uint16_t type, const void *data, uint16_t length)
+  {
+    NS_ASSERT (m_length + RTA_SPACE (length) <= sizeof (m_buffer));
+    struct rtattr *rta = (struct rtattr *)(m_buffer + m_length);
+    rta->rta_type = type;
+    rta->rta_len = RTA_LENGTH (length);
+    ::memcpy (RTA_DATA (rta), data, length);
+    m_length += RTA_SPACE (length);
+    ((struct nlmsghdr *)m_buffer)->nlmsg_len = m_length;
+  }
+};
+
+/*
+ * The kernel handles a request while it is written, so its ack (an
+ * NLMSG_ERROR, with error 0 on success) is already queued: read it
+ * without blocking.  On failure the ack echoes the whole request.
+ */
+static void
+ReadRtnlAck (UnixFd *fd, const RtnlRequest &req)
+{
+  uint8_t buffer[NLMSG_SPACE (sizeof (struct nlmsgerr)) + sizeof (req.m_buffer)];
+  struct iovec iov;
+  iov.iov_base = buffer;
+  iov.iov_len = sizeof (buffer);
+  struct msghdr msg;
+  ::memset (&msg, 0, sizeof (msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  ssize_t length = fd->Recvmsg (&msg, MSG_DONTWAIT);
+  int remaining = length;
+  for (struct nlmsghdr *h = (struct nlmsghdr *)buffer; length > 0 && NLMSG_OK (h, remaining);
+       h = NLMSG_NEXT (h, remaining))
+    {
+      if (h->nlmsg_type != NLMSG_ERROR)
+        {
+          continue;
+        }
+      struct nlmsgerr *err = (struct nlmsgerr *)NLMSG_DATA (h);
+      if (err->error != 0)
+        {
+          NS_LOG_WARN ("rtnetlink request " << ((struct nlmsghdr *)req.m_buffer)->nlmsg_type
+                       << " on " << req.m_ifname << " refused: " << ::strerror (-err->error));
+        }
+      return;
+    }
+  NS_LOG_WARN ("no ack for the rtnetlink request on " << req.m_ifname);
+}
+
+static void
+RtnlRequestTask (Ptr<LinuxSocketFdFactory> kernel, RtnlRequest req)
+{
+  UnixFd *fd = kernel->CreateSocket (AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+  if (fd == 0)
+    {
+      NS_LOG_WARN ("unable to open a NETLINK_ROUTE socket");
+      return;
+    }
+
+  struct ifreq ifr;
+  ::memset (&ifr, 0, sizeof (ifr));
+  ::strncpy (ifr.ifr_name, req.m_ifname, IFNAMSIZ - 1);
+  if (fd->Ioctl (SIOCGIFINDEX, (char *)&ifr) < 0)
+    {
+      NS_LOG_WARN ("no such device " << req.m_ifname);
+    }
+  else
+    {
+      int32_t ifindex = ifr.ifr_ifindex;
+      ::memcpy (req.m_buffer + req.m_indexOffset, &ifindex, sizeof (ifindex));
+      if (fd->Write (req.m_buffer, req.m_length) != (ssize_t)req.m_length)
+        {
+          NS_LOG_WARN ("rtnetlink request on " << req.m_ifname << " failed");
+        }
+      else
+        {
+          ReadRtnlAck (fd, req);
+        }
+    }
+  fd->Close ();
+  fd->Unref ();
+}
+
+static void
+ScheduleRtnlRequest (Ptr<Node> node, Time at, const RtnlRequest &req)
+{
+  Ptr<LinuxSocketFdFactory> kernel = node->GetObject<LinuxSocketFdFactory> ();
+  NS_ASSERT (kernel);
+  Simulator::ScheduleWithContext (node->GetId (), at,
+                                  &LinuxSocketFdFactory::ScheduleTask, kernel,
+                                  MakeEvent (&RtnlRequestTask, kernel, req));
+}
+
+static void
+AddIpv4AddressDirect (Ptr<NetDevice> device, Ipv4Address address, uint8_t prefixLength)
+{
+  Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+  int32_t interface = ipv4->GetInterfaceForDevice (device);
+  if (interface == -1)
+    {
+      interface = ipv4->AddInterface (device);
+    }
+  Ipv4Mask mask (prefixLength ? 0xffffffff << (32 - prefixLength) : 0);
+  ipv4->AddAddress (interface, Ipv4InterfaceAddress (address, mask));
+}
+
+static void
+AddIpv6AddressDirect (Ptr<NetDevice> device, Ipv6Address address, uint8_t prefixLength)
+{
+  Ptr<Ipv6> ipv6 = device->GetNode ()->GetObject<Ipv6> ();
+  int32_t interface = ipv6->GetInterfaceForDevice (device);
+  if (interface == -1)
+    {
+      interface = ipv6->AddInterface (device);
+    }
+  ipv6->AddAddress (interface, Ipv6InterfaceAddress (address, Ipv6Prefix (prefixLength)));
+}
+
+static void
+SetLinkStateDirect (Ptr<NetDevice> device, bool up)
+{
+  Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+  int32_t interface = ipv4 ? ipv4->GetInterfaceForDevice (device) : -1;
+  if (interface != -1 && up)
+    {
+      ipv4->SetUp (interface);
+    }
+  else if (interface != -1)
+    {
+      ipv4->SetDown (interface);
+    }
+  Ptr<Ipv6> ipv6 = device->GetNode ()->GetObject<Ipv6> ();
+  interface = ipv6 ? ipv6->GetInterfaceForDevice (device) : -1;
+  if (interface != -1 && up)
+    {
+      ipv6->SetUp (interface);
+    }
+  else if (interface != -1)
+    {
+      ipv6->SetDown (interface);
+    }
+}
+
+static bool
+IsLinuxStack (Ptr<Node> node)
+{
+  return node->GetObject<LinuxSocketFdFactory> () != 0;
+}
+
+LinuxLinkControlHelper::LinuxLinkControlHelper ()
+{
+}
+
+std::string
+LinuxLinkControlHelper::GetInterfaceName (Ptr<NetDevice> device)
+{
+  char name[IFNAMSIZ];
+  Ptr<Node> node = device->GetNode ();
+  if (IsLinuxStack (node))
+    {
+      ::snprintf (name, sizeof (name), "sim%u", device->GetIfIndex ());
+      return std::string (name);
+    }
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  int32_t interface = ipv4 ? ipv4->GetInterfaceForDevice (device) : -1;
+  if (interface < 0)
+    {
+      return "";
+    }
+  ::snprintf (name, sizeof (name), "ns3-device%d", interface);
+  return std::string (name);
+}
+
+void
+LinuxLinkControlHelper::AddAddress (Ptr<NetDevice> device, Time at,
+                                    Ipv4Address address, uint8_t prefixLength)
+{
+  NS_LOG_FUNCTION (device << at << address << (uint32_t)prefixLength);
+  Ptr<Node> node = device->GetNode ();
+  if (!IsLinuxStack (node))
+    {
+      Simulator::ScheduleWithContext (node->GetId (), at, &AddIpv4AddressDirect,
+                                      device, address, prefixLength);
+      return;
+    }
+
+  RtnlRequest req;
+  req.Begin (GetInterfaceName (device).c_str (), RTM_NEWADDR, NLM_F_CREATE | NLM_F_EXCL, sizeof (struct ifaddrmsg));
+  struct ifaddrmsg *ifa = (struct ifaddrmsg *)req.Body ();
+  ifa->ifa_family = AF_INET;
+  ifa->ifa_prefixlen = prefixLength;
+  ifa->ifa_scope = RT_SCOPE_UNIVERSE;
+  req.m_indexOffset = (uint8_t *)&ifa->ifa_index - req.m_buffer;
+  uint8_t buf[4];
+  address.Serialize (buf);
+  req.AddAttribute (IFA_LOCAL, buf, sizeof (buf));
+  req.AddAttribute (IFA_ADDRESS, buf, sizeof (buf));
+  ScheduleRtnlRequest (node, at, req);
+}
+
+void
+LinuxLinkControlHelper::AddAddress (Ptr<NetDevice> device, Time at,
+                                    Ipv6Address address, uint8_t prefixLength)
+{
+  NS_LOG_FUNCTION (device << at << address << (uint32_t)prefixLength);
+  Ptr<Node> node = device->GetNode ();
+  if (!IsLinuxStack (node))
+    {
+      Simulator::ScheduleWithContext (node->GetId (), at, &AddIpv6AddressDirect,
+                                      device, address, prefixLength);
+      return;
+    }
+
+  RtnlRequest req;
+  req.Begin (GetInterfaceName (device).c_str (), RTM_NEWADDR, NLM_F_CREATE | NLM_F_EXCL, sizeof (struct ifaddrmsg));
+  struct ifaddrmsg *ifa = (struct ifaddrmsg *)req.Body ();
+  ifa->ifa_family = AF_INET6;
+  ifa->ifa_prefixlen = prefixLength;
+  ifa->ifa_scope = RT_SCOPE_UNIVERSE;
+  req.m_indexOffset = (uint8_t *)&ifa->ifa_index - req.m_buffer;
+  uint8_t buf[16];
+  address.Serialize (buf);
+  req.AddAttribute (IFA_LOCAL, buf, sizeof (buf));
+  req.AddAttribute (IFA_ADDRESS, buf, sizeof (buf));
+  ScheduleRtnlRequest (node, at, req);
+}
+
+void
+LinuxLinkControlHelper::AddAddress (Ptr<NetDevice> device, Time at, const char *address)
+{
+  char buf[INET6_ADDRSTRLEN + 8];
+  ::strncpy (buf, address, sizeof (buf) - 1);
+  buf[sizeof (buf) - 1] = '\0';
+  char *slash = ::strchr (buf, '/');
+  NS_ABORT_MSG_IF (slash == 0, "address " << address << " has no prefix length");
+  *slash = '\0';
+  uint8_t prefixLength = ::atoi (slash + 1);
+
+  if (::strchr (buf, ':') != 0)
+    {
+      AddAddress (device, at, Ipv6Address (buf), prefixLength);
+    }
+  else
+    {
+      AddAddress (device, at, Ipv4Address (buf), prefixLength);
+    }
+}
+
+void
+LinuxLinkControlHelper::SetLinkState (Ptr<NetDevice> device, Time at, bool up)
+{
+  NS_LOG_FUNCTION (device << at << up);
+  Ptr<Node> node = device->GetNode ();
+  if (!IsLinuxStack (node))
+    {
+      Simulator::ScheduleWithContext (node->GetId (), at, &SetLinkStateDirect, device, up);
+      return;
+    }
+
+  RtnlRequest req;
+  req.Begin (GetInterfaceName (device).c_str (), RTM_NEWLINK, 0, sizeof (struct ifinfomsg));
+  struct ifinfomsg *ifi = (struct ifinfomsg *)req.Body ();
+  ifi->ifi_family = AF_UNSPEC;
+  ifi->ifi_flags = up ? IFF_UP : 0;
+  ifi->ifi_change = IFF_UP;
+  req.m_indexOffset = (uint8_t *)&ifi->ifi_index - req.m_buffer;
+  ScheduleRtnlRequest (node, at, req);
+}
+
+void
+LinuxLinkControlHelper::SetLinkUp (Ptr<NetDevice> device, Time at)
+{
+  SetLinkState (device, at, true);
+}
+
+void
+LinuxLinkControlHelper::SetLinkDown (Ptr<NetDevice> device, Time at)
+{
+  SetLinkState (device, at, false);
+}
+
+void
+LinuxLinkControlHelper::SetLinkUp (NetDeviceContainer devices, Time at)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      SetLinkState (devices.Get (i), at, true);
+    }
+}
+
+void
+LinuxLinkControlHelper::SetLinkDown (NetDeviceContainer devices, Time at)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      SetLinkState (devices.Get (i), at, false);
+    }
+}
+
+void
+LinuxLinkControlHelper::SetLoopbackUp (NodeContainer nodes, Time at)
+{
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      if (!IsLinuxStack (node))
+        {
+          // the ns-3 loopback is up from the start
+          continue;
+        }
+      RtnlRequest req;
+      req.Begin ("lo", RTM_NEWLINK, 0, sizeof (struct ifinfomsg));
+      struct ifinfomsg *ifi = (struct ifinfomsg *)req.Body ();
+      ifi->ifi_family = AF_UNSPEC;
+      ifi->ifi_flags = IFF_UP;
+      ifi->ifi_change = IFF_UP;
+      req.m_indexOffset = (uint8_t *)&ifi->ifi_index - req.m_buffer;
+      ScheduleRtnlRequest (node, at, req);
+    }
+}
+
+} // namespace ns3
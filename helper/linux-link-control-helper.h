@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef LINUX_LINK_CONTROL_HELPER_H
+#define LINUX_LINK_CONTROL_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+#include <string>
+
+namespace ns3 {
+
+/**
+ * \brief configure interface addresses and link state without spawning
+ * an ip(8) process per command.
+ *
+ * With the Linux stack (ns3::LinuxSocketFdFactory) each operation is
+ * encoded as a single rtnetlink message and written to a NETLINK_ROUTE
+ * socket opened inside a kernel task of the node, which gives the same
+ * kernel state as "ip addr add" / "ip link set" without loading the ip
+ * binary or allocating a fiber stack for it.  With the ns-3 stack the
+ * Ipv4/Ipv6 objects of the node are configured directly.  With both
+ * stacks adding an address leaves the link state alone: bring the
+ * interface up with SetLinkUp ().
+ *
+ * Interfaces are named the same way DCE does, see GetInterfaceName ().
+ */
+class LinuxLinkControlHelper
+{
+public:
+  LinuxLinkControlHelper ();
+
+  /**
+   * \brief Add an IPv4 address to the interface of the device (ip addr add).
+   *
+   * \param device The device whose interface gets the address.
+   * \param at The simulation time to apply the change.
+   * \param address The local address.
+   * \param prefixLength The prefix length of the connected network.
+   */
+  void AddAddress (Ptr<NetDevice> device, Time at, Ipv4Address address, uint8_t prefixLength);
+
+  /**
+   * \brief Add an IPv6 address to the interface of the device (ip -6 addr add).
+   *
+   * \param device The device whose interface gets the address.
+   * \param at The simulation time to apply the change.
+   * \param address The local address.
+   * \param prefixLength The prefix length of the connected network.
+   */
+  void AddAddress (Ptr<NetDevice> device, Time at, Ipv6Address address, uint8_t prefixLength);
+
+  /**
+   * \brief Add an address given as "A.B.C.D/len" or "X:X::X:X/len".
+   *
+   * \param device The device whose interface gets the address.
+   * \param at The simulation time to apply the change.
+   * \param address The address and prefix length in CIDR notation.
+   */
+  void AddAddress (Ptr<NetDevice> device, Time at, const char *address);
+
+  /**
+   * \brief Bring the interface of the device up (ip link set simN up).
+   *
+   * \param device The device to bring up.
+   * \param at The simulation time to apply the change.
+   */
+  void SetLinkUp (Ptr<NetDevice> device, Time at);
+
+  /**
+   * \brief Bring the interface of the device down (ip link set simN down).
+   *
+   * \param device The device to bring down.
+   * \param at The simulation time to apply the change.
+   */
+  void SetLinkDown (Ptr<NetDevice> device, Time at);
+
+  /**
+   * \brief Bring up every interface in the container (both ends of a link).
+   *
+   * \param devices The devices to bring up.
+   * \param at The simulation time to apply the change.
+   */
+  void SetLinkUp (NetDeviceContainer devices, Time at);
+
+  /**
+   * \brief Bring down every interface in the container (both ends of a link).
+   *
+   * \param devices The devices to bring down.
+   * \param at The simulation time to apply the change.
+   */
+  void SetLinkDown (NetDeviceContainer devices, Time at);
+
+  /**
+   * \brief Bring the loopback interface of the nodes up (ip link set lo up).
+   *
+   * \param nodes The node(s) to configure.
+   * \param at The simulation time to apply the change.
+   */
+  void SetLoopbackUp (NodeContainer nodes, Time at);
+
+  /**
+   * \brief Get the name of the interface of a device as the stack of its
+   * node, and so the Quagga daemons, see it.
+   *
+   * \param device The device.
+   * \returns "simN" with N the ifindex of the device with the Linux stack,
+   * "ns3-deviceN" with N the Ipv4 interface index with the ns-3 stack, ""
+   * for a device without Ipv4 interface yet.
+   */
+  static std::string GetInterfaceName (Ptr<NetDevice> device);
+
+private:
+  void SetLinkState (Ptr<NetDevice> device, Time at, bool up);
+};
+
+} // namespace ns3
+
+#endif /* LINUX_LINK_CONTROL_HELPER_H */
@@ -0,0 +1,760 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ospf-area-partitioner.h"
+#include "link-address-allocator.h"
+#include "linux-link-control-helper.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("OspfAreaPartitioner");
+
+namespace ns3 {
+
+static const uint32_t NONE = 0xffffffff;
+// boundary refinement passes; each one is O(links)
+static const uint32_t REFINE_PASSES = 8;
+
+OspfAreaPartitioner::OspfAreaPartitioner (NodeContainer nodes)
+  : m_nodes (nodes),
+    m_nAreas (0),
+    m_imbalance (0.1),
+    m_network (Ipv4Address ("10.0.0.0").Get ()),
+    m_prefixLength (8),
+    m_areaPrefixLength (8)
+{
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      uint32_t id = nodes.Get (i)->GetId ();
+      if (id >= m_index.size ())
+        {
+          m_index.resize (id + 1, NONE);
+        }
+      m_index[id] = i;
+    }
+  m_nodeArea.assign (nodes.GetN (), 0);
+  m_abr.assign (nodes.GetN (), false);
+}
+
+uint32_t
+OspfAreaPartitioner::GetIndex (Ptr<NetDevice> device) const
+{
+  uint32_t id = device->GetNode ()->GetId ();
+  NS_ABORT_MSG_IF (id >= m_index.size () || m_index[id] == NONE,
+                   "node " << id << " is not one of the partitioned routers");
+  return m_index[id];
+}
+
+void
+OspfAreaPartitioner::AddLink (NetDeviceContainer link)
+{
+  NS_ABORT_MSG_IF (link.GetN () != 2, "only point-to-point links can be partitioned");
+  m_linkA.push_back (GetIndex (link.Get (0)));
+  m_linkB.push_back (GetIndex (link.Get (1)));
+  m_links.push_back (link);
+  m_linkArea.push_back (0);
+}
+
+void
+OspfAreaPartitioner::SetAddressBase (Ipv4Address network, Ipv4Mask mask)
+{
+  m_network = network.CombineMask (mask).Get ();
+  m_prefixLength = mask.GetPrefixLength ();
+  m_areaPrefixLength = m_prefixLength;
+}
+
+void
+OspfAreaPartitioner::SetImbalance (double imbalance)
+{
+  m_imbalance = imbalance;
+}
+
+void
+OspfAreaPartitioner::BuildAdjacency (void)
+{
+  uint32_t n = m_nodes.GetN ();
+  m_adjStart.assign (n + 1, 0);
+  for (uint32_t l = 0; l < m_linkA.size (); l++)
+    {
+      m_adjStart[m_linkA[l] + 1]++;
+      m_adjStart[m_linkB[l] + 1]++;
+    }
+  for (uint32_t v = 0; v < n; v++)
+    {
+      m_adjStart[v + 1] += m_adjStart[v];
+    }
+  m_adj.resize (m_adjStart[n]);
+  m_adjLink.resize (m_adjStart[n]);
+  std::vector<uint32_t> fill (m_adjStart.begin (), m_adjStart.end () - 1);
+  for (uint32_t l = 0; l < m_linkA.size (); l++)
+    {
+      uint32_t a = m_linkA[l];
+      uint32_t b = m_linkB[l];
+      m_adj[fill[a]] = b;
+      m_adjLink[fill[a]++] = l;
+      m_adj[fill[b]] = a;
+      m_adjLink[fill[b]++] = l;
+    }
+}
+
+/*
+ * Lower dist[] to the hop distance from source where that is shorter.
+ * Run once per seed, it leaves the distance to the nearest seed.
+ */
+static void
+RelaxFrom (uint32_t source, const std::vector<uint32_t> &adjStart,
+           const std::vector<uint32_t> &adj, std::vector<uint32_t> &dist,
+           std::vector<uint32_t> &queue)
+{
+  dist[source] = 0;
+  queue.clear ();
+  queue.push_back (source);
+  for (uint32_t head = 0; head < queue.size (); head++)
+    {
+      uint32_t v = queue[head];
+      for (uint32_t e = adjStart[v]; e < adjStart[v + 1]; e++)
+        {
+          uint32_t w = adj[e];
+          if (dist[w] == NONE || dist[w] > dist[v] + 1)
+            {
+              dist[w] = dist[v] + 1;
+              queue.push_back (w);
+            }
+        }
+    }
+}
+
+// unreachable routers (NONE) are the farthest, so every component gets a seed
+static uint32_t
+Farthest (const std::vector<uint32_t> &dist)
+{
+  uint32_t best = 0;
+  for (uint32_t v = 1; v < dist.size (); v++)
+    {
+      if (dist[v] > dist[best])
+        {
+          best = v;
+        }
+    }
+  return best;
+}
+
+/*
+ * Farthest-point seeding: every new seed is the router with the largest
+ * hop distance to the seeds chosen so far.
+ */
+void
+OspfAreaPartitioner::SelectSeeds (uint32_t nAreas, std::vector<uint32_t> &seeds) const
+{
+  uint32_t n = m_nodes.GetN ();
+  std::vector<uint32_t> dist (n, NONE);
+  std::vector<uint32_t> queue;
+  queue.reserve (n);
+
+  // the router farthest from router 0 is on the periphery
+  RelaxFrom (0, m_adjStart, m_adj, dist, queue);
+  seeds.clear ();
+  seeds.push_back (Farthest (dist));
+  dist.assign (n, NONE);
+  RelaxFrom (seeds[0], m_adjStart, m_adj, dist, queue);
+  while (seeds.size () < nAreas)
+    {
+      seeds.push_back (Farthest (dist));
+      RelaxFrom (seeds.back (), m_adjStart, m_adj, dist, queue);
+    }
+}
+
+/*
+ * Breadth-first growth of all areas at once, always extending the
+ * smallest area that can still grow.
+ */
+void
+OspfAreaPartitioner::Grow (const std::vector<uint32_t> &seeds)
+{
+  uint32_t n = m_nodes.GetN ();
+  uint32_t k = seeds.size ();
+  std::vector<std::vector<uint32_t> > frontier (k);
+  std::vector<uint32_t> head (k, 0);
+  std::vector<uint32_t> size (k, 0);
+  m_nodeArea.assign (n, NONE);
+  for (uint32_t a = 0; a < k; a++)
+    {
+      frontier[a].push_back (seeds[a]);
+    }
+
+  uint32_t assigned = 0;
+  while (assigned < n)
+    {
+      uint32_t area = NONE;
+      for (uint32_t a = 0; a < k; a++)
+        {
+          if (head[a] < frontier[a].size () && (area == NONE || size[a] < size[area]))
+            {
+              area = a;
+            }
+        }
+      if (area == NONE)
+        {
+          // left-over component without a seed: start it in the smallest area
+          uint32_t v = 0;
+          while (m_nodeArea[v] != NONE)
+            {
+              v++;
+            }
+          area = 0;
+          for (uint32_t a = 1; a < k; a++)
+            {
+              area = size[a] < size[area] ? a : area;
+            }
+          frontier[area].push_back (v);
+        }
+      uint32_t v = frontier[area][head[area]++];
+      if (m_nodeArea[v] != NONE)
+        {
+          continue;
+        }
+      m_nodeArea[v] = area;
+      size[area]++;
+      assigned++;
+      for (uint32_t e = m_adjStart[v]; e < m_adjStart[v + 1]; e++)
+        {
+          if (m_nodeArea[m_adj[e]] == NONE)
+            {
+              frontier[area].push_back (m_adj[e]);
+            }
+        }
+    }
+}
+
+/*
+ * Greedy boundary refinement (Fiduccia-Mattheyses without the tentative
+ * moves): move a router to the neighbouring area holding more of its
+ * links, or as many but smaller, within the size limit.
+ */
+void
+OspfAreaPartitioner::Refine (uint32_t nAreas)
+{
+  uint32_t n = m_nodes.GetN ();
+  uint32_t maxSize = (uint32_t)(n * (1.0 + m_imbalance) / nAreas) + 1;
+  std::vector<uint32_t> size (nAreas, 0);
+  for (uint32_t v = 0; v < n; v++)
+    {
+      size[m_nodeArea[v]]++;
+    }
+
+  std::vector<uint32_t> count (nAreas, 0);
+  std::vector<uint32_t> touched;
+  for (uint32_t pass = 0; pass < REFINE_PASSES; pass++)
+    {
+      uint32_t moved = 0;
+      for (uint32_t v = 0; v < n; v++)
+        {
+          uint32_t own = m_nodeArea[v];
+          touched.clear ();
+          for (uint32_t e = m_adjStart[v]; e < m_adjStart[v + 1]; e++)
+            {
+              uint32_t a = m_nodeArea[m_adj[e]];
+              if (count[a]++ == 0)
+                {
+                  touched.push_back (a);
+                }
+            }
+          uint32_t best = own;
+          for (uint32_t i = 0; i < touched.size (); i++)
+            {
+              uint32_t a = touched[i];
+              if (a == own || size[a] + 1 > maxSize)
+                {
+                  continue;
+                }
+              if (count[a] > count[best]
+                  || (count[a] == count[best] && size[a] + 1 < size[best]))
+                {
+                  best = a;
+                }
+            }
+          for (uint32_t i = 0; i < touched.size (); i++)
+            {
+              count[touched[i]] = 0;
+            }
+          if (best != own && size[own] > 1)
+            {
+              m_nodeArea[v] = best;
+              size[own]--;
+              size[best]++;
+              moved++;
+            }
+        }
+      NS_LOG_LOGIC ("refinement pass " << pass << ": " << moved << " routers moved");
+      if (moved == 0)
+        {
+          break;
+        }
+    }
+}
+
+/*
+ * Refinement may split an area; hand every piece but the largest to the
+ * area it has most links to, until every area is in one piece.
+ */
+void
+OspfAreaPartitioner::MakeAreasContiguous (uint32_t nAreas)
+{
+  uint32_t n = m_nodes.GetN ();
+  std::vector<uint32_t> piece (n);
+  std::vector<uint32_t> pieceStart;
+  std::vector<uint32_t> pieceSize;
+  std::vector<uint32_t> largest (nAreas);
+  std::vector<uint32_t> count (nAreas);
+  std::vector<uint32_t> queue;   // routers grouped by piece
+  queue.reserve (n);
+
+  for (uint32_t round = 0; round < REFINE_PASSES; round++)
+    {
+      piece.assign (n, NONE);
+      pieceStart.clear ();
+      pieceSize.clear ();
+      largest.assign (nAreas, NONE);
+      queue.clear ();
+      for (uint32_t s = 0; s < n; s++)
+        {
+          if (piece[s] != NONE)
+            {
+              continue;
+            }
+          uint32_t p = pieceStart.size ();
+          pieceStart.push_back (queue.size ());
+          piece[s] = p;
+          queue.push_back (s);
+          for (uint32_t head = pieceStart[p]; head < queue.size (); head++)
+            {
+              uint32_t v = queue[head];
+              for (uint32_t e = m_adjStart[v]; e < m_adjStart[v + 1]; e++)
+                {
+                  uint32_t w = m_adj[e];
+                  if (piece[w] == NONE && m_nodeArea[w] == m_nodeArea[s])
+                    {
+                      piece[w] = p;
+                      queue.push_back (w);
+                    }
+                }
+            }
+          pieceSize.push_back (queue.size () - pieceStart[p]);
+          uint32_t &l = largest[m_nodeArea[s]];
+          if (l == NONE || pieceSize[p] > pieceSize[l])
+            {
+              l = p;
+            }
+        }
+      pieceStart.push_back (queue.size ());
+
+      uint32_t moved = 0;
+      for (uint32_t p = 0; p + 1 < pieceStart.size (); p++)
+        {
+          uint32_t own = m_nodeArea[queue[pieceStart[p]]];
+          if (largest[own] == p)
+            {
+              continue;
+            }
+          count.assign (nAreas, 0);
+          uint32_t best = own;
+          for (uint32_t i = pieceStart[p]; i < pieceStart[p + 1]; i++)
+            {
+              uint32_t v = queue[i];
+              for (uint32_t e = m_adjStart[v]; e < m_adjStart[v + 1]; e++)
+                {
+                  uint32_t a = m_nodeArea[m_adj[e]];
+                  if (a != own && (++count[a] > count[best] || best == own))
+                    {
+                      best = a;
+                    }
+                }
+            }
+          if (best == own)
+            {
+              // a connected component of its own: nothing to attach it to
+              continue;
+            }
+          for (uint32_t i = pieceStart[p]; i < pieceStart[p + 1]; i++)
+            {
+              m_nodeArea[queue[i]] = best;
+            }
+          moved += pieceSize[p];
+        }
+      NS_LOG_LOGIC (moved << " routers moved to make the areas contiguous");
+      if (moved == 0)
+        {
+          break;
+        }
+    }
+}
+
+/*
+ * Join the pieces of the backbone: from the main piece, follow the
+ * shortest path to the nearest other backbone router and put the links
+ * on the way into area 0, until no other piece is reachable.
+ */
+void
+OspfAreaPartitioner::ConnectBackbone (void)
+{
+  uint32_t n = m_nodes.GetN ();
+  std::vector<uint32_t> piece (n, NONE);
+  std::vector<uint32_t> queue;
+  queue.reserve (n);
+  uint32_t nPieces = 0;
+  for (uint32_t s = 0; s < n; s++)
+    {
+      bool backbone = false;
+      for (uint32_t e = m_adjStart[s]; e < m_adjStart[s + 1] && !backbone; e++)
+        {
+          backbone = m_linkArea[m_adjLink[e]] == 0;
+        }
+      if (!backbone || piece[s] != NONE)
+        {
+          continue;
+        }
+      piece[s] = nPieces;
+      queue.clear ();
+      queue.push_back (s);
+      for (uint32_t head = 0; head < queue.size (); head++)
+        {
+          uint32_t v = queue[head];
+          for (uint32_t e = m_adjStart[v]; e < m_adjStart[v + 1]; e++)
+            {
+              if (m_linkArea[m_adjLink[e]] == 0 && piece[m_adj[e]] == NONE)
+                {
+                  piece[m_adj[e]] = nPieces;
+                  queue.push_back (m_adj[e]);
+                }
+            }
+        }
+      nPieces++;
+    }
+  if (nPieces <= 1)
+    {
+      return;
+    }
+
+  std::vector<bool> joined (nPieces, false);
+  std::vector<uint32_t> parent (n);
+  joined[0] = true;
+  uint32_t added = 0;
+  for (uint32_t round = 1; round < nPieces; round++)
+    {
+      parent.assign (n, NONE);
+      queue.clear ();
+      for (uint32_t v = 0; v < n; v++)
+        {
+          if (piece[v] != NONE && joined[piece[v]])
+            {
+              parent[v] = m_adjLink.size ();    // root marker
+              queue.push_back (v);
+            }
+        }
+      uint32_t reached = NONE;
+      for (uint32_t head = 0; head < queue.size () && reached == NONE; head++)
+        {
+          uint32_t v = queue[head];
+          for (uint32_t e = m_adjStart[v]; e < m_adjStart[v + 1]; e++)
+            {
+              uint32_t w = m_adj[e];
+              if (parent[w] != NONE)
+                {
+                  continue;
+                }
+              parent[w] = e;
+              if (piece[w] != NONE)
+                {
+                  reached = w;
+                  break;
+                }
+              queue.push_back (w);
+            }
+        }
+      if (reached == NONE)
+        {
+          // the rest of the backbone is in another connected component
+          break;
+        }
+      joined[piece[reached]] = true;
+      for (uint32_t v = reached; parent[v] != m_adjLink.size (); )
+        {
+          uint32_t e = parent[v];
+          m_linkArea[m_adjLink[e]] = 0;
+          if (piece[v] == NONE)
+            {
+              piece[v] = 0;
+            }
+          // e is in the adjacency of the previous router on the path
+          v = m_linkA[m_adjLink[e]] == v ? m_linkB[m_adjLink[e]] : m_linkA[m_adjLink[e]];
+          added++;
+        }
+    }
+  NS_LOG_INFO (added << " links moved to area 0 to connect the backbone");
+}
+
+/*
+ * The links ConnectBackbone () moved into area 0 can cut an area in two:
+ * the routers on both sides keep their area, but OSPF needs the links of
+ * an area in one piece.  Move the links of every piece but the largest
+ * into area 0 too.  Each such piece was cut off by backbone links it
+ * touches, so the backbone stays connected.
+ */
+void
+OspfAreaPartitioner::MakeAreaLinksContiguous (void)
+{
+  uint32_t n = m_nodes.GetN ();
+  std::vector<uint32_t> piece (n, NONE);
+  std::vector<uint32_t> pieceSize;
+  std::vector<uint32_t> largest (m_nAreas + 1, NONE);
+  std::vector<uint32_t> queue;
+  queue.reserve (n);
+  for (uint32_t s = 0; s < n; s++)
+    {
+      if (piece[s] != NONE)
+        {
+          continue;
+        }
+      uint32_t p = pieceSize.size ();
+      piece[s] = p;
+      queue.clear ();
+      queue.push_back (s);
+      for (uint32_t head = 0; head < queue.size (); head++)
+        {
+          uint32_t v = queue[head];
+          for (uint32_t e = m_adjStart[v]; e < m_adjStart[v + 1]; e++)
+            {
+              if (m_linkArea[m_adjLink[e]] != 0 && piece[m_adj[e]] == NONE)
+                {
+                  piece[m_adj[e]] = p;
+                  queue.push_back (m_adj[e]);
+                }
+            }
+        }
+      // a router left with backbone links only is a piece of one
+      pieceSize.push_back (queue.size ());
+      uint32_t &l = largest[m_nodeArea[s]];
+      if (l == NONE || pieceSize[p] > pieceSize[l])
+        {
+          l = p;
+        }
+    }
+
+  uint32_t moved = 0;
+  for (uint32_t l = 0; l < m_linkA.size (); l++)
+    {
+      uint32_t a = m_linkArea[l];
+      if (a != 0 && piece[m_linkA[l]] != largest[a])
+        {
+          m_linkArea[l] = 0;
+          moved++;
+        }
+    }
+  NS_LOG_INFO (moved << " links moved to area 0 to keep the areas contiguous");
+}
+
+void
+OspfAreaPartitioner::Partition (uint32_t nAreas)
+{
+  NS_LOG_FUNCTION (this << nAreas);
+  uint32_t n = m_nodes.GetN ();
+  NS_ABORT_MSG_IF (nAreas == 0 || nAreas > n, "cannot make " << nAreas << " areas of " << n << " routers");
+  m_nAreas = nAreas;
+  BuildAdjacency ();
+
+  uint32_t bits = 0;
+  while (nAreas > 1 && (1U << bits) < nAreas + 1)
+    {
+      bits++;
+    }
+  m_areaPrefixLength = m_prefixLength + bits;
+  NS_ABORT_MSG_IF (m_areaPrefixLength > 30, "address base too small for " << nAreas << " areas");
+
+  if (nAreas == 1)
+    {
+      m_nodeArea.assign (n, 0);
+      m_linkArea.assign (m_linkA.size (), 0);
+      m_abr.assign (n, false);
+      return;
+    }
+
+  std::vector<uint32_t> seeds;
+  SelectSeeds (nAreas, seeds);
+  Grow (seeds);
+  Refine (nAreas);
+  MakeAreasContiguous (nAreas);
+
+  for (uint32_t v = 0; v < n; v++)
+    {
+      m_nodeArea[v]++;
+    }
+  for (uint32_t l = 0; l < m_linkA.size (); l++)
+    {
+      uint32_t a = m_nodeArea[m_linkA[l]];
+      m_linkArea[l] = a == m_nodeArea[m_linkB[l]] ? a : 0;
+    }
+  ConnectBackbone ();
+  MakeAreaLinksContiguous ();
+
+  uint32_t cut = 0;
+  m_abr.assign (n, false);
+  for (uint32_t v = 0; v < n; v++)
+    {
+      bool backbone = false, area = false;
+      for (uint32_t e = m_adjStart[v]; e < m_adjStart[v + 1]; e++)
+        {
+          bool b = m_linkArea[m_adjLink[e]] == 0;
+          backbone |= b;
+          area |= !b;
+        }
+      m_abr[v] = backbone && area;
+    }
+  for (uint32_t l = 0; l < m_linkA.size (); l++)
+    {
+      cut += m_linkArea[l] == 0;
+    }
+  NS_LOG_INFO (n << " routers in " << nAreas << " areas, " << cut << "/" << m_linkA.size ()
+                 << " links in area 0, " << GetNAbrs () << " ABRs");
+}
+
+void
+OspfAreaPartitioner::EnableOspf (QuaggaHelper &quagga)
+{
+  NS_ABORT_MSG_IF (m_nAreas == 0, "Partition () has to be called first");
+  std::vector<std::string> prefixes;
+  for (uint32_t a = 0; a <= (m_nAreas > 1 ? m_nAreas : 0); a++)
+    {
+      prefixes.push_back (GetAreaPrefix (a));
+    }
+
+  for (uint32_t v = 0; v < m_nodes.GetN (); v++)
+    {
+      bool backbone = false, area = false;
+      for (uint32_t e = m_adjStart[v]; e < m_adjStart[v + 1]; e++)
+        {
+          bool b = m_linkArea[m_adjLink[e]] == 0;
+          backbone |= b;
+          area |= !b;
+        }
+      uint32_t own = m_nodeArea[v];
+      if (backbone)
+        {
+          quagga.EnableOspfArea (m_nodes.Get (v), prefixes[0].c_str (), 0);
+        }
+      if (area)
+        {
+          quagga.EnableOspfArea (m_nodes.Get (v), prefixes[own].c_str (), own);
+        }
+      if (m_abr[v])
+        {
+          quagga.SetArea (m_nodes.Get (v), prefixes[own].c_str (), own);
+        }
+    }
+}
+
+uint32_t
+OspfAreaPartitioner::AssignAddresses (LinkAddressAllocator &addresses,
+                                      LinuxLinkControlHelper &control, Time at)
+{
+  NS_ABORT_MSG_IF (m_nAreas == 0, "Partition () has to be called first");
+  uint32_t nPools = m_nAreas > 1 ? m_nAreas + 1 : 1;
+  std::vector<uint32_t> pools (nPools);
+  std::vector<uint32_t> count (nPools, 0);
+  for (uint32_t l = 0; l < m_linkArea.size (); l++)
+    {
+      count[m_linkArea[l]]++;
+    }
+  for (uint32_t a = 0; a < nPools; a++)
+    {
+      pools[a] = addresses.AddPool (GetAreaNetwork (a), GetAreaMask (a));
+      addresses.Reserve (pools[a], count[a]);
+    }
+
+  uint32_t first = addresses.GetNLinks ();
+  for (uint32_t l = 0; l < m_links.size (); l++)
+    {
+      addresses.Assign (control, m_links[l], pools[m_linkArea[l]], at);
+      control.SetLinkUp (m_links[l], at + MilliSeconds (1));
+    }
+  return first;
+}
+
+uint32_t
+OspfAreaPartitioner::GetNAreas (void) const
+{
+  return m_nAreas;
+}
+
+uint32_t
+OspfAreaPartitioner::GetNLinks (void) const
+{
+  return m_links.size ();
+}
+
+uint32_t
+OspfAreaPartitioner::GetNodeArea (uint32_t node) const
+{
+  return m_nodeArea[node];
+}
+
+uint32_t
+OspfAreaPartitioner::GetLinkArea (uint32_t i) const
+{
+  return m_linkArea[i];
+}
+
+bool
+OspfAreaPartitioner::IsAbr (uint32_t node) const
+{
+  return m_abr[node];
+}
+
+uint32_t
+OspfAreaPartitioner::GetNAbrs (void) const
+{
+  uint32_t n = 0;
+  for (uint32_t v = 0; v < m_abr.size (); v++)
+    {
+      n += m_abr[v];
+    }
+  return n;
+}
+
+std::string
+OspfAreaPartitioner::GetAreaPrefix (uint32_t area) const
+{
+  std::ostringstream oss;
+  oss << GetAreaNetwork (area) << "/" << (uint32_t) m_areaPrefixLength;
+  return oss.str ();
+}
+
+Ipv4Address
+OspfAreaPartitioner::GetAreaNetwork (uint32_t area) const
+{
+  return Ipv4Address (m_network + (area << (32 - m_areaPrefixLength)));
+}
+
+Ipv4Mask
+OspfAreaPartitioner::GetAreaMask (uint32_t area) const
+{
+  return Ipv4Mask (0xffffffff << (32 - m_areaPrefixLength));
+}
+
+} // namespace ns3
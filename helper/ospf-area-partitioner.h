@@ -0,0 +1,152 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef OSPF_AREA_PARTITIONER_H
+#define OSPF_AREA_PARTITIONER_H
+
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "quagga-helper.h"
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class LinkAddressAllocator;
+class LinuxLinkControlHelper;
+
+/**
+ * \brief split an arbitrary router topology into OSPF areas.
+ *
+ * The routers are partitioned into areas 1..N of balanced size with few
+ * links between them: areas are grown breadth-first from seeds spread
+ * over the topology, then boundary routers are moved to the neighbouring
+ * area holding most of their links as long as the balance allows it.
+ * Links inside an area belong to that area; links between areas form the
+ * backbone (area 0), which is extended along shortest paths until it is
+ * connected; the links of an area cut off by that extension join the
+ * backbone as well, so that every area stays in one piece.  Routers with
+ * links both in the backbone and in their own area are the area border
+ * routers (ABRs).
+ *
+ * Every area gets its own prefix carved from the address base, so the
+ * ABRs can summarize it with "area N range".
+ */
+class OspfAreaPartitioner
+{
+public:
+  /**
+   * \param nodes The routers of the topology.
+   */
+  OspfAreaPartitioner (NodeContainer nodes);
+
+  /**
+   * \brief Add a point-to-point link between two of the routers.
+   */
+  void AddLink (NetDeviceContainer link);
+
+  /**
+   * \brief Set the network the area prefixes are carved from (10.0.0.0/8
+   * by default).
+   */
+  void SetAddressBase (Ipv4Address network, Ipv4Mask mask);
+
+  /**
+   * \brief Set how much larger than the average an area may grow (0.1 by default).
+   */
+  void SetImbalance (double imbalance);
+
+  /**
+   * \brief Partition the routers into areas.
+   *
+   * \param nAreas The number of non-backbone areas; with 1 every link
+   * stays in area 0.
+   */
+  void Partition (uint32_t nAreas);
+
+  /**
+   * \brief Enable ospfd on every router for the areas of its links, and
+   * summarize its area on every ABR.
+   */
+  void EnableOspf (QuaggaHelper &quagga);
+
+  /**
+   * \brief Add one /30 pool per area to the allocator and address every
+   * link from the pool of its area.
+   *
+   * \returns The allocator link index of the first link.
+   */
+  uint32_t AssignAddresses (LinkAddressAllocator &addresses, LinuxLinkControlHelper &control,
+                            Time at);
+
+  uint32_t GetNAreas (void) const;
+  uint32_t GetNLinks (void) const;
+
+  /**
+   * \returns The area the router was put in (1..N, 0 without partitioning).
+   */
+  uint32_t GetNodeArea (uint32_t node) const;
+
+  /**
+   * \returns The area of link i, 0 for the backbone.
+   */
+  uint32_t GetLinkArea (uint32_t i) const;
+
+  bool IsAbr (uint32_t node) const;
+  uint32_t GetNAbrs (void) const;
+
+  /**
+   * \returns The prefix of the area, e.g. "10.16.0.0/12".
+   */
+  std::string GetAreaPrefix (uint32_t area) const;
+  Ipv4Address GetAreaNetwork (uint32_t area) const;
+  Ipv4Mask GetAreaMask (uint32_t area) const;
+
+private:
+  uint32_t GetIndex (Ptr<NetDevice> device) const;
+  void BuildAdjacency (void);
+  void SelectSeeds (uint32_t nAreas, std::vector<uint32_t> &seeds) const;
+  void Grow (const std::vector<uint32_t> &seeds);
+  void Refine (uint32_t nAreas);
+  void MakeAreasContiguous (uint32_t nAreas);
+  void ConnectBackbone (void);
+  void MakeAreaLinksContiguous (void);
+
+  NodeContainer m_nodes;
+  std::vector<uint32_t> m_index;   // node id -> router index
+  std::vector<NetDeviceContainer> m_links;
+  std::vector<uint32_t> m_linkA;
+  std::vector<uint32_t> m_linkB;
+  // adjacency in CSR form: neighbours of v are m_adj[m_adjStart[v] .. m_adjStart[v + 1])
+  std::vector<uint32_t> m_adjStart;
+  std::vector<uint32_t> m_adj;
+  std::vector<uint32_t> m_adjLink;
+
+  uint32_t m_nAreas;
+  double m_imbalance;
+  uint32_t m_network;
+  uint8_t m_prefixLength;
+  uint8_t m_areaPrefixLength;
+  std::vector<uint32_t> m_nodeArea;
+  std::vector<uint32_t> m_linkArea;
+  std::vector<bool> m_abr;
+};
+
+} // namespace ns3
+
+#endif /* OSPF_AREA_PARTITIONER_H */
@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ospf-cost-updater.h"
+#include "linux-link-control-helper.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include <algorithm>
+#include <sstream>
+
+NS_LOG_COMPONENT_DEFINE ("OspfCostUpdater");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (OspfCostUpdater);
+
+TypeId
+OspfCostUpdater::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::OspfCostUpdater")
+    .SetParent<Object> ()
+    .AddConstructor<OspfCostUpdater> ()
+    .AddAttribute ("Interval",
+                   "Time between two cost updates.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&OspfCostUpdater::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Unit",
+                   "Channel delay of one unit of OSPF cost.",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&OspfCostUpdater::m_unit),
+                   MakeTimeChecker ())
+    .AddAttribute ("Threshold",
+                   "Smallest cost change pushed to ospfd.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&OspfCostUpdater::m_threshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("CostChange",
+                     "ospfd accepted a new cost of an interface.",
+                     MakeTraceSourceAccessor (&OspfCostUpdater::m_costChangeTrace),
+                     "ns3::OspfCostUpdater::CostChangeCallback")
+  ;
+  return tid;
+}
+
+OspfCostUpdater::OspfCostUpdater ()
+  : m_threshold (1),
+    m_nChanges (0)
+{
+  m_vty = CreateObject<QuaggaVtyClient> ();
+}
+
+OspfCostUpdater::~OspfCostUpdater ()
+{
+  DetachPushes ();
+}
+
+void
+OspfCostUpdater::DoDispose (void)
+{
+  m_event.Cancel ();
+  DetachPushes ();
+  m_vty = 0;
+  m_devices.clear ();
+  Object::DoDispose ();
+}
+
+// the sessions still open may answer after the updater is gone
+void
+OspfCostUpdater::DetachPushes (void)
+{
+  for (std::set<Ptr<CostPush> >::iterator i = m_pushes.begin (); i != m_pushes.end (); ++i)
+    {
+      (*i)->m_updater = 0;
+    }
+  m_pushes.clear ();
+}
+
+uint32_t
+OspfCostUpdater::GetDelayCost (Ptr<NetDevice> device, Time unit)
+{
+  Ptr<Channel> channel = device->GetChannel ();
+  TimeValue delay;
+  if (!channel || !channel->GetAttributeFailSafe ("Delay", delay))
+    {
+      return 0;
+    }
+  int64_t ns = unit.GetNanoSeconds ();
+  int64_t cost = (delay.Get ().GetNanoSeconds () + ns / 2) / ns;
+  return std::min<int64_t> (std::max<int64_t> (cost, 1), 65535);
+}
+
+void
+OspfCostUpdater::Add (Ptr<NetDevice> device, uint32_t cost)
+{
+  m_devices.push_back (device);
+  m_names.push_back (LinuxLinkControlHelper::GetInterfaceName (device));
+  m_costs.push_back (cost);
+  m_pending.push_back (0);
+}
+
+void
+OspfCostUpdater::Start (Time at)
+{
+  m_event.Cancel ();
+  // the pending event keeps the updater alive even if nobody holds it
+  m_event = Simulator::Schedule (at, &OspfCostUpdater::DoUpdate,
+                                 Ptr<OspfCostUpdater> (this));
+}
+
+void
+OspfCostUpdater::Stop (void)
+{
+  m_event.Cancel ();
+}
+
+void
+OspfCostUpdater::DoUpdate (void)
+{
+  Update ();
+  m_event = Simulator::Schedule (m_interval, &OspfCostUpdater::DoUpdate,
+                                 Ptr<OspfCostUpdater> (this));
+}
+
+uint32_t
+OspfCostUpdater::Update (void)
+{
+  uint32_t nodes = 0;
+  uint32_t changes = 0;
+  std::vector<std::string> commands;
+  Ptr<CostPush> push = Create<CostPush> ();
+  for (uint32_t i = 0; i < m_devices.size (); i++)
+    {
+      uint32_t cost = GetDelayCost (m_devices[i], m_unit);
+      uint32_t old = m_costs[i];
+      if (m_pending[i] == 0 && cost != 0
+          && (old == 0 || std::max (cost, old) - std::min (cost, old) >= m_threshold))
+        {
+          if (commands.empty ())
+            {
+              commands.push_back ("configure terminal");
+            }
+          std::ostringstream line;
+          line << "ip ospf cost " << cost;
+          commands.push_back ("interface " + m_names[i]);
+          commands.push_back (line.str ());
+          m_pending[i] = cost;
+          push->m_interfaces.push_back (i);
+          changes++;
+        }
+
+      // one session per run of interfaces of the same node
+      Ptr<Node> node = m_devices[i]->GetNode ();
+      if (!commands.empty ()
+          && (i + 1 == m_devices.size () || m_devices[i + 1]->GetNode () != node))
+        {
+          commands.push_back ("end");
+          push->m_updater = this;
+          push->m_next = 0;
+          m_vty->Run (node, "ospfd", Seconds (0), commands,
+                      MakeBoundCallback (&OspfCostUpdater::CostPushed, push));
+          m_pushes.insert (push);
+          commands.clear ();
+          push = Create<CostPush> ();
+          nodes++;
+        }
+    }
+  NS_LOG_LOGIC ("t=" << Simulator::Now ().GetSeconds () << " " << changes << " cost changes on "
+                << nodes << " nodes");
+  return nodes;
+}
+
+void
+OspfCostUpdater::CostPushed (Ptr<CostPush> push, uint32_t nodeId, std::string command,
+                             bool ok, std::string output)
+{
+  if (command.compare (0, 12, "ip ospf cost") != 0)
+    {
+      return;
+    }
+  OspfCostUpdater *updater = push->m_updater;
+  if (updater == 0)
+    {
+      return;
+    }
+  uint32_t i = push->m_interfaces[push->m_next++];
+  if (push->m_next == push->m_interfaces.size ())
+    {
+      updater->m_pushes.erase (push);
+    }
+  uint32_t cost = updater->m_pending[i];
+  updater->m_pending[i] = 0;
+  if (!ok)
+    {
+      // unknown: sent again at the next update
+      NS_LOG_LOGIC ("node " << nodeId << ": cost " << cost << " of " << updater->m_names[i]
+                    << " not applied");
+      updater->m_costs[i] = 0;
+      return;
+    }
+  updater->m_costs[i] = cost;
+  updater->m_nChanges++;
+  updater->m_costChangeTrace (nodeId, updater->m_names[i], cost);
+}
+
+Ptr<QuaggaVtyClient>
+OspfCostUpdater::GetVtyClient (void) const
+{
+  return m_vty;
+}
+
+uint64_t
+OspfCostUpdater::GetNChanges (void) const
+{
+  return m_nChanges;
+}
+
+} // namespace ns3
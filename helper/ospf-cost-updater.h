@@ -0,0 +1,144 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef OSPF_COST_UPDATER_H
+#define OSPF_COST_UPDATER_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+#include "ns3/net-device.h"
+#include "ns3/traced-callback.h"
+#include "quagga-vty-client.h"
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief keep the OSPF cost of interfaces in line with the delay of
+ * their channels while ospfd runs.
+ *
+ * Every Interval the cost of every interface is recomputed from the
+ * Delay attribute of its channel (one unit of cost per Unit of delay,
+ * see GetDelayCost ()), e.g. as moved by a LeoIslDelayUpdater.  Costs
+ * that moved by at least Threshold are pushed to the ospfd of their node
+ * through its vty: one session per node per update, with all the changed
+ * interfaces of the node, so that a tick costs one connection per node
+ * whose costs changed and none for the others.  A cost counts as applied
+ * once ospfd accepted its "ip ospf cost" command; a cost the session
+ * failed to apply is sent again at the next update.
+ *
+ * Threshold trades the number of cost changes (LSA floods and SPF runs)
+ * against how closely the costs follow the delays.
+ */
+class OspfCostUpdater : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /**
+   * \param nodeId The node of the interface.
+   * \param interface The interface name as ospfd sees it.
+   * \param cost The new cost.
+   */
+  typedef void (* CostChangeCallback)(uint32_t nodeId, std::string interface, uint32_t cost);
+
+  OspfCostUpdater ();
+  virtual ~OspfCostUpdater ();
+
+  /**
+   * \returns The cost of the channel delay of a device, in units of
+   * \c unit, clamped to 1-65535; 0 for a device without channel or a
+   * channel without Delay attribute.
+   */
+  static uint32_t GetDelayCost (Ptr<NetDevice> device, Time unit);
+
+  /**
+   * \brief Follow the cost of an interface.  Interfaces of the same node
+   * are best added one after the other.
+   *
+   * \param device The device of the interface, named as ospfd sees it
+   *               by LinuxLinkControlHelper::GetInterfaceName ().
+   * \param cost The cost ospfd runs with, 0 if unknown.
+   */
+  void Add (Ptr<NetDevice> device, uint32_t cost);
+
+  /**
+   * \brief Update the costs every Interval from \c at on.
+   */
+  void Start (Time at);
+
+  void Stop (void);
+
+  /**
+   * \brief Recompute the costs and push the ones that changed, skipping
+   * the interfaces whose previous cost is still being pushed.
+   *
+   * \returns The number of nodes sessions were opened for.
+   */
+  uint32_t Update (void);
+
+  /**
+   * \returns The vty client the costs are pushed with.
+   */
+  Ptr<QuaggaVtyClient> GetVtyClient (void) const;
+
+  /**
+   * \returns The number of interface cost changes ospfd accepted so far.
+   */
+  uint64_t GetNChanges (void) const;
+
+private:
+  /**
+   * The interfaces of one session, in the order of their commands.  The
+   * session holds it, so it does not hold the updater: that would keep
+   * the updater and its vty client alive with any session still open.
+   */
+  struct CostPush : public SimpleRefCount<CostPush>
+  {
+    OspfCostUpdater *m_updater;   ///< 0 once the updater is gone
+    std::vector<uint32_t> m_interfaces;
+    uint32_t m_next;
+  };
+
+  virtual void DoDispose (void);
+  void DetachPushes (void);
+  void DoUpdate (void);
+  static void CostPushed (Ptr<CostPush> push, uint32_t nodeId, std::string command,
+                          bool ok, std::string output);
+
+  Time m_interval;
+  Time m_unit;
+  uint32_t m_threshold;
+  EventId m_event;
+  Ptr<QuaggaVtyClient> m_vty;
+  uint64_t m_nChanges;
+  // per interface: device, name, cost ospfd runs with (0 if unknown)
+  // and cost being pushed (0 if none)
+  std::vector<Ptr<NetDevice> > m_devices;
+  std::vector<std::string> m_names;
+  std::vector<uint32_t> m_costs;
+  std::vector<uint32_t> m_pending;
+  std::set<Ptr<CostPush> > m_pushes;   ///< sessions not answered yet
+
+  TracedCallback<uint32_t, std::string, uint32_t> m_costChangeTrace;
+};
+
+} // namespace ns3
+
+#endif /* OSPF_COST_UPDATER_H */
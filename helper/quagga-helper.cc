@@ -20,10 +20,25 @@
 
 #include "ns3/object-factory.h"
 #include "quagga-helper.h"
+#include "quagga-start-policy.h"
 #include "ns3/names.h"
 #include "ns3/ipv4-l3-protocol.h"
+#include "ns3/loopback-net-device.h"
+#include "ospf-cost-updater.h"
+#include "linux-link-control-helper.h"
+#include "ns3/system-thread.h"
+#include "ns3/simulator.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/string.h"
+#include "ns3/node-list.h"
+#include <algorithm>
 #include <fstream>
+#include <iomanip>
+#include <ftw.h>
 #include <sys/stat.h>
+#include <unistd.h>
 #include "ns3/log.h"
 #include <arpa/inet.h>
 
@@ -31,644 +46,385 @@ NS_LOG_COMPONENT_DEFINE ("QuaggaHelper");
 
 namespace ns3 {
 
-class QuaggaConfig : public Object
-{
-private:
-  static int index;
-  std::string router_id;
-  std::map<std::string, uint32_t> *networks;
-public:
-  QuaggaConfig ()
-    : m_zebradebug (false),
-      m_usemanualconf (false)
-  {
-    m_radvd_if = new std::map<std::string, std::string> ();
-    m_haflag_if = new std::vector<std::string> ();
-  }
-  ~QuaggaConfig ()
-  {
-  }
-
-  static TypeId
-  GetTypeId (void)
-  {
-    static TypeId tid = TypeId ("ns3::QuaggaConfig")
-      .SetParent<Object> ()
-      .AddConstructor<QuaggaConfig> ()
-    ;
-    return tid;
-  }
-  TypeId
-  GetInstanceTypeId (void) const
-  {
-    return GetTypeId ();
-  }
-
-  void
-  SetFilename (const std::string &filename)
-  {
-    m_filename = filename;
-  }
-
-  std::string
-  GetFilename () const
-  {
-    return m_filename;
-  }
-
-  bool m_zebradebug;
-  bool m_usemanualconf;
-  std::map<std::string, std::string> *m_radvd_if;
-  std::vector<std::string> *m_haflag_if;
-
-  std::string m_filename;
-
-  std::vector<uint32_t> iflist;
-
-  virtual void
-  Print (std::ostream& os) const
-  {
-    os << "hostname zebra" << std::endl
-       << "password zebra" << std::endl
-       << "log stdout" << std::endl;
-  }
-};
-std::ostream& operator << (std::ostream& os, QuaggaConfig const& config)
-{
-  config.Print (os);
-  return os;
-}
-
-class OspfConfig : public Object
-{
-private:
-  std::string router_id;
-  std::map<std::string, uint32_t> *networks;
-  std::pair<int, std::string> *area_range;
-public:
-  OspfConfig ()
-    : m_ospfdebug (false)
-  {
-    networks = new std::map<std::string, uint32_t> ();
-    iflist = new std::vector<uint32_t> ();
-    area_range = new std::pair<int, std::string> (-1, "");
-  }
-  ~OspfConfig ()
-  {
-    delete networks;
-    delete iflist;
-    delete area_range;
-  }
-
-  bool m_ospfdebug;
-
-  static TypeId
-  GetTypeId (void)
-  {
-    static TypeId tid = TypeId ("ns3::OspfConfig")
-      .SetParent<Object> ()
-      .AddConstructor<OspfConfig> ()
-    ;
-    return tid;
-  }
-  TypeId
-  GetInstanceTypeId (void) const
-  {
-    return GetTypeId ();
-  }
-
-  void
-  addNetwork (std::string prefix, uint32_t area)
-  {
-    networks->insert (std::map<std::string, uint32_t>::value_type (prefix, area));
-  }
-
-  void
-  setArea (std::string prefix, uint32_t area)
-  {
-    *area_range = std::make_pair(area, prefix);
-  }
-
-  void
-  SetRouterId (const char * router_id)
-  {
-    this->router_id = std::string (router_id);
-  }
-
-  void
-  SetFilename (const std::string &filename)
-  {
-    m_filename = filename;
-  }
-
-  std::string
-  GetFilename () const
-  {
-    return m_filename;
-  }
-
-  virtual void
-  Print (std::ostream& os) const
-  {
-    os << "hostname zebra" << std::endl
-       << "password zebra" << std::endl
-       << "log stdout" << std::endl;
-    if (m_ospfdebug)
-      {
-        //os << "log trap errors" << std::endl;
-        os << "debug ospf event " << std::endl;
-        os << "debug ospf nsm " << std::endl;
-        os << "debug ospf ism " << std::endl;
-        os << "debug ospf packet all " << std::endl;
-      }
-
-    for (std::vector<uint32_t>::iterator i = iflist->begin ();
-         i != iflist->end (); ++i)
-      {
-        os << "interface ns3-device" << (*i) << std::endl;
-      }
-
-    os << "router ospf " << std::endl;
-    //    os << "  ospf router-id " << m_routerId << std::endl;
-    for (std::map<std::string, uint32_t>::iterator i = networks->begin ();
-         i != networks->end (); ++i)
-      {
-        os << "  network " << (*i).first << " area " << (*i).second << std::endl;
-      }
-    if (area_range->first != -1) {
-      os << "  area " << area_range->first << " range " << area_range->second << std::endl;
-    }
-    os << " redistribute connected" << std::endl;
-    if (router_id != "") {
-      os << " ospf router-id " << router_id << std::endl;
-    }
-    // for (uint32_t i = 0; i < 4; i++) {
-    //   os << "interface sim" << i << std::endl;
-    //   os << "  ip ospf cost " << (1000 + i) << std::endl;
-    // }
-    os << "!" << std::endl;
-  }
-  std::vector<uint32_t> *iflist;
-  std::string m_filename;
-  uint32_t m_routerId;
+// daemon binaries, by QuaggaHelper::Daemon
+static const char *g_daemonNames[] = {
+  "zebra", "ospfd", "bgpd", "ospf6d", "ripd", "ripngd"
 };
 
-class BgpConfig : public Object
-{
-private:
-  static int index;
-  uint32_t asn;
-  std::string router_id;
-  std::vector<std::string> *neighbors;
-  std::vector<std::string> *peer_links;
-  std::map<std::string, uint32_t> *neighbor_asn;
-  std::vector<std::string> *networks;
-  bool isDefaultOriginate;
-  std::string m_filename;
-
-public:
-  BgpConfig ()
-  {
-    neighbors = new std::vector<std::string> ();
-    neighbor_asn = new std::map<std::string, uint32_t> ();
-    networks = new std::vector<std::string> ();
-    peer_links = new std::vector<std::string> ();
-    isDefaultOriginate = false;
-  }
-  ~BgpConfig ()
-  {
-    delete neighbors;
-    delete neighbor_asn;
-    delete networks;
-    delete peer_links;
-  }
-  static TypeId
-  GetTypeId (void)
-  {
-    static TypeId tid = TypeId ("ns3::BgpConfig")
-      .SetParent<Object> ()
-      .AddConstructor<BgpConfig> ()
-    ;
-    return tid;
-  }
-  TypeId
-  GetInstanceTypeId (void) const
-  {
-    return GetTypeId ();
-  }
-
-  void
-  SetAsn (uint32_t lasn)
-  {
-    asn = lasn + 1;
-    {
-      std::stringstream ss;
-      ss << "192.168.0." << asn;
-      router_id = ss.str ();
-    }
-  }
-
-  uint32_t GetAsn ()
-  {
-    return asn;
-  }
-  void AddNeighbor (std::string n, uint32_t asn)
-  {
-    neighbors->push_back (n);
-    neighbor_asn->insert (std::map<std::string, uint32_t>::value_type (n, asn));
-  }
-  void AddPeerLink (std::string n)
-  {
-    peer_links->push_back (n);
-  }
-  void addNetwork (std::string n)
-  {
-    networks->push_back (n);
-  }
-  void defaultOriginate ()
-  {
-    isDefaultOriginate = true;
-  }
-
-  void
-  SetFilename (const std::string &filename)
-  {
-    m_filename = filename;
-  }
-
-  std::string
-  GetFilename () const
-  {
-    return m_filename;
-  }
-
-  virtual void
-  Print (std::ostream& os) const
-  {
-    os << "hostname bgpd" << std::endl
-       << "password zebra" << std::endl
-       << "log stdout" << std::endl
-       << "debug bgp" << std::endl
-       << "debug bgp fsm" << std::endl
-       << "debug bgp events" << std::endl
-       << "debug bgp updates" << std::endl
-       << "router bgp " << asn << std::endl
-       << "  bgp router-id " << router_id << std::endl;
-    for (std::vector<std::string>::iterator it = neighbors->begin (); it != neighbors->end (); it++)
-      {
-        os << "  neighbor " << *it << " remote-as " << (*neighbor_asn)[*it] << std::endl;
-        os << "  neighbor " << *it << " advertisement-interval 5"  << std::endl;
-      }
-    os << "  redistribute connected" << std::endl;
-    // IPv4
-    os << "  address-family ipv4 unicast" << std::endl;
-    for (std::vector<std::string>::iterator it = neighbors->begin (); it != neighbors->end (); it++)
-      {
-        struct in_addr addr;
-        int ret = ::inet_pton (AF_INET, ((*it).c_str ()), &addr);
-        if (!ret)
-          {
-            continue;
-          }
-        os << "   neighbor " << *it << " activate" << std::endl;
-        os << "   neighbor " << *it << " next-hop-self" << std::endl;
-        if (isDefaultOriginate == true)
-          {
-            os << "   neighbor " << *it << " default-originate" << std::endl;
-          }
-
-        // route-map for peer-neighbor
-        for (std::vector<std::string>::iterator it2 = peer_links->begin (); it2 != peer_links->end (); it2++)
-          {
-            if (*it == *it2)
-              {
-                os << "   neighbor " << *it << " route-map MAP-" << router_id << "-" 
-                   << *it << " out" << std::endl;
-              }
-          }
-
-      }
-    for (std::vector<std::string>::iterator it = networks->begin (); it != networks->end (); it++)
-      {
-        os << "   network " << *it << std::endl;
-      }
-    os << "  exit-address-family" << std::endl;
-
-    // IPv6
-    os << "  address-family ipv6 unicast" << std::endl;
-    for (std::vector<std::string>::iterator it = neighbors->begin (); it != neighbors->end (); it++)
-      {
-        struct in6_addr addr;
-        int ret = ::inet_pton (AF_INET6, ((*it).c_str ()), &addr);
-        if (!ret)
-          {
-            continue;
-          }
-        os << "   neighbor " << *it << " activate" << std::endl;
-        os << "   neighbor " << *it << " next-hop-self" << std::endl;
-        if (isDefaultOriginate == true)
-          {
-            os << "   neighbor " << *it << " default-originate" << std::endl;
-          }
-      }
-    for (std::vector<std::string>::iterator it = networks->begin (); it != networks->end (); it++)
-      {
-        os << "   network " << *it << std::endl;
-      }
-    os << "   redistribute connected" << std::endl;
-    os << "  exit-address-family" << std::endl;
-
-    // access-list and route-map for peer-link filter-out
-    for (std::vector<std::string>::iterator it = networks->begin (); it != networks->end (); it++)
-      {
-        os << "access-list ALIST-" << router_id << " permit " << *it << std::endl;
-      }
-    for (std::vector<std::string>::iterator it = peer_links->begin (); it != peer_links->end (); it++)
-      {
-        os << "route-map MAP-" << router_id << "-" << *it << " permit 5" << std::endl;
-        os << " match ip address ALIST-" << router_id << std::endl;
-        os << "!" << std::endl;
-      }
-
-    os << "!" << std::endl;
-  }
-};
+// Heap bytes held by the config table, for the memory report.
+// Estimates: strings of up to 15 characters are taken as stored in
+// place.
+static uint64_t
+HeapBytes (uint32_t)
+{
+  return 0;
+}
 
-class Ospf6Config : public Object
-{
-private:
-public:
-  std::vector<std::string> *m_enable_if;
-  bool m_ospf6debug;
-  uint32_t m_router_id;
-  std::string m_filename;
-
-  Ospf6Config ()
-  {
-    m_enable_if = new std::vector<std::string> ();
-    m_ospf6debug = false;
-  }
-  ~Ospf6Config ()
-  {
-    delete m_enable_if;
-  }
-  static TypeId
-  GetTypeId (void)
-  {
-    static TypeId tid = TypeId ("ns3::Ospf6Config")
-      .SetParent<Object> ()
-      .AddConstructor<Ospf6Config> ()
-    ;
-    return tid;
-  }
-  TypeId
-  GetInstanceTypeId (void) const
-  {
-    return GetTypeId ();
-  }
-
-
-  void
-  SetFilename (const std::string &filename)
-  {
-    m_filename = filename;
-  }
-
-  std::string
-  GetFilename () const
-  {
-    return m_filename;
-  }
-
-  virtual void
-  Print (std::ostream& os) const
-  {
-    os << "hostname ospf6d" << std::endl
-       << "password zebra" << std::endl
-       << "log stdout" << std::endl
-       << "service advanced-vty" << std::endl;
-
-
-    if (m_ospf6debug)
-      {
-        os << "debug ospf6 neighbor " << std::endl;
-        os << "debug ospf6 message all " << std::endl;
-        os << "debug ospf6 zebra " << std::endl;
-        os << "debug ospf6 interface " << std::endl;
-      }
-
-    for (std::vector<std::string>::iterator i = m_enable_if->begin ();
-         i != m_enable_if->end (); ++i)
-      {
-        os << "interface " << (*i) << std::endl;
-        os << " ipv6 ospf6 retransmit-interval 8" << std::endl;
-        os << "!" << std::endl;
-      }
-
-    for (std::vector<std::string>::iterator i = m_enable_if->begin ();
-         i != m_enable_if->end (); ++i)
-      {
-        if (i == m_enable_if->begin ())
-          {
-            os << "router ospf6" << std::endl;
-          }
-
-        os << " router-id 255.1.1." << (m_router_id % 255) << std::endl;
-        os << " interface " << (*i) << " area 0.0.0.0" << std::endl;
-        os << " redistribute connected" << std::endl;
-
-        if (i == m_enable_if->begin ())
-          {
-            os << "!" << std::endl;
-          }
-      }
-  }
-};
+static uint64_t
+HeapBytes (const std::string &s)
+{
+  return s.capacity () > 15 ? s.capacity () + 1 : 0;
+}
 
-class RipConfig : public Object
-{
-private:
-public:
-  std::vector<std::string> *m_enable_if;
-  bool m_ripdebug;
-  std::string m_filename;
-
-  RipConfig ()
-  {
-    m_enable_if = new std::vector<std::string> ();
-    m_ripdebug = false;
-  }
-  ~RipConfig ()
-  {
-    delete m_enable_if;
-  }
-  static TypeId
-  GetTypeId (void)
-  {
-    static TypeId tid = TypeId ("ns3::RipConfig")
-      .SetParent<Object> ()
-      .AddConstructor<RipConfig> ()
-    ;
-    return tid;
-  }
-  TypeId
-  GetInstanceTypeId (void) const
-  {
-    return GetTypeId ();
-  }
-
-
-  void
-  SetFilename (const std::string &filename)
-  {
-    m_filename = filename;
-  }
-
-  std::string
-  GetFilename () const
-  {
-    return m_filename;
-  }
-
-  virtual void
-  Print (std::ostream& os) const
-  {
-    os << "hostname ripd" << std::endl
-       << "password zebra" << std::endl
-       << "log stdout" << std::endl
-       << "service advanced-vty" << std::endl;
-
-    if (m_ripdebug)
-      {
-        os << "debug rip events " << std::endl;
-        os << "debug rip packet send detail " << std::endl;
-        os << "debug rip packet recv detail " << std::endl;
-        os << "debug rip zebra " << std::endl;
-      }
-
-    for (std::vector<std::string>::iterator i = m_enable_if->begin ();
-         i != m_enable_if->end (); ++i)
-      {
-        if (i == m_enable_if->begin ())
-          {
-            os << "router rip" << std::endl;
-          }
-
-        os << " network " << (*i) << std::endl;
-        os << " redistribute connected" << std::endl;
-
-        if (i == m_enable_if->begin ())
-          {
-            os << "!" << std::endl;
-          }
-      }
-  }
-};
+template <typename A, typename B>
+static uint64_t
+HeapBytes (const std::pair<A, B> &p)
+{
+  return HeapBytes (p.first) + HeapBytes (p.second);
+}
 
-class RipngConfig : public Object
-{
-private:
-public:
-  std::vector<std::string> *m_enable_if;
-  bool m_ripngdebug;
-  std::string m_filename;
-
-  RipngConfig ()
-  {
-    m_enable_if = new std::vector<std::string> ();
-    m_ripngdebug = false;
-  }
-  ~RipngConfig ()
-  {
-    delete m_enable_if;
-  }
-  static TypeId
-  GetTypeId (void)
-  {
-    static TypeId tid = TypeId ("ns3::RipngConfig")
-      .SetParent<Object> ()
-      .AddConstructor<RipngConfig> ()
-    ;
-    return tid;
-  }
-  TypeId
-  GetInstanceTypeId (void) const
-  {
-    return GetTypeId ();
-  }
-
-
-  void
-  SetFilename (const std::string &filename)
-  {
-    m_filename = filename;
-  }
-
-  std::string
-  GetFilename () const
-  {
-    return m_filename;
-  }
-
-  virtual void
-  Print (std::ostream& os) const
-  {
-    os << "hostname ripngd" << std::endl
-       << "password zebra" << std::endl
-       << "log stdout" << std::endl
-       << "service advanced-vty" << std::endl;
-
-    if (m_ripngdebug)
-      {
-        os << "debug ripng events " << std::endl;
-        os << "debug ripng packet send detail " << std::endl;
-        os << "debug ripng packet recv detail " << std::endl;
-        os << "debug ripng zebra " << std::endl;
-      }
-
-    for (std::vector<std::string>::iterator i = m_enable_if->begin ();
-         i != m_enable_if->end (); ++i)
-      {
-        if (i == m_enable_if->begin ())
-          {
-            os << "router ripng" << std::endl;
-          }
-
-        os << " network " << (*i) << std::endl;
-        os << " redistribute connected" << std::endl;
-
-        if (i == m_enable_if->begin ())
-          {
-            os << "!" << std::endl;
-          }
-      }
-  }
-};
+template <typename T>
+static uint64_t
+HeapBytes (const std::vector<T> &v)
+{
+  uint64_t bytes = v.capacity () * sizeof (T);
+  for (typename std::vector<T>::const_iterator i = v.begin (); i != v.end (); ++i)
+    {
+      bytes += HeapBytes (*i);
+    }
+  return bytes;
+}
+
+template <typename T>
+static void
+ShrinkToFit (std::vector<T> &v)
+{
+  std::vector<T> (v).swap (v);
+}
+
+template <typename T>
+static void
+Clear (T &container)
+{
+  T ().swap (container);
+}
+
+// Insert in a list kept sorted by key; an existing key keeps its value.
+template <typename V>
+static void
+InsertSorted (std::vector<std::pair<std::string, V> > &v, const std::string &key, const V &value)
+{
+  typename std::vector<std::pair<std::string, V> >::iterator i = v.begin ();
+  while (i != v.end () && i->first < key)
+    {
+      ++i;
+    }
+  if (i == v.end () || i->first != key)
+    {
+      v.insert (i, std::make_pair (key, value));
+    }
+}
+
+NS_OBJECT_ENSURE_REGISTERED (QuaggaHelper);
+
+TypeId
+QuaggaHelper::GetTypeId (void)
+{
+  // bgpd recurses deeper with a large RIB; the heap budgets are
+  // estimates of what each daemon allocates
+  static TypeId tid = TypeId ("ns3::QuaggaHelper")
+    .SetParent<ObjectBase> ()
+    .SetGroupName ("DceQuagga")
+    .AddAttribute ("StartPolicy",
+                   "TypeId of the QuaggaStartPolicy deciding when the daemons start "
+                   "(see its attributes for the offsets).",
+                   StringValue ("ns3::QuaggaUniformStartPolicy"),
+                   MakeStringAccessor (&QuaggaHelper::m_startPolicyType),
+                   MakeStringChecker ())
+    .AddAttribute ("ZebraStackSize", "Fiber stack size of zebra, in bytes.",
+                   UintegerValue (1 << 16),
+                   MakeUintegerAccessor (&QuaggaHelper::m_zebraStackSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("OspfdStackSize", "Fiber stack size of ospfd, in bytes.",
+                   UintegerValue (1 << 16),
+                   MakeUintegerAccessor (&QuaggaHelper::m_ospfdStackSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BgpdStackSize", "Fiber stack size of bgpd, in bytes.",
+                   UintegerValue (1 << 18),
+                   MakeUintegerAccessor (&QuaggaHelper::m_bgpdStackSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("Ospf6dStackSize", "Fiber stack size of ospf6d, in bytes.",
+                   UintegerValue (1 << 16),
+                   MakeUintegerAccessor (&QuaggaHelper::m_ospf6dStackSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RipdStackSize", "Fiber stack size of ripd, in bytes.",
+                   UintegerValue (1 << 16),
+                   MakeUintegerAccessor (&QuaggaHelper::m_ripdStackSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("RipngdStackSize", "Fiber stack size of ripngd, in bytes.",
+                   UintegerValue (1 << 16),
+                   MakeUintegerAccessor (&QuaggaHelper::m_ripngdStackSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ZebraHeapBudget", "Memory zebra is expected to allocate, in bytes.",
+                   UintegerValue (4 << 20),
+                   MakeUintegerAccessor (&QuaggaHelper::m_zebraHeapBudget),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("OspfdHeapBudget", "Memory ospfd is expected to allocate, in bytes.",
+                   UintegerValue (8 << 20),
+                   MakeUintegerAccessor (&QuaggaHelper::m_ospfdHeapBudget),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("BgpdHeapBudget", "Memory bgpd is expected to allocate, in bytes.",
+                   UintegerValue (16 << 20),
+                   MakeUintegerAccessor (&QuaggaHelper::m_bgpdHeapBudget),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("Ospf6dHeapBudget", "Memory ospf6d is expected to allocate, in bytes.",
+                   UintegerValue (8 << 20),
+                   MakeUintegerAccessor (&QuaggaHelper::m_ospf6dHeapBudget),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("RipdHeapBudget", "Memory ripd is expected to allocate, in bytes.",
+                   UintegerValue (4 << 20),
+                   MakeUintegerAccessor (&QuaggaHelper::m_ripdHeapBudget),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("RipngdHeapBudget", "Memory ripngd is expected to allocate, in bytes.",
+                   UintegerValue (4 << 20),
+                   MakeUintegerAccessor (&QuaggaHelper::m_ripngdHeapBudget),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("ZebraDebug", "Enable the zebra debug logs on every node installed.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuaggaHelper::m_zebraDebug),
+                   MakeBooleanChecker ())
+    .AddAttribute ("OspfDebug", "Enable the ospfd debug logs on every node installed.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuaggaHelper::m_ospfDebug),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Ospf6Debug", "Enable the ospf6d debug logs on every node installed.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuaggaHelper::m_ospf6Debug),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RipDebug", "Enable the ripd debug logs on every node installed.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuaggaHelper::m_ripDebug),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RipngDebug", "Enable the ripngd debug logs on every node installed.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuaggaHelper::m_ripngDebug),
+                   MakeBooleanChecker ())
+    .AddAttribute ("BgpAdvertisementInterval",
+                   "BGP neighbor advertisement-interval, in seconds.",
+                   UintegerValue (5),
+                   MakeUintegerAccessor (&QuaggaHelper::m_bgpAdvertisementInterval),
+                   MakeUintegerChecker<uint32_t> (0, 600))
+    .AddAttribute ("Ospf6RetransmitInterval",
+                   "OSPFv3 interface retransmit-interval, in seconds.",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&QuaggaHelper::m_ospf6RetransmitInterval),
+                   MakeUintegerChecker<uint32_t> (1, 65535))
+    .AddAttribute ("ConfigStore",
+                   "Absolute directory to keep the config files in, e.g. on tmpfs; "
+                   "empty for the working directory.",
+                   StringValue (""),
+                   MakeStringAccessor (&QuaggaHelper::m_configStore),
+                   MakeStringChecker ())
+    .AddAttribute ("ConfigDedup",
+                   "Write each distinct config file once and hard link the copies.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QuaggaHelper::m_configDedup),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ReleaseConfigs",
+                   "Empty the configs of the nodes once their files are written, "
+                   "instead of keeping them for a later Install () of the nodes.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&QuaggaHelper::m_releaseConfigs),
+                   MakeBooleanChecker ())
+    .AddAttribute ("OspfPointToPoint",
+                   "Make the OSPF interfaces of point-to-point devices point-to-point, "
+                   "skipping the DR/BDR election.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&QuaggaHelper::m_ospfPointToPoint),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ConfigThreads",
+                   "Number of threads writing the config files, 0 for one per CPU.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QuaggaHelper::m_configThreads),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+TypeId
+QuaggaHelper::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
 
 QuaggaHelper::QuaggaHelper ()
 {
+  m_configMemory.m_nodes = 0;
+  m_configMemory.m_rendered = 0;
+  m_configMemory.m_compacted = 0;
+  // attribute defaults, from Config::SetDefault, NS_ATTRIBUTE_DEFAULT or
+  // the command line
+  ObjectBase::ConstructSelf (AttributeConstructionList ());
+  for (uint32_t d = 0; d < N_DAEMONS; d++)
+    {
+      m_usage[d].m_count = 0;
+      m_usage[d].m_stack = 0;
+      m_usage[d].m_heap = 0;
+    }
+}
+
+uint32_t QuaggaHelper::*
+QuaggaHelper::StackSizeMember (Daemon daemon)
+{
+  static uint32_t QuaggaHelper::*const members[N_DAEMONS] = {
+    &QuaggaHelper::m_zebraStackSize, &QuaggaHelper::m_ospfdStackSize,
+    &QuaggaHelper::m_bgpdStackSize, &QuaggaHelper::m_ospf6dStackSize,
+    &QuaggaHelper::m_ripdStackSize, &QuaggaHelper::m_ripngdStackSize
+  };
+  return members[daemon];
+}
+
+uint64_t QuaggaHelper::*
+QuaggaHelper::HeapBudgetMember (Daemon daemon)
+{
+  static uint64_t QuaggaHelper::*const members[N_DAEMONS] = {
+    &QuaggaHelper::m_zebraHeapBudget, &QuaggaHelper::m_ospfdHeapBudget,
+    &QuaggaHelper::m_bgpdHeapBudget, &QuaggaHelper::m_ospf6dHeapBudget,
+    &QuaggaHelper::m_ripdHeapBudget, &QuaggaHelper::m_ripngdHeapBudget
+  };
+  return members[daemon];
 }
 
 void
-QuaggaHelper::SetAttribute (std::string name, const AttributeValue &value)
+QuaggaHelper::SetStartPolicy (Ptr<QuaggaStartPolicy> policy)
 {
+  m_startPolicy = policy;
+}
+
+Ptr<QuaggaVtyClient>
+QuaggaHelper::GetVtyClient (void)
+{
+  if (!m_vty)
+    {
+      m_vty = CreateObject<QuaggaVtyClient> ();
+    }
+  return m_vty;
 }
 
-// OSPF
 void
-QuaggaHelper::EnableOspf (NodeContainer nodes, const char *network)
+QuaggaHelper::QueryVty (NodeContainer nodes, std::string daemon, Time at, std::string command,
+                        QuaggaVtyClient::OutputCallback callback)
 {
+  std::vector<std::string> commands (1, command);
+  Ptr<QuaggaVtyClient> vty = GetVtyClient ();
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<OspfConfig> ospf_conf = nodes.Get (i)->GetObject<OspfConfig> ();
-      if (!ospf_conf)
-        {
-          ospf_conf = new OspfConfig ();
-          nodes.Get (i)->AggregateObject (ospf_conf);
-        }
+      vty->Run (nodes.Get (i), daemon, at, commands, callback);
+    }
+}
+
+void
+QuaggaHelper::SetConfigDedup (bool enable)
+{
+  m_configDedup = enable;
+}
+
+void
+QuaggaHelper::SetConfigThreads (uint32_t nThreads)
+{
+  m_configThreads = std::max (nThreads, 1u);
+}
+
+uint32_t
+QuaggaHelper::GetConfigThreads (void) const
+{
+  if (m_configThreads > 0)
+    {
+      return m_configThreads;
+    }
+  long cpus = ::sysconf (_SC_NPROCESSORS_ONLN);
+  return cpus > 0 ? cpus : 1;
+}
+
+void
+QuaggaHelper::SetConfigStore (std::string dir)
+{
+  NS_ABORT_MSG_IF (!m_confDirs.empty () && dir != m_configStore,
+                   "config store changed after the first Install ()");
+  m_configStore = dir;
+}
+
+// Config table
+
+uint32_t
+QuaggaHelper::GetConfigEntry (Ptr<Node> node)
+{
+  uint32_t id = node->GetId ();
+  if (id < m_configs.m_enabled.size ())
+    {
+      return id;
+    }
+
+  // grown for every node at once rather than node by node
+  uint32_t n = std::max (id + 1, NodeList::GetNNodes ());
+  ConfigTable &t = m_configs;
+  t.m_enabled.resize (n, 0);
+  t.m_dirty.resize (n, 0);
+  t.m_released.resize (n, 0);
+  t.m_debug.resize (n, 0);
+  t.m_manualZebra.resize (n, 0);
+  t.m_radvd.resize (n);
+  t.m_haFlag.resize (n);
+  t.m_zebraRouterId.resize (n, 0);
+  t.m_ospfRouterId.resize (n);
+  t.m_ospfNetworks.resize (n);
+  t.m_ospfAreaRange.resize (n, std::make_pair (-1, std::string ()));
+  OspfInterfaceConfig interface = { 0, "", 0, 0, 0, 0, OSPF_NETWORK_AUTO, false, 0, 0 };
+  t.m_ospfNodeInterface.resize (n, interface);
+  t.m_ospfInterfaces.resize (n);
+  OspfRouterTimers timers = { -1, -1, -1, -1, -1 };
+  t.m_ospfTimers.resize (n, timers);
+  t.m_ospfCostUnit.resize (n, 0);
+  t.m_asn.resize (n, 0);
+  t.m_bgpNeighbors.resize (n);
+  t.m_bgpPeerLinks.resize (n);
+  t.m_bgpNetworks.resize (n);
+  t.m_bgpAdvertisementInterval.resize (n, m_bgpAdvertisementInterval);
+  t.m_ospf6Interfaces.resize (n);
+  t.m_ospf6RouterId.resize (n, 0);
+  t.m_ospf6RetransmitInterval.resize (n, m_ospf6RetransmitInterval);
+  t.m_ripNetworks.resize (n);
+  t.m_ripngNetworks.resize (n);
+  return id;
+}
 
-      ospf_conf->addNetwork (std::string (network), 0);
+bool
+QuaggaHelper::IsEnabled (uint32_t id, Daemon daemon) const
+{
+  return id < m_configs.m_enabled.size () && (m_configs.m_enabled[id] & (1 << daemon));
+}
+
+void
+QuaggaHelper::Enable (uint32_t id, Daemon daemon)
+{
+  if (!IsEnabled (id, daemon))
+    {
+      m_configs.m_enabled[id] |= 1 << daemon;
+      SetDirty (id, daemon);
+    }
+}
+
+void
+QuaggaHelper::SetDirty (uint32_t id, Daemon daemon)
+{
+  m_configs.m_dirty[id] |= 1 << daemon;
+}
+
+void
+QuaggaHelper::SetDebug (uint32_t id, Daemon daemon, bool debug)
+{
+  if (debug != static_cast<bool> (m_configs.m_debug[id] & (1 << daemon)))
+    {
+      m_configs.m_debug[id] ^= 1 << daemon;
+      SetDirty (id, daemon);
     }
+}
+
+// OSPF
+void
+QuaggaHelper::EnableOspf (NodeContainer nodes, const char *network)
+{
+  EnableOspfArea (nodes, network, 0);
   return;
 }
 
@@ -677,13 +433,11 @@ QuaggaHelper::EnableOspfArea (NodeContainer nodes, const char *network, int area
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<OspfConfig> ospf_conf = nodes.Get (i)->GetObject<OspfConfig> ();
-      if (!ospf_conf)
-        {
-          ospf_conf = new OspfConfig ();
-          nodes.Get (i)->AggregateObject (ospf_conf);
-        }
-      ospf_conf->addNetwork (std::string (network), area);
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      Enable (id, OSPFD);
+      InsertSorted (m_configs.m_ospfNetworks[id], std::string (network),
+                    static_cast<uint32_t> (area));
+      SetDirty (id, OSPFD);
     }
   return;
 }
@@ -693,13 +447,10 @@ QuaggaHelper::SetArea (NodeContainer nodes, const char *network, int area)
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<OspfConfig> ospf_conf = nodes.Get (i)->GetObject<OspfConfig> ();
-      if (!ospf_conf)
-        {
-          ospf_conf = new OspfConfig ();
-          nodes.Get (i)->AggregateObject (ospf_conf);
-        }
-      ospf_conf->setArea (std::string (network), area);
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      Enable (id, OSPFD);
+      m_configs.m_ospfAreaRange[id] = std::make_pair (area, std::string (network));
+      SetDirty (id, OSPFD);
     }
   return;
 }
@@ -707,78 +458,230 @@ QuaggaHelper::SetArea (NodeContainer nodes, const char *network, int area)
 void
 QuaggaHelper::SetOspfRouterId (Ptr<Node> node, const char * routerid)
 {
-  Ptr<OspfConfig> ospf_conf = node->GetObject<OspfConfig> ();
-  if (!ospf_conf)
+  uint32_t id = GetConfigEntry (node);
+  Enable (id, OSPFD);
+  m_configs.m_ospfRouterId[id] = std::string (routerid);
+  // it can be in either file, see GenerateConfigOspf
+  SetDirty (id, OSPFD);
+  SetDirty (id, ZEBRA);
+  return;
+}
+
+QuaggaHelper::OspfInterfaceConfig &
+QuaggaHelper::GetOspfInterface (Ptr<NetDevice> device)
+{
+  uint32_t id = GetConfigEntry (device->GetNode ());
+  std::vector<OspfInterfaceConfig> &interfaces = m_configs.m_ospfInterfaces[id];
+  for (std::vector<OspfInterfaceConfig>::iterator i = interfaces.begin ();
+       i != interfaces.end (); ++i)
+    {
+      if (i->m_device == device->GetIfIndex ())
+        {
+          return *i;
+        }
+    }
+  OspfInterfaceConfig interface = { device->GetIfIndex (), "", 0, 0, 0, 0, OSPF_NETWORK_AUTO, false, 0, 0 };
+  interfaces.push_back (interface);
+  return interfaces.back ();
+}
+
+void
+QuaggaHelper::SetOspfTimers (NodeContainer nodes, uint32_t hello, uint32_t dead, uint32_t retransmit)
+{
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      ospf_conf = new OspfConfig ();
-      node->AggregateObject (ospf_conf);
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      m_configs.m_ospfNodeInterface[id].m_hello = hello;
+      m_configs.m_ospfNodeInterface[id].m_dead = dead;
+      m_configs.m_ospfNodeInterface[id].m_retransmit = retransmit;
+      SetDirty (id, OSPFD);
     }
-  ospf_conf->SetRouterId (routerid);
-  return;
 }
 
+void
+QuaggaHelper::SetOspfTimers (NetDeviceContainer devices, uint32_t hello, uint32_t dead, uint32_t retransmit)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      OspfInterfaceConfig &interface = GetOspfInterface (devices.Get (i));
+      interface.m_hello = hello;
+      interface.m_dead = dead;
+      interface.m_retransmit = retransmit;
+      SetDirty (devices.Get (i)->GetNode ()->GetId (), OSPFD);
+    }
+}
 
 void
-QuaggaHelper::EnableOspfDebug (NodeContainer nodes)
+QuaggaHelper::SetOspfFastHello (NodeContainer nodes, uint32_t multiplier)
 {
+  NS_ABORT_MSG_IF (multiplier > 10, "OSPF hello multiplier " << multiplier << " is not in 1-10");
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<OspfConfig> ospf_conf = nodes.Get (i)->GetObject<OspfConfig> ();
-      if (!ospf_conf)
-        {
-          ospf_conf = new OspfConfig ();
-          nodes.Get (i)->AggregateObject (ospf_conf);
-        }
-      ospf_conf->m_ospfdebug = true;
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      m_configs.m_ospfNodeInterface[id].m_helloMultiplier = multiplier;
+      SetDirty (id, OSPFD);
     }
-  return;
 }
 
+void
+QuaggaHelper::SetOspfFastHello (NetDeviceContainer devices, uint32_t multiplier)
+{
+  NS_ABORT_MSG_IF (multiplier > 10, "OSPF hello multiplier " << multiplier << " is not in 1-10");
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      GetOspfInterface (devices.Get (i)).m_helloMultiplier = multiplier;
+      SetDirty (devices.Get (i)->GetNode ()->GetId (), OSPFD);
+    }
+}
 
 void
-QuaggaHelper::EnableZebraDebug (NodeContainer nodes)
+QuaggaHelper::SetOspfPointToPoint (NetDeviceContainer devices, bool pointToPoint)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      GetOspfInterface (devices.Get (i)).m_network =
+        pointToPoint ? OSPF_NETWORK_POINT_TO_POINT : OSPF_NETWORK_BROADCAST;
+      SetDirty (devices.Get (i)->GetNode ()->GetId (), OSPFD);
+    }
+}
+
+void
+QuaggaHelper::SetOspfCost (NetDeviceContainer devices, uint32_t cost)
+{
+  NS_ABORT_MSG_IF (cost > 65535, "OSPF cost " << cost << " is not in 1-65535");
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      GetOspfInterface (devices.Get (i)).m_cost = cost;
+      SetDirty (devices.Get (i)->GetNode ()->GetId (), OSPFD);
+    }
+}
+
+void
+QuaggaHelper::SetOspfCostFromDelay (NodeContainer nodes, Time unit)
+{
+  NS_ABORT_MSG_IF (unit.IsStrictlyNegative (), "negative OSPF cost unit");
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      m_configs.m_ospfCostUnit[id] = unit.GetNanoSeconds ();
+      SetDirty (id, OSPFD);
+    }
+}
+
+Ptr<OspfCostUpdater>
+QuaggaHelper::EnableOspfCostUpdates (NodeContainer nodes, Time unit, Time interval)
 {
+  Ptr<OspfCostUpdater> updater = CreateObject<OspfCostUpdater> ();
+  updater->SetAttribute ("Unit", TimeValue (unit));
+  updater->SetAttribute ("Interval", TimeValue (interval));
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<QuaggaConfig> zebra_conf = nodes.Get (i)->GetObject<QuaggaConfig> ();
-      if (!zebra_conf)
+      Ptr<Node> node = nodes.Get (i);
+      uint32_t id = node->GetId ();
+      for (uint32_t d = 0; d < node->GetNDevices (); d++)
         {
-          zebra_conf = new QuaggaConfig ();
-          nodes.Get (i)->AggregateObject (zebra_conf);
+          Ptr<NetDevice> device = node->GetDevice (d);
+          if (DynamicCast<LoopbackNetDevice> (device))
+            {
+              continue;
+            }
+          // start from the delay cost in ospfd.conf; explicit costs stay
+          uint32_t cost = 0;
+          bool fixed = false;
+          if (id < m_configs.m_ospfInterfaces.size ())
+            {
+              const std::vector<OspfInterfaceConfig> &interfaces = m_configs.m_ospfInterfaces[id];
+              for (std::vector<OspfInterfaceConfig>::const_iterator j = interfaces.begin ();
+                   j != interfaces.end (); ++j)
+                {
+                  if (j->m_device == d)
+                    {
+                      fixed = j->m_cost != 0;
+                      cost = j->m_delayCost;
+                      break;
+                    }
+                }
+            }
+          if (!fixed)
+            {
+              updater->Add (device, cost);
+            }
         }
-      zebra_conf->m_zebradebug = true;
     }
-  return;
+  return updater;
 }
 
 void
-QuaggaHelper::EnableRadvd (Ptr<Node> node, const char *ifname, const char *prefix)
+QuaggaHelper::SetOspfSpfThrottle (NodeContainer nodes, uint32_t delay, uint32_t initialHold, uint32_t maxHold)
+{
+  NS_ABORT_MSG_IF (delay > 600000 || initialHold > 600000 || maxHold > 600000,
+                   "OSPF SPF throttle timers are at most 600000 ms");
+  NS_ABORT_MSG_IF (maxHold < initialHold, "OSPF SPF max hold below the initial hold");
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      m_configs.m_ospfTimers[id].m_spfDelay = delay;
+      m_configs.m_ospfTimers[id].m_spfInitialHold = initialHold;
+      m_configs.m_ospfTimers[id].m_spfMaxHold = maxHold;
+      SetDirty (id, OSPFD);
+    }
+}
+
+void
+QuaggaHelper::SetOspfLsaPacing (NodeContainer nodes, uint32_t minInterval, uint32_t minArrival)
 {
-  Ptr<QuaggaConfig> zebra_conf = node->GetObject<QuaggaConfig> ();
-  if (!zebra_conf)
+  NS_ABORT_MSG_IF (minInterval > 5000, "OSPF LSA interval is at most 5000 ms");
+  NS_ABORT_MSG_IF (minArrival > 1000, "OSPF LSA arrival is at most 1000 ms");
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      zebra_conf = new QuaggaConfig ();
-      node->AggregateObject (zebra_conf);
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      m_configs.m_ospfTimers[id].m_lsaInterval = minInterval;
+      m_configs.m_ospfTimers[id].m_lsaArrival = minArrival;
+      SetDirty (id, OSPFD);
     }
+}
 
-  zebra_conf->m_radvd_if->insert (
-    std::map<std::string, std::string>::value_type (std::string (ifname), std::string (prefix)));
 
+void
+QuaggaHelper::EnableOspfDebug (NodeContainer nodes)
+{
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      Enable (id, OSPFD);
+      SetDebug (id, OSPFD, true);
+    }
   return;
 }
 
 
 void
-QuaggaHelper::EnableHomeAgentFlag (Ptr<Node> node, const char *ifname)
+QuaggaHelper::EnableZebraDebug (NodeContainer nodes)
 {
-  Ptr<QuaggaConfig> zebra_conf = node->GetObject<QuaggaConfig> ();
-  if (!zebra_conf)
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      zebra_conf = new QuaggaConfig ();
-      node->AggregateObject (zebra_conf);
+      SetDebug (GetConfigEntry (nodes.Get (i)), ZEBRA, true);
     }
+  return;
+}
+
+void
+QuaggaHelper::EnableRadvd (Ptr<Node> node, const char *ifname, const char *prefix)
+{
+  uint32_t id = GetConfigEntry (node);
+  InsertSorted (m_configs.m_radvd[id], std::string (ifname), std::string (prefix));
+  SetDirty (id, ZEBRA);
+
+  return;
+}
 
-  zebra_conf->m_haflag_if->push_back (std::string (ifname));
+
+void
+QuaggaHelper::EnableHomeAgentFlag (Ptr<Node> node, const char *ifname)
+{
+  uint32_t id = GetConfigEntry (node);
+  m_configs.m_haFlag[id].push_back (std::string (ifname));
+  SetDirty (id, ZEBRA);
 
   return;
 }
@@ -788,13 +691,9 @@ QuaggaHelper::UseManualZebraConfig (NodeContainer nodes)
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<QuaggaConfig> zebra_conf = nodes.Get (i)->GetObject<QuaggaConfig> ();
-      if (!zebra_conf)
-        {
-          zebra_conf = new QuaggaConfig ();
-          nodes.Get (i)->AggregateObject (zebra_conf);
-        }
-      zebra_conf->m_usemanualconf = true;
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      m_configs.m_manualZebra[id] = true;
+      SetDirty (id, ZEBRA);
     }
   return;
 }
@@ -806,12 +705,11 @@ QuaggaHelper::EnableBgp (NodeContainer nodes)
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<BgpConfig> bgp_conf = nodes.Get (i)->GetObject<BgpConfig> ();
-      if (!bgp_conf)
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      if (!IsEnabled (id, BGPD))
         {
-          bgp_conf = CreateObject<BgpConfig> ();
-          bgp_conf->SetAsn (nodes.Get (i)->GetId ());
-          nodes.Get (i)->AggregateObject (bgp_conf);
+          Enable (id, BGPD);
+          m_configs.m_asn[id] = id + 1;
         }
     }
 
@@ -821,39 +719,39 @@ QuaggaHelper::EnableBgp (NodeContainer nodes)
 uint32_t
 QuaggaHelper::GetAsn (Ptr<Node> node)
 {
-  Ptr<BgpConfig> bgp_conf = node->GetObject<BgpConfig> ();
-  if (!bgp_conf)
+  if (!IsEnabled (node->GetId (), BGPD))
     {
       return 0;
     }
-  return bgp_conf->GetAsn ();
+  return m_configs.m_asn[node->GetId ()];
 }
 
 void
 QuaggaHelper::BgpAddNeighbor (Ptr<Node> node, std::string neighbor, uint32_t asn)
 {
-  Ptr<BgpConfig> bgp_conf = node->GetObject<BgpConfig> ();
-  if (!bgp_conf)
+  EnableBgp (NodeContainer (node));
+  std::vector<std::pair<std::string, uint32_t> > &neighbors = m_configs.m_bgpNeighbors[node->GetId ()];
+  // a neighbor added again keeps its first ASN
+  for (std::vector<std::pair<std::string, uint32_t> >::const_iterator i = neighbors.begin ();
+       i != neighbors.end (); ++i)
     {
-      bgp_conf = CreateObject<BgpConfig> ();
-      bgp_conf->SetAsn (node->GetId ());
-      node->AggregateObject (bgp_conf);
+      if (i->first == neighbor)
+        {
+          asn = i->second;
+          break;
+        }
     }
-  bgp_conf->AddNeighbor (neighbor, asn);
+  neighbors.push_back (std::make_pair (neighbor, asn));
+  SetDirty (node->GetId (), BGPD);
   return;
 }
 
 void
 QuaggaHelper::BgpAddPeerLink (Ptr<Node> node, std::string neighbor)
 {
-  Ptr<BgpConfig> bgp_conf = node->GetObject<BgpConfig> ();
-  if (!bgp_conf)
-    {
-      bgp_conf = CreateObject<BgpConfig> ();
-      bgp_conf->SetAsn (node->GetId ());
-      node->AggregateObject (bgp_conf);
-    }
-  bgp_conf->AddPeerLink (neighbor);
+  EnableBgp (NodeContainer (node));
+  m_configs.m_bgpPeerLinks[node->GetId ()].push_back (neighbor);
+  SetDirty (node->GetId (), BGPD);
   return;
 }
 
@@ -863,15 +761,11 @@ QuaggaHelper::EnableOspf6 (NodeContainer nodes, const char *ifname)
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<Ospf6Config> ospf6_conf = nodes.Get (i)->GetObject<Ospf6Config> ();
-      if (!ospf6_conf)
-        {
-          ospf6_conf = new Ospf6Config ();
-          nodes.Get (i)->AggregateObject (ospf6_conf);
-        }
-
-      ospf6_conf->m_enable_if->push_back (std::string (ifname));
-      ospf6_conf->m_router_id = i;
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      Enable (id, OSPF6D);
+      m_configs.m_ospf6Interfaces[id].push_back (std::string (ifname));
+      m_configs.m_ospf6RouterId[id] = i;
+      SetDirty (id, OSPF6D);
     }
 
   return;
@@ -882,13 +776,9 @@ QuaggaHelper::EnableOspf6Debug (NodeContainer nodes)
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<Ospf6Config> ospf6_conf = nodes.Get (i)->GetObject<Ospf6Config> ();
-      if (!ospf6_conf)
-        {
-          ospf6_conf = new Ospf6Config ();
-          nodes.Get (i)->AggregateObject (ospf6_conf);
-        }
-      ospf6_conf->m_ospf6debug = true;
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      Enable (id, OSPF6D);
+      SetDebug (id, OSPF6D, true);
     }
   return;
 }
@@ -899,14 +789,10 @@ QuaggaHelper::EnableRip (NodeContainer nodes, const char *ifname)
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<RipConfig> rip_conf = nodes.Get (i)->GetObject<RipConfig> ();
-      if (!rip_conf)
-        {
-          rip_conf = new RipConfig ();
-          nodes.Get (i)->AggregateObject (rip_conf);
-        }
-
-      rip_conf->m_enable_if->push_back (std::string (ifname));
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      Enable (id, RIPD);
+      m_configs.m_ripNetworks[id].push_back (std::string (ifname));
+      SetDirty (id, RIPD);
     }
 
   return;
@@ -917,13 +803,9 @@ QuaggaHelper::EnableRipDebug (NodeContainer nodes)
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<RipConfig> rip_conf = nodes.Get (i)->GetObject<RipConfig> ();
-      if (!rip_conf)
-        {
-          rip_conf = new RipConfig ();
-          nodes.Get (i)->AggregateObject (rip_conf);
-        }
-      rip_conf->m_ripdebug = true;
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      Enable (id, RIPD);
+      SetDebug (id, RIPD, true);
     }
   return;
 }
@@ -934,14 +816,10 @@ QuaggaHelper::EnableRipng (NodeContainer nodes, const char *ifname)
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<RipngConfig> ripng_conf = nodes.Get (i)->GetObject<RipngConfig> ();
-      if (!ripng_conf)
-        {
-          ripng_conf = new RipngConfig ();
-          nodes.Get (i)->AggregateObject (ripng_conf);
-        }
-
-      ripng_conf->m_enable_if->push_back (std::string (ifname));
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      Enable (id, RIPNGD);
+      m_configs.m_ripngNetworks[id].push_back (std::string (ifname));
+      SetDirty (id, RIPNGD);
     }
 
   return;
@@ -952,333 +830,1115 @@ QuaggaHelper::EnableRipngDebug (NodeContainer nodes)
 {
   for (uint32_t i = 0; i < nodes.GetN (); i++)
     {
-      Ptr<RipngConfig> ripng_conf = nodes.Get (i)->GetObject<RipngConfig> ();
-      if (!ripng_conf)
-        {
-          ripng_conf = new RipngConfig ();
-          nodes.Get (i)->AggregateObject (ripng_conf);
-        }
-      ripng_conf->m_ripngdebug = true;
+      uint32_t id = GetConfigEntry (nodes.Get (i));
+      Enable (id, RIPNGD);
+      SetDebug (id, RIPNGD, true);
     }
   return;
 }
 
+// Renderers, run from the config threads: they only read the table
+
 void
-QuaggaHelper::GenerateConfigZebra (Ptr<Node> node)
+QuaggaHelper::PrintZebraConfig (const ConfigTable &t, uint32_t id, std::ostream &os)
 {
-  Ptr<QuaggaConfig> zebra_conf = node->GetObject<QuaggaConfig> ();
-
-  // config generation
-  std::stringstream conf_dir, conf_file;
-  // FIXME XXX
-  conf_dir << "files-" << node->GetId () << "";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/usr/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/local/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/etc/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-
-  conf_file << conf_dir.str () << "/zebra.conf";
-  zebra_conf->SetFilename ("/usr/local/etc/zebra.conf");
-
-  if (zebra_conf->m_usemanualconf)
+  os << "hostname zebra" << std::endl
+     << "password zebra" << std::endl
+     << "log stdout" << std::endl;
+  if (t.m_zebraRouterId[id])
     {
-      return;
+      os << "router-id " << t.m_ospfRouterId[id] << std::endl;
     }
-
-  std::ofstream conf;
-  conf.open (conf_file.str ().c_str ());
-  conf << *zebra_conf;
-  if (zebra_conf->m_zebradebug)
+  if (t.m_debug[id] & (1 << ZEBRA))
     {
-      conf << "debug zebra kernel" << std::endl;
-      conf << "debug zebra events" << std::endl;
-      conf << "debug zebra packet" << std::endl;
-      //      conf << "debug zebra route" << std::endl;
+      os << "debug zebra kernel" << std::endl;
+      os << "debug zebra events" << std::endl;
+      os << "debug zebra packet" << std::endl;
+      //      os << "debug zebra route" << std::endl;
     }
 
   // radvd
-  for (std::map<std::string, std::string>::iterator i = zebra_conf->m_radvd_if->begin ();
-       i != zebra_conf->m_radvd_if->end (); ++i)
+  for (std::vector<std::pair<std::string, std::string> >::const_iterator i = t.m_radvd[id].begin ();
+       i != t.m_radvd[id].end (); ++i)
     {
-      conf << "interface " << (*i).first << std::endl;
-      conf << " ipv6 nd ra-interval 5" << std::endl;
+      os << "interface " << (*i).first << std::endl;
+      os << " ipv6 nd ra-interval 5" << std::endl;
       if ((*i).second.length () != 0)
         {
-          conf << " ipv6 nd prefix " << (*i).second << " 300 150" << std::endl;
+          os << " ipv6 nd prefix " << (*i).second << " 300 150" << std::endl;
         }
-      conf << " no ipv6 nd suppress-ra" << std::endl;
-      conf << "!" << std::endl;
+      os << " no ipv6 nd suppress-ra" << std::endl;
+      os << "!" << std::endl;
     }
 
   // ha flag
-  for (std::vector<std::string>::iterator i = zebra_conf->m_haflag_if->begin ();
-       i != zebra_conf->m_haflag_if->end (); ++i)
+  for (std::vector<std::string>::const_iterator i = t.m_haFlag[id].begin ();
+       i != t.m_haFlag[id].end (); ++i)
     {
-      conf << "interface " << (*i) << std::endl;
-      conf << " ipv6 nd home-agent-config-flag" << std::endl;
-      conf << "!" << std::endl;
+      os << "interface " << (*i) << std::endl;
+      os << " ipv6 nd home-agent-config-flag" << std::endl;
+      os << "!" << std::endl;
     }
-
-  conf.close ();
 }
 
 void
-QuaggaHelper::GenerateConfigOspf (Ptr<Node> node)
+QuaggaHelper::PrintOspfConfig (const ConfigTable &t, uint32_t id, std::ostream &os)
 {
-  NS_LOG_FUNCTION (node);
+  os << "hostname zebra" << std::endl
+     << "password zebra" << std::endl
+     << "log stdout" << std::endl;
+  if (t.m_debug[id] & (1 << OSPFD))
+    {
+      //os << "log trap errors" << std::endl;
+      os << "debug ospf event " << std::endl;
+      os << "debug ospf nsm " << std::endl;
+      os << "debug ospf ism " << std::endl;
+      os << "debug ospf packet all " << std::endl;
+    }
 
-  Ptr<OspfConfig> ospf_conf = node->GetObject<OspfConfig> ();
-  ospf_conf->m_routerId = 1 + node->GetId ();
-
-  // config generation
-  std::stringstream conf_dir, conf_file;
-  // FIXME XXX
-  conf_dir << "files-" << node->GetId () << "";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/usr/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/local/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/etc/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-
-  conf_file << conf_dir.str () << "/ospfd.conf";
-  ospf_conf->SetFilename ("/usr/local/etc/ospfd.conf");
-
-  std::ofstream conf;
-  conf.open (conf_file.str ().c_str ());
-  ospf_conf->Print (conf);
-  conf.close ();
+  // interface settings, falling back to those of the node
+  const OspfInterfaceConfig &node = t.m_ospfNodeInterface[id];
+  for (std::vector<OspfInterfaceConfig>::const_iterator i = t.m_ospfInterfaces[id].begin ();
+       i != t.m_ospfInterfaces[id].end (); ++i)
+    {
+      if (i->m_name == "")
+        {
+          continue;
+        }
+      uint32_t multiplier = i->m_helloMultiplier ? i->m_helloMultiplier : node.m_helloMultiplier;
+      uint32_t hello = i->m_hello ? i->m_hello : node.m_hello;
+      uint32_t dead = i->m_dead ? i->m_dead : node.m_dead;
+      uint32_t retransmit = i->m_retransmit ? i->m_retransmit : node.m_retransmit;
+      uint8_t network = i->m_network;
+      if (network == OSPF_NETWORK_AUTO && i->m_pointToPointDevice)
+        {
+          network = OSPF_NETWORK_POINT_TO_POINT;
+        }
+      uint32_t cost = i->m_cost ? i->m_cost : i->m_delayCost;
+      if (!multiplier && !hello && !dead && !retransmit && !cost
+          && network == OSPF_NETWORK_AUTO)
+        {
+          continue;
+        }
+      os << "interface " << i->m_name << std::endl;
+      if (network == OSPF_NETWORK_POINT_TO_POINT)
+        {
+          os << " ip ospf network point-to-point" << std::endl;
+        }
+      else if (network == OSPF_NETWORK_BROADCAST)
+        {
+          os << " ip ospf network broadcast" << std::endl;
+        }
+      if (multiplier)
+        {
+          os << " ip ospf dead-interval minimal hello-multiplier " << multiplier << std::endl;
+        }
+      else
+        {
+          if (hello)
+            {
+              os << " ip ospf hello-interval " << hello << std::endl;
+            }
+          if (dead)
+            {
+              os << " ip ospf dead-interval " << dead << std::endl;
+            }
+        }
+      if (retransmit)
+        {
+          os << " ip ospf retransmit-interval " << retransmit << std::endl;
+        }
+      if (cost)
+        {
+          os << " ip ospf cost " << cost << std::endl;
+        }
+      os << "!" << std::endl;
+    }
 
+  os << "router ospf " << std::endl;
+  const OspfRouterTimers &timers = t.m_ospfTimers[id];
+  if (timers.m_spfDelay >= 0)
+    {
+      os << " timers throttle spf " << timers.m_spfDelay << " " << timers.m_spfInitialHold
+         << " " << timers.m_spfMaxHold << std::endl;
+    }
+  if (timers.m_lsaInterval >= 0)
+    {
+      os << " timers throttle lsa all " << timers.m_lsaInterval << std::endl;
+      os << " timers lsa arrival " << timers.m_lsaArrival << std::endl;
+    }
+  for (std::vector<std::pair<std::string, uint32_t> >::const_iterator i = t.m_ospfNetworks[id].begin ();
+       i != t.m_ospfNetworks[id].end (); ++i)
+    {
+      os << "  network " << (*i).first << " area " << (*i).second << std::endl;
+    }
+  if (t.m_ospfAreaRange[id].first != -1)
+    {
+      os << "  area " << t.m_ospfAreaRange[id].first << " range " << t.m_ospfAreaRange[id].second << std::endl;
+    }
+  os << " redistribute connected" << std::endl;
+  if (t.m_ospfRouterId[id] != "" && !t.m_zebraRouterId[id])
+    {
+      os << " ospf router-id " << t.m_ospfRouterId[id] << std::endl;
+    }
+  os << "!" << std::endl;
 }
 
 void
-QuaggaHelper::GenerateConfigBgp (Ptr<Node> node)
-{
-  Ptr<BgpConfig> bgp_conf = node->GetObject<BgpConfig> ();
-
-  // config generation
-  std::stringstream conf_dir, conf_file;
-  // FIXME XXX
-  conf_dir << "files-" << node->GetId () << "";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/usr/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/local/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/etc/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-
-  conf_file << conf_dir.str () << "/bgpd.conf";
-  bgp_conf->SetFilename ("/usr/local/etc/bgpd.conf");
-
-  std::ofstream conf;
-  conf.open (conf_file.str ().c_str ());
-  bgp_conf->Print (conf);
-  conf.close ();
+QuaggaHelper::PrintBgpConfig (const ConfigTable &t, uint32_t id, std::ostream &os)
+{
+  std::stringstream router_id;
+  router_id << "192.168.0." << t.m_asn[id];
+  const std::vector<std::pair<std::string, uint32_t> > &neighbors = t.m_bgpNeighbors[id];
+  const std::vector<std::string> &peer_links = t.m_bgpPeerLinks[id];
+  const std::vector<std::string> &networks = t.m_bgpNetworks[id];
+
+  os << "hostname bgpd" << std::endl
+     << "password zebra" << std::endl
+     << "log stdout" << std::endl
+     << "debug bgp" << std::endl
+     << "debug bgp fsm" << std::endl
+     << "debug bgp events" << std::endl
+     << "debug bgp updates" << std::endl
+     << "router bgp " << t.m_asn[id] << std::endl
+     << "  bgp router-id " << router_id.str () << std::endl;
+  for (std::vector<std::pair<std::string, uint32_t> >::const_iterator it = neighbors.begin (); it != neighbors.end (); it++)
+    {
+      os << "  neighbor " << it->first << " remote-as " << it->second << std::endl;
+      os << "  neighbor " << it->first << " advertisement-interval "
+         << t.m_bgpAdvertisementInterval[id] << std::endl;
+    }
+  os << "  redistribute connected" << std::endl;
+  // IPv4
+  os << "  address-family ipv4 unicast" << std::endl;
+  for (std::vector<std::pair<std::string, uint32_t> >::const_iterator it = neighbors.begin (); it != neighbors.end (); it++)
+    {
+      struct in_addr addr;
+      int ret = ::inet_pton (AF_INET, it->first.c_str (), &addr);
+      if (!ret)
+        {
+          continue;
+        }
+      os << "   neighbor " << it->first << " activate" << std::endl;
+      os << "   neighbor " << it->first << " next-hop-self" << std::endl;
 
+      // route-map for peer-neighbor
+      for (std::vector<std::string>::const_iterator it2 = peer_links.begin (); it2 != peer_links.end (); it2++)
+        {
+          if (it->first == *it2)
+            {
+              os << "   neighbor " << it->first << " route-map MAP-" << router_id.str () << "-"
+                 << it->first << " out" << std::endl;
+            }
+        }
+
+    }
+  for (std::vector<std::string>::const_iterator it = networks.begin (); it != networks.end (); it++)
+    {
+      os << "   network " << *it << std::endl;
+    }
+  os << "  exit-address-family" << std::endl;
+
+  // IPv6
+  os << "  address-family ipv6 unicast" << std::endl;
+  for (std::vector<std::pair<std::string, uint32_t> >::const_iterator it = neighbors.begin (); it != neighbors.end (); it++)
+    {
+      struct in6_addr addr;
+      int ret = ::inet_pton (AF_INET6, it->first.c_str (), &addr);
+      if (!ret)
+        {
+          continue;
+        }
+      os << "   neighbor " << it->first << " activate" << std::endl;
+      os << "   neighbor " << it->first << " next-hop-self" << std::endl;
+    }
+  for (std::vector<std::string>::const_iterator it = networks.begin (); it != networks.end (); it++)
+    {
+      os << "   network " << *it << std::endl;
+    }
+  os << "   redistribute connected" << std::endl;
+  os << "  exit-address-family" << std::endl;
+
+  // access-list and route-map for peer-link filter-out
+  for (std::vector<std::string>::const_iterator it = networks.begin (); it != networks.end (); it++)
+    {
+      os << "access-list ALIST-" << router_id.str () << " permit " << *it << std::endl;
+    }
+  for (std::vector<std::string>::const_iterator it = peer_links.begin (); it != peer_links.end (); it++)
+    {
+      os << "route-map MAP-" << router_id.str () << "-" << *it << " permit 5" << std::endl;
+      os << " match ip address ALIST-" << router_id.str () << std::endl;
+      os << "!" << std::endl;
+    }
+
+  os << "!" << std::endl;
 }
 
 void
-QuaggaHelper::GenerateConfigOspf6 (Ptr<Node> node)
-{
-  Ptr<Ospf6Config> ospf6_conf = node->GetObject<Ospf6Config> ();
-
-  // config generation
-  std::stringstream conf_dir, conf_file;
-  // FIXME XXX
-  conf_dir << "files-" << node->GetId () << "";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/usr/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/local/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/etc/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-
-  conf_file << conf_dir.str () << "/ospf6d.conf";
-  ospf6_conf->SetFilename ("/usr/local/etc/ospf6d.conf");
-  std::ofstream conf;
-  conf.open (conf_file.str ().c_str ());
-  ospf6_conf->Print (conf);
-  conf.close ();
+QuaggaHelper::PrintOspf6Config (const ConfigTable &t, uint32_t id, std::ostream &os)
+{
+  const std::vector<std::string> &interfaces = t.m_ospf6Interfaces[id];
+  os << "hostname ospf6d" << std::endl
+     << "password zebra" << std::endl
+     << "log stdout" << std::endl
+     << "service advanced-vty" << std::endl;
+
+
+  if (t.m_debug[id] & (1 << OSPF6D))
+    {
+      os << "debug ospf6 neighbor " << std::endl;
+      os << "debug ospf6 message all " << std::endl;
+      os << "debug ospf6 zebra " << std::endl;
+      os << "debug ospf6 interface " << std::endl;
+    }
+
+  for (std::vector<std::string>::const_iterator i = interfaces.begin ();
+       i != interfaces.end (); ++i)
+    {
+      os << "interface " << (*i) << std::endl;
+      os << " ipv6 ospf6 retransmit-interval " << t.m_ospf6RetransmitInterval[id] << std::endl;
+      os << "!" << std::endl;
+    }
+
+  for (std::vector<std::string>::const_iterator i = interfaces.begin ();
+       i != interfaces.end (); ++i)
+    {
+      if (i == interfaces.begin ())
+        {
+          os << "router ospf6" << std::endl;
+        }
+
+      os << " router-id 255.1.1." << (t.m_ospf6RouterId[id] % 255) << std::endl;
+      os << " interface " << (*i) << " area 0.0.0.0" << std::endl;
+      os << " redistribute connected" << std::endl;
+
+      if (i == interfaces.begin ())
+        {
+          os << "!" << std::endl;
+        }
+    }
+}
+
+// ripd and ripngd configs only differ by the daemon name
+static void
+PrintRipFamilyConfig (const std::string &daemon, const std::vector<std::string> &networks,
+                      bool debug, std::ostream &os)
+{
+  os << "hostname " << daemon << "d" << std::endl
+     << "password zebra" << std::endl
+     << "log stdout" << std::endl
+     << "service advanced-vty" << std::endl;
+
+  if (debug)
+    {
+      os << "debug " << daemon << " events " << std::endl;
+      os << "debug " << daemon << " packet send detail " << std::endl;
+      os << "debug " << daemon << " packet recv detail " << std::endl;
+      os << "debug " << daemon << " zebra " << std::endl;
+    }
+
+  for (std::vector<std::string>::const_iterator i = networks.begin ();
+       i != networks.end (); ++i)
+    {
+      if (i == networks.begin ())
+        {
+          os << "router " << daemon << std::endl;
+        }
+
+      os << " network " << (*i) << std::endl;
+      os << " redistribute connected" << std::endl;
+
+      if (i == networks.begin ())
+        {
+          os << "!" << std::endl;
+        }
+    }
+}
+
+void
+QuaggaHelper::PrintRipConfig (const ConfigTable &t, uint32_t id, std::ostream &os)
+{
+  PrintRipFamilyConfig ("rip", t.m_ripNetworks[id], t.m_debug[id] & (1 << RIPD), os);
+}
+
+void
+QuaggaHelper::PrintRipngConfig (const ConfigTable &t, uint32_t id, std::ostream &os)
+{
+  PrintRipFamilyConfig ("ripng", t.m_ripngNetworks[id], t.m_debug[id] & (1 << RIPNGD), os);
+}
+
+void
+QuaggaHelper::AddConfigFile (Ptr<Node> node, uint32_t slot, Daemon daemon, PrintConfigFn print,
+                             std::vector<ConfigFile> &files)
+{
+  uint32_t id = node->GetId ();
+  NS_ABORT_MSG_IF (m_configs.m_released[id] & (1 << daemon),
+                   g_daemonNames[daemon] << " config of node " << id
+                   << " changed after it was released (ReleaseConfigs)");
+  m_configs.m_dirty[id] &= ~(1 << daemon);
+
+  ConfigFile file;
+  file.m_nodeId = id;
+  file.m_slot = slot;
+  file.m_name = std::string (g_daemonNames[daemon]) + ".conf";
+  // the files-N/usr/local/etc tree is created once per node
+  file.m_mkdir = m_confDirs.insert (id).second;
+  file.m_print = print;
+  file.m_hash = 0;
+  file.m_action = WRITE;
+  files.push_back (file);
 }
 
 void
-QuaggaHelper::GenerateConfigRip (Ptr<Node> node)
+QuaggaHelper::GenerateConfigZebra (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files)
+{
+  uint32_t id = node->GetId ();
+  if (m_zebraDebug)
+    {
+      SetDebug (id, ZEBRA, true);
+    }
+
+  if (m_configs.m_manualZebra[id] || !(m_configs.m_dirty[id] & (1 << ZEBRA)))
+    {
+      return;
+    }
+  AddConfigFile (node, slot, ZEBRA, &QuaggaHelper::PrintZebraConfig, files);
+}
+
+void
+QuaggaHelper::GenerateConfigOspf (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files)
 {
   NS_LOG_FUNCTION (node);
 
-  Ptr<RipConfig> rip_conf = node->GetObject<RipConfig> ();
-
-  // config generation
-  std::stringstream conf_dir, conf_file;
-  // FIXME XXX
-  conf_dir << "files-" << node->GetId () << "";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/usr/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/local/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/etc/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-
-  conf_file << conf_dir.str () << "/ripd.conf";
-  rip_conf->SetFilename ("/usr/local/etc/ripd.conf");
-
-  std::ofstream conf;
-  conf.open (conf_file.str ().c_str ());
-  rip_conf->Print (conf);
-  conf.close ();
+  uint32_t id = node->GetId ();
+  if (m_ospfDebug)
+    {
+      SetDebug (id, OSPFD, true);
+    }
+
+  // ospfd takes the router-id of zebra when it has none of its own: with
+  // the router-id in zebra.conf, ospfd.conf is the same on every node
+  bool zebraRouterId = m_configDedup && !m_configs.m_manualZebra[id]
+    && m_configs.m_ospfRouterId[id] != "";
+  if (zebraRouterId != static_cast<bool> (m_configs.m_zebraRouterId[id]))
+    {
+      m_configs.m_zebraRouterId[id] = zebraRouterId;
+      SetDirty (id, OSPFD);
+      SetDirty (id, ZEBRA);
+    }
+
+  // settings of the node apply to all its interfaces, and point-to-point
+  // devices get point-to-point interfaces
+  const OspfInterfaceConfig &defaults = m_configs.m_ospfNodeInterface[id];
+  int64_t costUnit = m_configs.m_ospfCostUnit[id];
+  bool timers = defaults.m_hello || defaults.m_dead || defaults.m_retransmit
+    || defaults.m_helloMultiplier || costUnit > 0;
+  if (!(m_configs.m_released[id] & (1 << OSPFD)))
+    {
+      for (uint32_t d = 0; d < node->GetNDevices (); d++)
+        {
+          Ptr<NetDevice> device = node->GetDevice (d);
+          if (!DynamicCast<LoopbackNetDevice> (device)
+              && (timers || (m_ospfPointToPoint && device->IsPointToPoint ())))
+            {
+              GetOspfInterface (device);
+            }
+        }
+    }
+  std::vector<OspfInterfaceConfig> &interfaces = m_configs.m_ospfInterfaces[id];
+  for (std::vector<OspfInterfaceConfig>::iterator i = interfaces.begin (); i != interfaces.end (); ++i)
+    {
+      Ptr<NetDevice> device = node->GetDevice (i->m_device);
+      std::string name = LinuxLinkControlHelper::GetInterfaceName (device);
+      bool pointToPoint = m_ospfPointToPoint && device->IsPointToPoint ();
+      uint32_t delayCost = costUnit > 0 ? OspfCostUpdater::GetDelayCost (device, NanoSeconds (costUnit)) : 0;
+      if (name != i->m_name || pointToPoint != i->m_pointToPointDevice
+          || delayCost != i->m_delayCost)
+        {
+          i->m_name = name;
+          i->m_pointToPointDevice = pointToPoint;
+          i->m_delayCost = delayCost;
+          SetDirty (id, OSPFD);
+        }
+    }
+
+  if (!(m_configs.m_dirty[id] & (1 << OSPFD)))
+    {
+      return;
+    }
+  AddConfigFile (node, slot, OSPFD, &QuaggaHelper::PrintOspfConfig, files);
+}
+
+void
+QuaggaHelper::GenerateConfigBgp (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files)
+{
+  uint32_t id = node->GetId ();
+  if (m_configs.m_bgpAdvertisementInterval[id] != m_bgpAdvertisementInterval)
+    {
+      m_configs.m_bgpAdvertisementInterval[id] = m_bgpAdvertisementInterval;
+      SetDirty (id, BGPD);
+    }
+  if (!(m_configs.m_dirty[id] & (1 << BGPD)))
+    {
+      return;
+    }
+  AddConfigFile (node, slot, BGPD, &QuaggaHelper::PrintBgpConfig, files);
+}
+
+void
+QuaggaHelper::GenerateConfigOspf6 (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files)
+{
+  uint32_t id = node->GetId ();
+  if (m_configs.m_ospf6RetransmitInterval[id] != m_ospf6RetransmitInterval)
+    {
+      m_configs.m_ospf6RetransmitInterval[id] = m_ospf6RetransmitInterval;
+      SetDirty (id, OSPF6D);
+    }
+  if (m_ospf6Debug)
+    {
+      SetDebug (id, OSPF6D, true);
+    }
+  if (!(m_configs.m_dirty[id] & (1 << OSPF6D)))
+    {
+      return;
+    }
+  AddConfigFile (node, slot, OSPF6D, &QuaggaHelper::PrintOspf6Config, files);
 }
 
 void
-QuaggaHelper::GenerateConfigRipng (Ptr<Node> node)
+QuaggaHelper::GenerateConfigRip (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files)
 {
   NS_LOG_FUNCTION (node);
 
-  Ptr<RipngConfig> ripng_conf = node->GetObject<RipngConfig> ();
-
-  // config generation
-  std::stringstream conf_dir, conf_file;
-  // FIXME XXX
-  conf_dir << "files-" << node->GetId () << "";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/usr/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/local/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-  conf_dir << "/etc/";
-  ::mkdir (conf_dir.str ().c_str (), S_IRWXU | S_IRWXG);
-
-  conf_file << conf_dir.str () << "/ripngd.conf";
-  ripng_conf->SetFilename ("/usr/local/etc/ripngd.conf");
-
-  std::ofstream conf;
-  conf.open (conf_file.str ().c_str ());
-  ripng_conf->Print (conf);
+  uint32_t id = node->GetId ();
+  if (m_ripDebug)
+    {
+      SetDebug (id, RIPD, true);
+    }
+  if (!(m_configs.m_dirty[id] & (1 << RIPD)))
+    {
+      return;
+    }
+  AddConfigFile (node, slot, RIPD, &QuaggaHelper::PrintRipConfig, files);
+}
+
+void
+QuaggaHelper::GenerateConfigRipng (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files)
+{
+  NS_LOG_FUNCTION (node);
+
+  uint32_t id = node->GetId ();
+  if (m_ripngDebug)
+    {
+      SetDebug (id, RIPNGD, true);
+    }
+  if (!(m_configs.m_dirty[id] & (1 << RIPNGD)))
+    {
+      return;
+    }
+  AddConfigFile (node, slot, RIPNGD, &QuaggaHelper::PrintRipngConfig, files);
+}
+
+static void
+MakeDirs (std::string path)
+{
+  ::mkdir (path.c_str (), S_IRWXU | S_IRWXG);
+  path += "/usr";
+  ::mkdir (path.c_str (), S_IRWXU | S_IRWXG);
+  path += "/local";
+  ::mkdir (path.c_str (), S_IRWXU | S_IRWXG);
+}
+
+// FNV-1a
+static uint64_t
+HashConfig (const std::string &body)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (std::string::const_iterator c = body.begin (); c != body.end (); ++c)
+    {
+      hash ^= static_cast<uint8_t> (*c);
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+static void
+WriteConfigFile (const std::string &path, const std::string &body)
+{
+  // never write through a hard link shared with other nodes
+  ::unlink (path.c_str ());
+  std::ofstream conf (path.c_str ());
+  conf << body;
   conf.close ();
 }
 
+/*
+ * The Render/Write/Link passes run in the config threads.  Each only
+ * touches the files of the nodes whose slot falls on its thread, so the
+ * directories of a node are created before its files by the same thread
+ * and no locking is needed.
+ */
+void
+QuaggaHelper::RenderConfigFiles (ConfigBatch *batch, uint32_t first, uint32_t step)
+{
+  for (std::vector<ConfigFile>::iterator i = batch->m_files.begin ();
+       i != batch->m_files.end (); ++i)
+    {
+      if (i->m_slot % step != first)
+        {
+          continue;
+        }
+      std::ostringstream node_dir;
+      node_dir << "files-" << i->m_nodeId;
+      std::string conf_dir = node_dir.str () + "/usr/local/etc";
+      if (i->m_mkdir)
+        {
+          MakeDirs (node_dir.str ());
+          if (batch->m_store.empty ())
+            {
+              ::mkdir (conf_dir.c_str (), S_IRWXU | S_IRWXG);
+            }
+          else
+            {
+              // files are written through the link; if a real directory
+              // is already there the link fails and they stay on disk
+              std::string store_dir = batch->m_store + "/" + node_dir.str ();
+              MakeDirs (store_dir);
+              store_dir += "/usr/local/etc";
+              ::mkdir (store_dir.c_str (), S_IRWXU | S_IRWXG);
+              ::symlink (store_dir.c_str (), conf_dir.c_str ());
+            }
+        }
+      i->m_path = conf_dir + "/" + i->m_name;
+
+      std::ostringstream body;
+      i->m_print (*batch->m_table, i->m_nodeId, body);
+      i->m_body = body.str ();
+      i->m_hash = HashConfig (i->m_body);
+    }
+}
+
+void
+QuaggaHelper::WriteConfigFiles (ConfigBatch *batch, uint32_t first, uint32_t step)
+{
+  for (std::vector<ConfigFile>::const_iterator i = batch->m_files.begin ();
+       i != batch->m_files.end (); ++i)
+    {
+      if (i->m_slot % step == first && i->m_action == WRITE)
+        {
+          WriteConfigFile (i->m_path, i->m_body);
+        }
+    }
+}
+
+void
+QuaggaHelper::LinkConfigFiles (ConfigBatch *batch, uint32_t first, uint32_t step)
+{
+  for (std::vector<ConfigFile>::const_iterator i = batch->m_files.begin ();
+       i != batch->m_files.end (); ++i)
+    {
+      if (i->m_slot % step != first || i->m_action != LINK)
+        {
+          continue;
+        }
+      ::unlink (i->m_path.c_str ());
+      if (::link (i->m_linkFrom.c_str (), i->m_path.c_str ()) != 0)
+        {
+          // e.g. across file systems: keep a copy
+          WriteConfigFile (i->m_path, i->m_body);
+        }
+    }
+}
+
+void
+QuaggaHelper::ForgetConfigBody (const std::string &path)
+{
+  std::map<std::string, uint64_t>::iterator p = m_bodyPaths.find (path);
+  if (p == m_bodyPaths.end ())
+    {
+      return;
+    }
+  std::map<uint64_t, ConfigBody>::iterator b = m_bodies.find (p->second);
+  if (b != m_bodies.end () && b->second.m_path == path)
+    {
+      m_bodies.erase (b);
+    }
+  m_bodyPaths.erase (p);
+}
+
+/*
+ * Every distinct config body is written once; files with the same body
+ * become hard links to the first file written with it, in this call or
+ * an earlier one.  A file whose body did not change is left alone.
+ */
+uint32_t
+QuaggaHelper::DeduplicateConfigFiles (ConfigBatch *batch)
+{
+  // files about to change can no longer be linked to
+  for (std::vector<ConfigFile>::const_iterator i = batch->m_files.begin ();
+       i != batch->m_files.end (); ++i)
+    {
+      std::map<std::string, uint64_t>::const_iterator p = m_bodyPaths.find (i->m_path);
+      if (p != m_bodyPaths.end () && (p->second != i->m_hash || m_bodies[p->second].m_body != i->m_body))
+        {
+          ForgetConfigBody (i->m_path);
+        }
+    }
+
+  uint32_t nWrites = 0;
+  for (std::vector<ConfigFile>::iterator i = batch->m_files.begin ();
+       i != batch->m_files.end (); ++i)
+    {
+      std::map<uint64_t, ConfigBody>::iterator b = m_bodies.find (i->m_hash);
+      if (b != m_bodies.end () && b->second.m_body == i->m_body)
+        {
+          if (b->second.m_path == i->m_path)
+            {
+              i->m_action = KEEP;
+              continue;
+            }
+          ForgetConfigBody (i->m_path);
+          i->m_action = LINK;
+          i->m_linkFrom = b->second.m_path;
+          continue;
+        }
+      ForgetConfigBody (i->m_path);
+      i->m_action = WRITE;
+      nWrites++;
+      if (b == m_bodies.end ())
+        {
+          ConfigBody &body = m_bodies[i->m_hash];
+          body.m_path = i->m_path;
+          body.m_body = i->m_body;
+          m_bodyPaths[i->m_path] = i->m_hash;
+        }
+    }
+  return nWrites;
+}
+
+void
+QuaggaHelper::RunConfigThreads (ConfigPassFn pass, ConfigBatch *batch, uint32_t nThreads)
+{
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t t = 1; t < nThreads; t++)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (pass, batch, t, nThreads)));
+      threads.back ()->Start ();
+    }
+  pass (batch, 0, nThreads);
+  for (uint32_t t = 0; t < threads.size (); t++)
+    {
+      threads[t]->Join ();
+    }
+}
+
+static int
+RemoveEntry (const char *path, const struct stat *sb, int flag, struct FTW *ftw)
+{
+  ::remove (path);
+  return 0;
+}
+
+void
+QuaggaHelper::RemoveConfigStore (std::string store, std::vector<uint32_t> nodes)
+{
+  for (std::vector<uint32_t>::const_iterator i = nodes.begin (); i != nodes.end (); ++i)
+    {
+      std::ostringstream node_dir;
+      node_dir << "files-" << *i;
+      std::string link = node_dir.str () + "/usr/local/etc";
+      struct stat st;
+      if (::lstat (link.c_str (), &st) == 0 && S_ISLNK (st.st_mode))
+        {
+          ::unlink (link.c_str ());
+          // the rest of files-N goes too if nothing else was written there
+          ::rmdir ((node_dir.str () + "/usr/local").c_str ());
+          ::rmdir ((node_dir.str () + "/usr").c_str ());
+          ::rmdir (node_dir.str ().c_str ());
+        }
+      ::nftw ((store + "/" + node_dir.str ()).c_str (), &RemoveEntry, 16, FTW_DEPTH | FTW_PHYS);
+    }
+  ::rmdir (store.c_str ());
+}
+
+void
+QuaggaHelper::GenerateConfigs (NodeContainer c)
+{
+  // Collect the files to write, i.e. the configs changed since they were
+  // last written.  This touches the ns-3 objects of the nodes (reference
+  // counts are not thread-safe) and grows the config table, so it stays
+  // serial.
+  NS_ABORT_MSG_IF (!m_configStore.empty () && m_configStore[0] != '/',
+                   "config store " << m_configStore << " is not an absolute path");
+  ConfigBatch batch;
+  batch.m_store = m_configStore;
+  batch.m_table = &m_configs;
+  std::vector<ConfigFile> &files = batch.m_files;
+  for (uint32_t slot = 0; slot < c.GetN (); slot++)
+    {
+      Ptr<Node> node = c.Get (slot);
+      uint32_t id = GetConfigEntry (node);
+      Enable (id, ZEBRA);
+      if (IsEnabled (id, OSPFD))
+        {
+          GenerateConfigOspf (node, slot, files);
+        }
+      if (IsEnabled (id, BGPD))
+        {
+          GenerateConfigBgp (node, slot, files);
+        }
+      if (IsEnabled (id, OSPF6D))
+        {
+          GenerateConfigOspf6 (node, slot, files);
+        }
+      if (IsEnabled (id, RIPD))
+        {
+          GenerateConfigRip (node, slot, files);
+        }
+      if (IsEnabled (id, RIPNGD))
+        {
+          GenerateConfigRipng (node, slot, files);
+        }
+      // last: the daemons above can change it (OSPF router-id)
+      GenerateConfigZebra (node, slot, files);
+    }
+
+  if (!m_configStore.empty ())
+    {
+      std::vector<uint32_t> newNodes;
+      for (std::vector<ConfigFile>::const_iterator i = files.begin (); i != files.end (); ++i)
+        {
+          if (i->m_mkdir)
+            {
+              newNodes.push_back (i->m_nodeId);
+            }
+        }
+      if (!newNodes.empty ())
+        {
+          ::mkdir (m_configStore.c_str (), S_IRWXU | S_IRWXG);
+          Simulator::ScheduleDestroy (&QuaggaHelper::RemoveConfigStore, m_configStore, newNodes);
+        }
+    }
+
+  // Format and write them in parallel; small installs are not worth a thread
+  uint32_t nThreads = std::min (GetConfigThreads (), (c.GetN () + 63) / 64);
+  nThreads = std::max (nThreads, 1u);
+  RunConfigThreads (&QuaggaHelper::RenderConfigFiles, &batch, nThreads);
+  uint32_t nWrites = files.size ();
+  if (m_configDedup)
+    {
+      nWrites = DeduplicateConfigFiles (&batch);
+    }
+  RunConfigThreads (&QuaggaHelper::WriteConfigFiles, &batch, nThreads);
+  if (m_configDedup)
+    {
+      RunConfigThreads (&QuaggaHelper::LinkConfigFiles, &batch, nThreads);
+    }
+  NS_LOG_INFO (files.size () << " config files for " << c.GetN () << " nodes in "
+                             << nThreads << " threads, " << nWrites << " written");
+
+  CompactConfigs (c);
+}
+
+uint64_t
+QuaggaHelper::GetConfigMemory (uint32_t id) const
+{
+  const ConfigTable &t = m_configs;
+  // the entry of the node in each array
+  uint64_t bytes = 6 * sizeof (uint8_t) + 4 * sizeof (uint32_t) + sizeof (int64_t) + sizeof (std::string)
+    + sizeof (std::pair<int32_t, std::string>) + 10 * sizeof (std::vector<std::string>)
+    + sizeof (OspfInterfaceConfig) + sizeof (OspfRouterTimers);
+  bytes += HeapBytes (t.m_ospfNodeInterface[id].m_name);
+  bytes += t.m_ospfInterfaces[id].capacity () * sizeof (OspfInterfaceConfig);
+  for (std::vector<OspfInterfaceConfig>::const_iterator i = t.m_ospfInterfaces[id].begin ();
+       i != t.m_ospfInterfaces[id].end (); ++i)
+    {
+      bytes += HeapBytes (i->m_name);
+    }
+  bytes += HeapBytes (t.m_radvd[id]) + HeapBytes (t.m_haFlag[id])
+    + HeapBytes (t.m_ospfRouterId[id]) + HeapBytes (t.m_ospfNetworks[id])
+    + HeapBytes (t.m_ospfAreaRange[id].second)
+    + HeapBytes (t.m_bgpNeighbors[id]) + HeapBytes (t.m_bgpPeerLinks[id])
+    + HeapBytes (t.m_bgpNetworks[id]) + HeapBytes (t.m_ospf6Interfaces[id])
+    + HeapBytes (t.m_ripNetworks[id]) + HeapBytes (t.m_ripngNetworks[id]);
+  return bytes;
+}
+
+void
+QuaggaHelper::CompactConfigs (NodeContainer c)
+{
+  // the daemons only read the files, so the configs can go once written
+  m_configMemory.m_nodes = c.GetN ();
+  m_configMemory.m_rendered = 0;
+  m_configMemory.m_compacted = 0;
+  ConfigTable &t = m_configs;
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      uint32_t id = (*i)->GetId ();
+      m_configMemory.m_rendered += GetConfigMemory (id);
+      ShrinkToFit (t.m_radvd[id]);
+      ShrinkToFit (t.m_haFlag[id]);
+      ShrinkToFit (t.m_ospfNetworks[id]);
+      ShrinkToFit (t.m_ospfInterfaces[id]);
+      ShrinkToFit (t.m_bgpNeighbors[id]);
+      ShrinkToFit (t.m_bgpPeerLinks[id]);
+      ShrinkToFit (t.m_bgpNetworks[id]);
+      ShrinkToFit (t.m_ospf6Interfaces[id]);
+      ShrinkToFit (t.m_ripNetworks[id]);
+      ShrinkToFit (t.m_ripngNetworks[id]);
+
+      // a dirty config was not written (manual zebra.conf); flags, the
+      // router-ids and the ASN are kept
+      uint8_t release = m_releaseConfigs ? t.m_enabled[id] & ~t.m_dirty[id] : 0;
+      if (release & (1 << ZEBRA))
+        {
+          Clear (t.m_radvd[id]);
+          Clear (t.m_haFlag[id]);
+        }
+      if (release & (1 << OSPFD))
+        {
+          Clear (t.m_ospfNetworks[id]);
+          Clear (t.m_ospfAreaRange[id].second);
+          // EnableOspfCostUpdates () leaves the explicit costs alone
+          std::vector<OspfInterfaceConfig> costs;
+          for (std::vector<OspfInterfaceConfig>::const_iterator j = t.m_ospfInterfaces[id].begin ();
+               j != t.m_ospfInterfaces[id].end (); ++j)
+            {
+              if (j->m_cost != 0)
+                {
+                  costs.push_back (*j);
+                }
+            }
+          Clear (t.m_ospfInterfaces[id]);
+          if (!costs.empty ())
+            {
+              t.m_ospfInterfaces[id] = costs;
+            }
+        }
+      if (release & (1 << BGPD))
+        {
+          Clear (t.m_bgpNeighbors[id]);
+          Clear (t.m_bgpPeerLinks[id]);
+          Clear (t.m_bgpNetworks[id]);
+        }
+      if (release & (1 << OSPF6D))
+        {
+          Clear (t.m_ospf6Interfaces[id]);
+        }
+      if (release & (1 << RIPD))
+        {
+          Clear (t.m_ripNetworks[id]);
+        }
+      if (release & (1 << RIPNGD))
+        {
+          Clear (t.m_ripngNetworks[id]);
+        }
+      t.m_released[id] |= release;
+      m_configMemory.m_compacted += GetConfigMemory (id);
+    }
+  NS_LOG_INFO ("configs of " << c.GetN () << " nodes: " << m_configMemory.m_rendered
+                             << " bytes, " << m_configMemory.m_compacted << " after compaction");
+}
+
 ApplicationContainer
 QuaggaHelper::Install (Ptr<Node> node)
 {
-  return ApplicationContainer (InstallPriv (node));
+  return Install (NodeContainer (node));
 }
 
 ApplicationContainer
 QuaggaHelper::Install (std::string nodeName)
 {
   Ptr<Node> node = Names::Find<Node> (nodeName);
-  return ApplicationContainer (InstallPriv (node));
+  return Install (NodeContainer (node));
 }
 
 ApplicationContainer
 QuaggaHelper::Install (NodeContainer c)
 {
+  GenerateConfigs (c);
+
   ApplicationContainer apps;
   for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
     {
       apps.Add (InstallPriv (*i));
     }
+  NS_LOG_INFO ("Quagga memory reserved: " << GetReservedMemory () / (1024 * 1024) << " MiB");
 
   return apps;
 }
 
+QuaggaHelper::Daemon
+QuaggaHelper::LookupDaemon (std::string name)
+{
+  for (uint32_t d = 0; d < N_DAEMONS; d++)
+    {
+      if (name == g_daemonNames[d])
+        {
+          return static_cast<Daemon> (d);
+        }
+    }
+  NS_FATAL_ERROR ("unknown Quagga daemon " << name);
+  return N_DAEMONS;
+}
+
+void
+QuaggaHelper::SetStackSize (std::string daemon, uint32_t stackSize)
+{
+  this->*StackSizeMember (LookupDaemon (daemon)) = stackSize;
+}
+
+void
+QuaggaHelper::SetStackSize (NodeContainer nodes, std::string daemon, uint32_t stackSize)
+{
+  Daemon d = LookupDaemon (daemon);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      m_nodeMemory[std::make_pair ((*i)->GetId (), d)].m_stackSize = stackSize;
+    }
+}
+
+void
+QuaggaHelper::SetHeapBudget (std::string daemon, uint64_t bytes)
+{
+  this->*HeapBudgetMember (LookupDaemon (daemon)) = bytes;
+}
+
+void
+QuaggaHelper::SetHeapBudget (NodeContainer nodes, std::string daemon, uint64_t bytes)
+{
+  Daemon d = LookupDaemon (daemon);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      m_nodeMemory[std::make_pair ((*i)->GetId (), d)].m_heapBudget = bytes;
+    }
+}
+
+QuaggaHelper::DaemonMemory
+QuaggaHelper::GetDaemonMemory (Ptr<Node> node, Daemon daemon) const
+{
+  DaemonMemory memory;
+  memory.m_stackSize = this->*StackSizeMember (daemon);
+  memory.m_heapBudget = this->*HeapBudgetMember (daemon);
+  std::map<std::pair<uint32_t, uint32_t>, DaemonMemory>::const_iterator i =
+    m_nodeMemory.find (std::make_pair (node->GetId (), daemon));
+  if (i != m_nodeMemory.end ())
+    {
+      // 0: not set for the node
+      memory.m_stackSize = i->second.m_stackSize ? i->second.m_stackSize : memory.m_stackSize;
+      memory.m_heapBudget = i->second.m_heapBudget ? i->second.m_heapBudget : memory.m_heapBudget;
+    }
+  return memory;
+}
+
+uint64_t
+QuaggaHelper::GetReservedMemory (void) const
+{
+  uint64_t total = 0;
+  for (uint32_t d = 0; d < N_DAEMONS; d++)
+    {
+      total += m_usage[d].m_stack + m_usage[d].m_heap;
+    }
+  return total;
+}
+
+void
+QuaggaHelper::PrintMemoryReport (std::ostream &os) const
+{
+  const double MiB = 1024.0 * 1024.0;
+  std::ios::fmtflags flags = os.flags ();
+  os.setf (std::ios::fixed);
+  os.precision (1);
+  os << "daemon   count   stack(MiB)   heap(MiB)" << std::endl;
+  for (uint32_t d = 0; d < N_DAEMONS; d++)
+    {
+      if (m_usage[d].m_count == 0)
+        {
+          continue;
+        }
+      os << std::left << std::setw (8) << g_daemonNames[d] << std::right
+         << std::setw (6) << m_usage[d].m_count
+         << std::setw (13) << m_usage[d].m_stack / MiB
+         << std::setw (12) << m_usage[d].m_heap / MiB << std::endl;
+    }
+  os << "reserved " << GetReservedMemory () / MiB << " MiB";
+  long pages = ::sysconf (_SC_PHYS_PAGES);
+  long pageSize = ::sysconf (_SC_PAGESIZE);
+  if (pages > 0 && pageSize > 0)
+    {
+      double physical = static_cast<double> (pages) * pageSize;
+      os << " of " << physical / MiB << " MiB physical memory ("
+         << 100.0 * GetReservedMemory () / physical << "%)";
+    }
+  os << std::endl;
+
+  if (m_configMemory.m_nodes > 0)
+    {
+      uint64_t index = 0;
+      for (std::map<uint64_t, ConfigBody>::const_iterator i = m_bodies.begin ();
+           i != m_bodies.end (); ++i)
+        {
+          index += 32 + sizeof (*i) + HeapBytes (i->second.m_path) + HeapBytes (i->second.m_body);
+        }
+      os.precision (0);
+      os << "configs  " << m_configMemory.m_nodes << " nodes (last install): "
+         << static_cast<double> (m_configMemory.m_rendered) / m_configMemory.m_nodes
+         << " bytes/node rendered, "
+         << static_cast<double> (m_configMemory.m_compacted) / m_configMemory.m_nodes
+         << " bytes/node kept" << (m_releaseConfigs ? " (released)" : "")
+         << ", dedup index " << index << " bytes" << std::endl;
+    }
+  os.flags (flags);
+}
+
+Ptr<Application>
+QuaggaHelper::InstallDaemon (Ptr<Node> node, Daemon daemon)
+{
+  std::string name = g_daemonNames[daemon];
+  DaemonMemory memory = GetDaemonMemory (node, daemon);
+  DceApplicationHelper process;
+  process.SetBinary (name);
+  process.AddArguments ("-f", "/usr/local/etc/" + name + ".conf");
+  process.AddArguments ("-i", "/usr/local/etc/" + name + ".pid");
+  process.SetStackSize (memory.m_stackSize);
+  // DceApplicationHelper adds the application to the node
+  ApplicationContainer app = process.Install (node);
+  if (!m_startPolicy)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (m_startPolicyType);
+      m_startPolicy = factory.Create<QuaggaStartPolicy> ();
+    }
+  app.Start (m_startPolicy->GetStartTime (node, name));
+
+  m_usage[daemon].m_count++;
+  m_usage[daemon].m_stack += memory.m_stackSize;
+  m_usage[daemon].m_heap += memory.m_heapBudget;
+  return app.Get (0);
+}
+
 ApplicationContainer
 QuaggaHelper::InstallPriv (Ptr<Node> node)
 {
-  DceApplicationHelper process;
+  // a daemon already installed keeps running; its config file was
+  // updated by GenerateConfigs and is read when it starts
   ApplicationContainer apps;
-
-  Ptr<QuaggaConfig> zebra_conf = node->GetObject<QuaggaConfig> ();
-  if (!zebra_conf)
-    {
-      zebra_conf = new QuaggaConfig ();
-      node->AggregateObject (zebra_conf);
-    }
-  GenerateConfigZebra (node);
-  process.SetBinary ("zebra");
-  process.AddArguments ("-f", zebra_conf->GetFilename ());
-  process.AddArguments ("-i", "/usr/local/etc/zebra.pid");
-  process.SetStackSize (1 << 16);
-  apps.Add (process.Install (node));
-  apps.Get (0)->SetStartTime (Seconds (1.0 + 0.01 * node->GetId ()));
-  node->AddApplication (apps.Get (0));
-
-  Ptr<OspfConfig> ospf_conf = node->GetObject<OspfConfig> ();
-  // OSPF
-  if (ospf_conf)
-    {
-      GenerateConfigOspf (node);
-      process.ResetArguments ();
-
-      process.SetBinary ("ospfd");
-      process.AddArguments ("-f", ospf_conf->GetFilename ());
-      process.AddArguments ("-i", "/usr/local/etc/ospfd.pid");
-      apps.Add (process.Install (node));
-      apps.Get (1)->SetStartTime (Seconds (5.0 + 0.001 * node->GetId ()));
-      node->AddApplication (apps.Get (1));
-    }
-
-  Ptr<BgpConfig> bgp_conf = node->GetObject<BgpConfig> ();
-  // BGP
-  if (bgp_conf)
-    {
-      GenerateConfigBgp (node);
-      process.ResetArguments ();
-      process.SetBinary ("bgpd");
-      process.AddArguments ("-f", bgp_conf->GetFilename ());
-      process.AddArguments ("-i", "/usr/local/etc/bgpd.pid");
-      apps = process.Install (node);
-      apps.Get (0)->SetStartTime (Seconds (5.0 + 0.3 * node->GetId ()));
-      //      apps.Get(0)->SetStartTime (Seconds (1.2 + 0.1 * node->GetId ()));
-      node->AddApplication (apps.Get (0));
-    }
-
-  Ptr<Ospf6Config> ospf6_conf = node->GetObject<Ospf6Config> ();
-  // OSPF6
-  if (ospf6_conf)
-    {
-      GenerateConfigOspf6 (node);
-      process.ResetArguments ();
-      process.SetBinary ("ospf6d");
-      process.AddArguments ("-f", ospf6_conf->GetFilename ());
-      process.AddArguments ("-i", "/usr/local/etc/ospf6d.pid");
-      apps = process.Install (node);
-      apps.Get (0)->SetStartTime (Seconds (5.0 + 0.5 * node->GetId ()));
-      node->AddApplication (apps.Get (0));
-    }
-
-  Ptr<RipConfig> rip_conf = node->GetObject<RipConfig> ();
-  // RIP
-  if (rip_conf)
-    {
-      GenerateConfigRip (node);
-      process.ResetArguments ();
-      process.SetBinary ("ripd");
-      process.AddArguments ("-f", rip_conf->GetFilename ());
-      process.AddArguments ("-i", "/usr/local/etc/ripd.pid");
-      apps = process.Install (node);
-      apps.Get (0)->SetStartTime (Seconds (5.0 + 0.5 * node->GetId ()));
-      node->AddApplication (apps.Get (0));
-    }
-
-  Ptr<RipngConfig> ripng_conf = node->GetObject<RipngConfig> ();
-  // RIPNG
-  if (ripng_conf)
-    {
-      GenerateConfigRipng (node);
-      process.ResetArguments ();
-      process.SetBinary ("ripngd");
-      process.AddArguments ("-f", ripng_conf->GetFilename ());
-      process.AddArguments ("-i", "/usr/local/etc/ripngd.pid");
-      apps = process.Install (node);
-      apps.Get (0)->SetStartTime (Seconds (5.0 + 0.5 * node->GetId ()));
-      node->AddApplication (apps.Get (0));
+  NodeDaemons &installed = m_daemons[node->GetId ()];
+  for (uint32_t d = 0; d < N_DAEMONS; d++)
+    {
+      if (!IsEnabled (node->GetId (), static_cast<Daemon> (d)))
+        {
+          continue;
+        }
+      if (!installed.m_apps[d])
+        {
+          installed.m_apps[d] = InstallDaemon (node, static_cast<Daemon> (d));
+        }
+      else
+        {
+          NS_LOG_LOGIC (g_daemonNames[d] << " already installed on node " << node->GetId ());
+        }
+      apps.Add (installed.m_apps[d]);
     }
 
   return apps;
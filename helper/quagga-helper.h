@@ -22,18 +22,39 @@
 
 #include "ns3/dce-manager-helper.h"
 #include "ns3/dce-application-helper.h"
+#include "ns3/net-device-container.h"
+#include "ns3/nstime.h"
+#include "ns3/object-base.h"
+#include "quagga-vty-client.h"
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
 
 namespace ns3 {
 
+class QuaggaStartPolicy;
+class OspfCostUpdater;
+
 /**
  * \brief create a quagga routing daemon as an application and associate it to a node
  *
  * This class creates one or multiple instances of ns3::Quagga and associates
  * it/them to one/multiple node(s).
+ *
+ * The settings common to all nodes (start policy, stack sizes and heap
+ * budgets, debug logs, protocol timers, config store) are attributes of
+ * ns3::QuaggaHelper, so they can be changed with SetAttribute (),
+ * Config::SetDefault (), NS_ATTRIBUTE_DEFAULT or the command line
+ * (--ns3::QuaggaHelper::OspfdStackSize=131072).  The setters below
+ * change the same values.
  */
-class QuaggaHelper
+class QuaggaHelper : public ObjectBase
 {
 public:
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
   /**
    * Create a QuaggaHelper which is used to make life easier for people wanting
    * to use quagga Applications.
@@ -44,10 +65,15 @@ public:
   /**
    * Install a quagga application on each Node in the provided NodeContainer.
    *
+   * Installing a node again does not start new daemons: the config files
+   * are updated with what was enabled since (which the daemons read if
+   * they have not started yet) and only daemons enabled since are added.
+   *
    * \param nodes The NodeContainer containing all of the nodes to get a quagga
    *              application via ProcessManager.
    *
-   * \returns A list of quagga applications, one for each input node
+   * \returns Every daemon of the nodes (zebra and the routing daemons),
+   *          including those installed by an earlier call.
    */
   ApplicationContainer Install (NodeContainer nodes);
 
@@ -73,12 +99,135 @@ public:
   ApplicationContainer Install (std::string nodeName);
 
   /**
-   * \brief Configure ping applications attribute
+   * \brief Set the number of threads writing the config files in
+   * Install (NodeContainer) (default: the number of online CPUs).
+   *
+   * Config files of all the nodes are generated first, then formatted
+   * and written by the threads, each thread taking whole nodes, and the
+   * daemons are installed last.  Installs of less than 64 nodes per
+   * thread use fewer threads.
+   *
+   * \param nThreads The number of threads, 1 to write from the caller only.
+   */
+  void SetConfigThreads (uint32_t nThreads);
+
+  /**
+   * \brief Keep the config files out of the working directory.
+   *
+   * The config files are written to dir/files-N/usr/local/etc and
+   * files-N/usr/local/etc becomes a symbolic link to it, so the daemons
+   * still find them at /usr/local/etc.  With dir on a tmpfs (e.g.
+   * /dev/shm/quagga-run1) configs, pid files and sockets of the daemons
+   * never reach the disk.  The store and the links are removed when the
+   * simulator is destroyed.  A files-N/usr/local/etc directory left by
+   * an earlier run is used as is.
+   *
+   * \param dir An absolute path, or "" to write to the working directory
+   *            (the default).
+   */
+  void SetConfigStore (std::string dir);
+
+  /**
+   * \brief Write each distinct config file once (enabled by default).
+   *
+   * Rendered configs are hashed; a file with the same content as one
+   * already written (by this or an earlier Install ()) becomes a hard
+   * link to it, and a file whose content did not change is not written
+   * again.  The OSPF router-id set with SetOspfRouterId () then goes to
+   * zebra.conf, which ospfd takes it from, so that ospfd.conf is the
+   * same on every router and only the small zebra.conf is per node.
+   *
+   * \param enable Whether to deduplicate the config files.
+   */
+  void SetConfigDedup (bool enable);
+
+  /**
+   * \brief Set the policy deciding when the daemons start.
+   *
+   * By default (QuaggaUniformStartPolicy) zebra of the nodes start
+   * evenly spread over 2 s from 1 s, and the routing daemons 4 s after
+   * the zebra of their node.
+   *
+   * \param policy The policy, used by the following Install () calls.
+   */
+  void SetStartPolicy (Ptr<QuaggaStartPolicy> policy);
+
+  /**
+   * \brief Set the fiber stack size of a daemon type.
    *
-   * \param name   attribute's name
-   * \param value  attribute's value
+   * Defaults: 256 KiB for bgpd, 64 KiB for the other daemons.
+   *
+   * \param daemon The daemon binary ("zebra", "ospfd", "bgpd", "ospf6d",
+   *               "ripd" or "ripngd").
+   * \param stackSize The stack size in bytes.
+   */
+  void SetStackSize (std::string daemon, uint32_t stackSize);
+
+  /**
+   * \brief Set the fiber stack size of a daemon on some nodes, overriding
+   * the size of its type.
    */
-  void SetAttribute (std::string name, const AttributeValue &value);
+  void SetStackSize (NodeContainer nodes, std::string daemon, uint32_t stackSize);
+
+  /**
+   * \brief Set the heap budget of a daemon type, i.e. the memory it is
+   * expected to allocate.  DCE does not cap the heap of a process, so
+   * the budget is only accounted in the memory report, to size runs
+   * against the memory of the host.
+   *
+   * Defaults: 16 MiB for bgpd, 8 MiB for ospfd/ospf6d, 4 MiB otherwise.
+   *
+   * \param daemon The daemon binary.
+   * \param bytes The budget in bytes.
+   */
+  void SetHeapBudget (std::string daemon, uint64_t bytes);
+
+  /**
+   * \brief Set the heap budget of a daemon on some nodes, overriding the
+   * budget of its type.
+   */
+  void SetHeapBudget (NodeContainer nodes, std::string daemon, uint64_t bytes);
+
+  /**
+   * \returns The stacks and heap budgets of the daemons installed so far,
+   * in bytes.
+   */
+  uint64_t GetReservedMemory (void) const;
+
+  /**
+   * \brief Print the number of daemons, their stacks and heap budgets by
+   * daemon type, and the total against the physical memory of the host.
+   *
+   * Also prints the memory held by the configs of the nodes of the last
+   * Install (), per node, as rendered and as kept after Install ()
+   * compacted them or, with the ReleaseConfigs attribute, emptied them.
+   */
+  void PrintMemoryReport (std::ostream &os) const;
+
+  /**
+   * \brief Run a vty command on a daemon of every node at a given time
+   * and hand its output to a callback, e.g. "show ip ospf neighbor" or
+   * "show ip bgp summary", without a vtysh process per node.
+   *
+   * The sessions go through the vty client of the helper (see
+   * GetVtyClient ()), which bounds the number of open sessions and the
+   * size of the outputs; the outputs are not kept.  A node that does not
+   * run the daemon gets a failed answer after the Timeout of the client.
+   *
+   * \param nodes The node(s) to query.
+   * \param daemon The daemon binary ("zebra", "ospfd", "bgpd"...).
+   * \param at The time from now to run the command.
+   * \param command The command.
+   * \param callback Called once per node with the answer.
+   */
+  void QueryVty (NodeContainer nodes, std::string daemon, Time at, std::string command,
+                 QuaggaVtyClient::OutputCallback callback);
+
+  /**
+   * \returns The vty client of QueryVty (), created on first use; its
+   * attributes set the password, the timeout and the memory bounds.
+   */
+  Ptr<QuaggaVtyClient> GetVtyClient (void);
 
   /**
    * \brief Enable the ospfd daemon to the nodes.
@@ -107,6 +256,129 @@ public:
    */
   void SetOspfRouterId (Ptr<Node> node, const char * routerid);
 
+  /**
+   * \brief Set the OSPF timers of every interface of the nodes.
+   *
+   * Quagga sends hellos every 10 s and declares a neighbor down after
+   * 40 s without one; shorter intervals detect a failed link sooner at
+   * the cost of more hellos.  The interfaces are those of the devices of
+   * the nodes when Install () is called.
+   *
+   * \param nodes The node(s) to configure.
+   * \param hello The hello interval in seconds (ip ospf hello-interval),
+   *              0 for the Quagga default.
+   * \param dead The dead interval in seconds (ip ospf dead-interval), 0
+   *             for the Quagga default.
+   * \param retransmit The LSA retransmit interval in seconds (ip ospf
+   *                   retransmit-interval), 0 for the Quagga default.
+   */
+  void SetOspfTimers (NodeContainer nodes, uint32_t hello, uint32_t dead, uint32_t retransmit);
+
+  /**
+   * \brief Set the OSPF timers of the interfaces of some devices,
+   * overriding those set for their node.
+   */
+  void SetOspfTimers (NetDeviceContainer devices, uint32_t hello, uint32_t dead, uint32_t retransmit);
+
+  /**
+   * \brief Detect neighbor loss within one second: a 1 s dead interval
+   * and \c multiplier hellos per second (ip ospf dead-interval minimal
+   * hello-multiplier), in place of the hello and dead intervals.
+   *
+   * \param nodes The node(s) to configure, on every interface.
+   * \param multiplier The number of hellos per second (1 to 10), 0 to
+   *                   go back to the hello and dead intervals.
+   */
+  void SetOspfFastHello (NodeContainer nodes, uint32_t multiplier);
+
+  /**
+   * \brief Set fast hellos on the interfaces of some devices, overriding
+   * the setting of their node.
+   */
+  void SetOspfFastHello (NetDeviceContainer devices, uint32_t multiplier);
+
+  /**
+   * \brief Set the OSPF network type of the interfaces of some devices.
+   *
+   * A point-to-point interface reaches Full without a DR/BDR election
+   * and its wait timer (the dead interval, 40 s by default).  The
+   * interfaces of point-to-point devices (NetDevice::IsPointToPoint ())
+   * are made point-to-point unless the OspfPointToPoint attribute is
+   * false; this overrides that for the given devices.
+   *
+   * \param devices The devices to configure.
+   * \param pointToPoint Whether the interfaces are point-to-point (ip ospf
+   *                     network point-to-point) or broadcast.
+   */
+  void SetOspfPointToPoint (NetDeviceContainer devices, bool pointToPoint);
+
+  /**
+   * \brief Set the OSPF cost of the interfaces of some devices (ip ospf
+   * cost), e.g. both ends of a link to the weight of the link.
+   *
+   * \param devices The devices to configure.
+   * \param cost The cost, 1 to 65535, or 0 to go back to the cost from
+   *             the channel delay or else the Quagga default.
+   */
+  void SetOspfCost (NetDeviceContainer devices, uint32_t cost);
+
+  /**
+   * \brief Derive the OSPF cost of every interface of the nodes from the
+   * Delay attribute of its channel, in multiples of \c unit, so that SPF
+   * picks the lowest-latency paths.
+   *
+   * The delay is read at Install (); with LEO ISLs whose delays follow
+   * the orbits (LeoIslDelayUpdater) that is the latency at that time.
+   * Costs set with SetOspfCost () take precedence.
+   *
+   * \param nodes The node(s) to configure.
+   * \param unit The delay of one unit of cost, 0 to stop deriving costs.
+   */
+  void SetOspfCostFromDelay (NodeContainer nodes, Time unit);
+
+  /**
+   * \brief Keep the OSPF costs of the interfaces of the nodes in line
+   * with the delay of their channels while the simulation runs, pushing
+   * the changed costs to the running ospfd through its vty, every
+   * \c interval (see OspfCostUpdater).
+   *
+   * Has to be called after Install ().  Interfaces with a cost set with
+   * SetOspfCost () keep it, also once ReleaseConfigs emptied the configs.  The updater is not started: start it with
+   * OspfCostUpdater::Start () once ospfd runs and has its adjacencies,
+   * i.e. after the daemon start time of the start policy.
+   *
+   * \param nodes The node(s) to follow.
+   * \param unit The delay of one unit of cost.
+   * \param interval The time between two updates.
+   * \returns The updater, to be started.
+   */
+  Ptr<OspfCostUpdater> EnableOspfCostUpdates (NodeContainer nodes, Time unit, Time interval);
+
+  /**
+   * \brief Set the SPF throttling of the nodes (timers throttle spf).
+   *
+   * Quagga waits 200 ms after a change before running SPF, then at
+   * least 1 s, doubling up to 10 s while changes keep coming.
+   *
+   * \param nodes The node(s) to configure.
+   * \param delay The delay from the first change to SPF, in ms.
+   * \param initialHold The minimum time between two SPF runs, in ms.
+   * \param maxHold The maximum time between two SPF runs, in ms.
+   */
+  void SetOspfSpfThrottle (NodeContainer nodes, uint32_t delay, uint32_t initialHold, uint32_t maxHold);
+
+  /**
+   * \brief Set the LSA pacing of the nodes (timers throttle lsa all and
+   * timers lsa arrival, Quagga 0.99.23 and later).
+   *
+   * \param nodes The node(s) to configure.
+   * \param minInterval The minimum time between two originations of an
+   *                    LSA, in ms (5000 by default).
+   * \param minArrival The minimum time between two receptions of an LSA
+   *                   accepted from neighbors, in ms (1000 by default).
+   */
+  void SetOspfLsaPacing (NodeContainer nodes, uint32_t minInterval, uint32_t minArrival);
+
   /**
    * \brief Configure the debug option to the ospfd daemon (via debug ospf xxx).
    *
@@ -226,16 +498,247 @@ public:
   void EnableRipngDebug (NodeContainer nodes);
 
 private:
+  /**
+   * \internal
+   */
+  enum Daemon
+  {
+    ZEBRA,
+    OSPFD,
+    BGPD,
+    OSPF6D,
+    RIPD,
+    RIPNGD,
+    N_DAEMONS
+  };
+
+  /**
+   * \internal
+   * The daemons installed on a node by this helper.
+   */
+  struct NodeDaemons
+  {
+    Ptr<Application> m_apps[N_DAEMONS];
+  };
+
+  struct DaemonMemory
+  {
+    uint32_t m_stackSize;
+    uint64_t m_heapBudget;
+  };
+  struct DaemonUsage
+  {
+    uint32_t m_count;
+    uint64_t m_stack;
+    uint64_t m_heap;
+  };
+  struct ConfigMemory
+  {
+    uint32_t m_nodes;
+    uint64_t m_rendered;        ///< bytes held by the configs once rendered
+    uint64_t m_compacted;       ///< and after CompactConfigs ()
+  };
+
+  /**
+   * \internal
+   * The OSPF network type of an interface.
+   */
+  enum OspfNetworkType
+  {
+    OSPF_NETWORK_AUTO,          ///< point-to-point on point-to-point devices with OspfPointToPoint, else the Quagga default
+    OSPF_NETWORK_POINT_TO_POINT,
+    OSPF_NETWORK_BROADCAST,
+  };
+
+  /**
+   * \internal
+   * The OSPF settings of an interface, or the defaults of the interfaces
+   * of a node; 0 keeps the setting of the node, then the Quagga default.
+   */
+  struct OspfInterfaceConfig
+  {
+    uint32_t m_device;          ///< index of the NetDevice in its node
+    std::string m_name;         ///< resolved by Install (), "" without interface
+    uint32_t m_hello;
+    uint32_t m_dead;
+    uint32_t m_retransmit;
+    uint32_t m_helloMultiplier;
+    uint8_t m_network;          ///< OspfNetworkType
+    bool m_pointToPointDevice;  ///< resolved by Install (), with OspfPointToPoint
+    uint32_t m_cost;
+    uint32_t m_delayCost;       ///< resolved by Install (), see m_ospfCostUnit
+  };
+  /**
+   * \internal
+   * The timers of the OSPF instance of a node, -1 for the Quagga default.
+   */
+  struct OspfRouterTimers
+  {
+    int32_t m_spfDelay;
+    int32_t m_spfInitialHold;
+    int32_t m_spfMaxHold;
+    int32_t m_lsaInterval;
+    int32_t m_lsaArrival;
+  };
+
+  /**
+   * \internal
+   * The configs of the nodes enabled through this helper as a struct of
+   * arrays indexed by node id: Install () and the renderers walk plain
+   * arrays instead of looking up objects aggregated to each node.  The
+   * lists of a node (networks, interfaces, neighbors) are vectors of
+   * their own, as nodes are enabled in any order.  The bit fields hold
+   * one bit per Daemon.
+   */
+  struct ConfigTable
+  {
+    std::vector<uint8_t> m_enabled;
+    std::vector<uint8_t> m_dirty;       ///< changed since the file was written
+    std::vector<uint8_t> m_released;    ///< emptied once written, see ReleaseConfigs
+    std::vector<uint8_t> m_debug;
+    std::vector<uint8_t> m_manualZebra; ///< zebra.conf is written by the user
+    // zebra
+    std::vector<std::vector<std::pair<std::string, std::string> > > m_radvd; ///< ifname, prefix
+    std::vector<std::vector<std::string> > m_haFlag;
+    std::vector<uint8_t> m_zebraRouterId; ///< OSPF router-id given to zebra, not in ospfd.conf
+    // ospfd
+    std::vector<std::string> m_ospfRouterId;
+    std::vector<std::vector<std::pair<std::string, uint32_t> > > m_ospfNetworks; ///< prefix, area
+    std::vector<std::pair<int32_t, std::string> > m_ospfAreaRange; ///< area -1: none
+    std::vector<OspfInterfaceConfig> m_ospfNodeInterface;  ///< defaults of the interfaces
+    std::vector<std::vector<OspfInterfaceConfig> > m_ospfInterfaces;
+    std::vector<OspfRouterTimers> m_ospfTimers;
+    std::vector<int64_t> m_ospfCostUnit;  ///< ns of channel delay per unit of cost, 0: none
+    // bgpd
+    std::vector<uint32_t> m_asn;
+    std::vector<std::vector<std::pair<std::string, uint32_t> > > m_bgpNeighbors; ///< address, ASN
+    std::vector<std::vector<std::string> > m_bgpPeerLinks;
+    std::vector<std::vector<std::string> > m_bgpNetworks;
+    std::vector<uint32_t> m_bgpAdvertisementInterval;
+    // ospf6d, ripd, ripngd
+    std::vector<std::vector<std::string> > m_ospf6Interfaces;
+    std::vector<uint32_t> m_ospf6RouterId;
+    std::vector<uint32_t> m_ospf6RetransmitInterval;
+    std::vector<std::vector<std::string> > m_ripNetworks;
+    std::vector<std::vector<std::string> > m_ripngNetworks;
+  };
+
+  typedef void (*PrintConfigFn)(const ConfigTable &table, uint32_t id, std::ostream &os);
+
+  enum ConfigAction
+  {
+    WRITE,
+    LINK,
+    KEEP,
+  };
+
+  /**
+   * \internal
+   * A config file to write: files-<nodeId>/usr/local/etc/<name>, printed
+   * from the config table.
+   */
+  struct ConfigFile
+  {
+    uint32_t m_nodeId;
+    uint32_t m_slot;            ///< index of the node in the Install () container
+    std::string m_name;
+    bool m_mkdir;               ///< first file of the node: create its directories
+    PrintConfigFn m_print;
+    std::string m_path;
+    std::string m_body;
+    uint64_t m_hash;
+    ConfigAction m_action;
+    std::string m_linkFrom;     ///< LINK: the file with the same body
+  };
+  struct ConfigBody
+  {
+    std::string m_path;
+    std::string m_body;
+  };
+  struct ConfigBatch
+  {
+    std::vector<ConfigFile> m_files;
+    const ConfigTable *m_table;
+    std::string m_store;        ///< SetConfigStore () directory, or empty
+  };
+
   /**
    * \internal
    */
   ApplicationContainer InstallPriv (Ptr<Node> node);
-  void GenerateConfigZebra (Ptr<Node> node);
-  void GenerateConfigOspf (Ptr<Node> node);
-  void GenerateConfigBgp (Ptr<Node> node);
-  void GenerateConfigOspf6 (Ptr<Node> node);
-  void GenerateConfigRip (Ptr<Node> node);
-  void GenerateConfigRipng (Ptr<Node> node);
+  Ptr<Application> InstallDaemon (Ptr<Node> node, Daemon daemon);
+  static Daemon LookupDaemon (std::string name);
+  DaemonMemory GetDaemonMemory (Ptr<Node> node, Daemon daemon) const;
+  static uint32_t QuaggaHelper::*StackSizeMember (Daemon daemon);
+  static uint64_t QuaggaHelper::*HeapBudgetMember (Daemon daemon);
+  uint32_t GetConfigThreads (void) const;
+  void GenerateConfigs (NodeContainer c);
+  uint32_t GetConfigEntry (Ptr<Node> node);
+  bool IsEnabled (uint32_t id, Daemon daemon) const;
+  void Enable (uint32_t id, Daemon daemon);
+  void SetDirty (uint32_t id, Daemon daemon);
+  void SetDebug (uint32_t id, Daemon daemon, bool debug);
+  OspfInterfaceConfig &GetOspfInterface (Ptr<NetDevice> device);
+  void AddConfigFile (Ptr<Node> node, uint32_t slot, Daemon daemon, PrintConfigFn print,
+                      std::vector<ConfigFile> &files);
+  void GenerateConfigZebra (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files);
+  void GenerateConfigOspf (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files);
+  void GenerateConfigBgp (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files);
+  void GenerateConfigOspf6 (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files);
+  void GenerateConfigRip (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files);
+  void GenerateConfigRipng (Ptr<Node> node, uint32_t slot, std::vector<ConfigFile> &files);
+  typedef void (*ConfigPassFn)(ConfigBatch *batch, uint32_t first, uint32_t step);
+  static void RunConfigThreads (ConfigPassFn pass, ConfigBatch *batch, uint32_t nThreads);
+  static void RenderConfigFiles (ConfigBatch *batch, uint32_t first, uint32_t step);
+  static void WriteConfigFiles (ConfigBatch *batch, uint32_t first, uint32_t step);
+  static void LinkConfigFiles (ConfigBatch *batch, uint32_t first, uint32_t step);
+  uint32_t DeduplicateConfigFiles (ConfigBatch *batch);
+  void ForgetConfigBody (const std::string &path);
+  void CompactConfigs (NodeContainer c);
+  uint64_t GetConfigMemory (uint32_t id) const;
+  static void PrintZebraConfig (const ConfigTable &table, uint32_t id, std::ostream &os);
+  static void PrintOspfConfig (const ConfigTable &table, uint32_t id, std::ostream &os);
+  static void PrintBgpConfig (const ConfigTable &table, uint32_t id, std::ostream &os);
+  static void PrintOspf6Config (const ConfigTable &table, uint32_t id, std::ostream &os);
+  static void PrintRipConfig (const ConfigTable &table, uint32_t id, std::ostream &os);
+  static void PrintRipngConfig (const ConfigTable &table, uint32_t id, std::ostream &os);
+  static void RemoveConfigStore (std::string store, std::vector<uint32_t> nodes);
+
+  uint32_t m_configThreads;     ///< 0: one per CPU
+  std::string m_configStore;
+  bool m_configDedup;
+  bool m_releaseConfigs;
+  bool m_ospfPointToPoint;
+  ConfigTable m_configs;
+  std::map<uint64_t, ConfigBody> m_bodies;      ///< config bodies written, by hash
+  std::map<std::string, uint64_t> m_bodyPaths;  ///< and the other way round
+  std::set<uint32_t> m_confDirs; ///< nodes whose config directory exists
+  std::map<uint32_t, NodeDaemons> m_daemons; ///< by node id
+  std::string m_startPolicyType;
+  Ptr<QuaggaStartPolicy> m_startPolicy; ///< created from m_startPolicyType if not set
+  Ptr<QuaggaVtyClient> m_vty;
+  uint32_t m_zebraStackSize;
+  uint32_t m_ospfdStackSize;
+  uint32_t m_bgpdStackSize;
+  uint32_t m_ospf6dStackSize;
+  uint32_t m_ripdStackSize;
+  uint32_t m_ripngdStackSize;
+  uint64_t m_zebraHeapBudget;
+  uint64_t m_ospfdHeapBudget;
+  uint64_t m_bgpdHeapBudget;
+  uint64_t m_ospf6dHeapBudget;
+  uint64_t m_ripdHeapBudget;
+  uint64_t m_ripngdHeapBudget;
+  bool m_zebraDebug;
+  bool m_ospfDebug;
+  bool m_ospf6Debug;
+  bool m_ripDebug;
+  bool m_ripngDebug;
+  uint32_t m_bgpAdvertisementInterval;
+  uint32_t m_ospf6RetransmitInterval;
+  std::map<std::pair<uint32_t, uint32_t>, DaemonMemory> m_nodeMemory; ///< by node id, daemon
+  DaemonUsage m_usage[N_DAEMONS];  ///< installed daemons
+  ConfigMemory m_configMemory;     ///< of the last Install ()
 };
 
 } // namespace ns3
@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "quagga-start-policy.h"
+#include "ns3/log.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-list.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include <deque>
+
+NS_LOG_COMPONENT_DEFINE ("QuaggaStartPolicy");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (QuaggaStartPolicy);
+NS_OBJECT_ENSURE_REGISTERED (QuaggaUniformStartPolicy);
+NS_OBJECT_ENSURE_REGISTERED (QuaggaJitteredStartPolicy);
+NS_OBJECT_ENSURE_REGISTERED (QuaggaBfsStartPolicy);
+NS_OBJECT_ENSURE_REGISTERED (QuaggaWaveStartPolicy);
+
+TypeId
+QuaggaStartPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuaggaStartPolicy")
+    .SetParent<Object> ()
+    .AddAttribute ("ZebraStart",
+                   "Start time of the first zebra.",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&QuaggaStartPolicy::m_zebraStart),
+                   MakeTimeChecker ())
+    .AddAttribute ("DaemonDelay",
+                   "Time between zebra and the routing daemons of a node.",
+                   TimeValue (Seconds (4.0)),
+                   MakeTimeAccessor (&QuaggaStartPolicy::m_daemonDelay),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+QuaggaStartPolicy::QuaggaStartPolicy ()
+{
+}
+
+QuaggaStartPolicy::~QuaggaStartPolicy ()
+{
+}
+
+Time
+QuaggaStartPolicy::GetStartTime (Ptr<Node> node, std::string daemon)
+{
+  Time start = m_zebraStart + GetOffset (node);
+  if (daemon != "zebra")
+    {
+      start += m_daemonDelay;
+    }
+  NS_LOG_LOGIC (daemon << " of node " << node->GetId () << " at " << start);
+  return start;
+}
+
+// Uniform
+
+TypeId
+QuaggaUniformStartPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuaggaUniformStartPolicy")
+    .SetParent<QuaggaStartPolicy> ()
+    .AddConstructor<QuaggaUniformStartPolicy> ()
+    .AddAttribute ("Window",
+                   "Time over which the nodes are spread.",
+                   TimeValue (Seconds (2.0)),
+                   MakeTimeAccessor (&QuaggaUniformStartPolicy::m_window),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+QuaggaUniformStartPolicy::QuaggaUniformStartPolicy ()
+  : m_nNodes (0)
+{
+}
+
+Time
+QuaggaUniformStartPolicy::GetOffset (Ptr<Node> node)
+{
+  // the nodes normally all exist by the time the daemons are installed;
+  // the slots stay the same if more are created between two Install ()
+  if (m_nNodes == 0)
+    {
+      m_nNodes = NodeList::GetNNodes ();
+    }
+  return Seconds (m_window.GetSeconds () * node->GetId () / m_nNodes);
+}
+
+// Jittered
+
+TypeId
+QuaggaJitteredStartPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuaggaJitteredStartPolicy")
+    .SetParent<QuaggaStartPolicy> ()
+    .AddConstructor<QuaggaJitteredStartPolicy> ()
+    .AddAttribute ("Window",
+                   "The nodes start at a uniformly random time in [0, Window).",
+                   TimeValue (Seconds (2.0)),
+                   MakeTimeAccessor (&QuaggaJitteredStartPolicy::m_window),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+QuaggaJitteredStartPolicy::QuaggaJitteredStartPolicy ()
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+}
+
+int64_t
+QuaggaJitteredStartPolicy::AssignStreams (int64_t stream)
+{
+  m_random->SetStream (stream);
+  return 1;
+}
+
+void
+QuaggaJitteredStartPolicy::DoDispose (void)
+{
+  m_random = 0;
+  m_offsets.clear ();
+  QuaggaStartPolicy::DoDispose ();
+}
+
+Time
+QuaggaJitteredStartPolicy::GetOffset (Ptr<Node> node)
+{
+  // drawn once per node, so zebra and its daemons keep their order
+  std::map<uint32_t, Time>::iterator i = m_offsets.find (node->GetId ());
+  if (i == m_offsets.end ())
+    {
+      Time offset = Seconds (m_window.GetSeconds () * m_random->GetValue (0.0, 1.0));
+      i = m_offsets.insert (std::make_pair (node->GetId (), offset)).first;
+    }
+  return i->second;
+}
+
+// BFS
+
+TypeId
+QuaggaBfsStartPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuaggaBfsStartPolicy")
+    .SetParent<QuaggaStartPolicy> ()
+    .AddConstructor<QuaggaBfsStartPolicy> ()
+    .AddAttribute ("Root",
+                   "Id of the node started first.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&QuaggaBfsStartPolicy::m_root),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("HopInterval",
+                   "Time between two hops from the root.",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&QuaggaBfsStartPolicy::m_hopInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Spacing",
+                   "Time between two nodes of the same hop.",
+                   TimeValue (MicroSeconds (100)),
+                   MakeTimeAccessor (&QuaggaBfsStartPolicy::m_spacing),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+QuaggaBfsStartPolicy::QuaggaBfsStartPolicy ()
+  : m_root (0)
+{
+}
+
+void
+QuaggaBfsStartPolicy::Compute (void)
+{
+  uint32_t n = NodeList::GetNNodes ();
+  NS_LOG_FUNCTION (this << n);
+  std::vector<int32_t> hops (n, -1);
+  std::deque<uint32_t> queue;
+  if (m_root < n)
+    {
+      hops[m_root] = 0;
+      queue.push_back (m_root);
+    }
+
+  m_offsets.assign (n, Time (0));
+  int32_t hop = 0;
+  uint32_t rank = 0;
+  while (!queue.empty ())
+    {
+      uint32_t id = queue.front ();
+      queue.pop_front ();
+      if (hops[id] != hop)
+        {
+          hop = hops[id];
+          rank = 0;
+        }
+      m_offsets[id] = Seconds (m_hopInterval.GetSeconds () * hop + m_spacing.GetSeconds () * rank++);
+
+      Ptr<Node> node = NodeList::GetNode (id);
+      for (uint32_t d = 0; d < node->GetNDevices (); d++)
+        {
+          Ptr<Channel> channel = node->GetDevice (d)->GetChannel ();
+          if (!channel)
+            {
+              continue;
+            }
+          for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+            {
+              uint32_t peer = channel->GetDevice (j)->GetNode ()->GetId ();
+              if (hops[peer] < 0)
+                {
+                  hops[peer] = hops[id] + 1;
+                  queue.push_back (peer);
+                }
+            }
+        }
+    }
+
+  rank = 0;
+  for (uint32_t id = 0; id < n; id++)
+    {
+      if (hops[id] < 0)
+        {
+          m_offsets[id] = Seconds (m_hopInterval.GetSeconds () * (hop + 1) + m_spacing.GetSeconds () * rank++);
+        }
+    }
+}
+
+Time
+QuaggaBfsStartPolicy::GetOffset (Ptr<Node> node)
+{
+  // computed over the whole topology on first use, so that it is the
+  // same for every Install () call
+  if (m_offsets.size () != NodeList::GetNNodes ())
+    {
+      Compute ();
+    }
+  return m_offsets[node->GetId ()];
+}
+
+// Waves
+
+TypeId
+QuaggaWaveStartPolicy::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuaggaWaveStartPolicy")
+    .SetParent<QuaggaStartPolicy> ()
+    .AddConstructor<QuaggaWaveStartPolicy> ()
+    .AddAttribute ("WaveSize",
+                   "Number of nodes started in a wave.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&QuaggaWaveStartPolicy::m_waveSize),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("WaveInterval",
+                   "Time between two waves.",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&QuaggaWaveStartPolicy::m_waveInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Spacing",
+                   "Time between two nodes of a wave.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&QuaggaWaveStartPolicy::m_spacing),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+QuaggaWaveStartPolicy::QuaggaWaveStartPolicy ()
+  : m_waveSize (100)
+{
+}
+
+Time
+QuaggaWaveStartPolicy::GetOffset (Ptr<Node> node)
+{
+  uint32_t id = node->GetId ();
+  return Seconds (m_waveInterval.GetSeconds () * (id / m_waveSize)
+                  + m_spacing.GetSeconds () * (id % m_waveSize));
+}
+
+} // namespace ns3
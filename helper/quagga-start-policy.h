@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef QUAGGA_START_POLICY_H
+#define QUAGGA_START_POLICY_H
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/random-variable-stream.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief decide when the Quagga daemons of each node start.
+ *
+ * zebra starts at ZebraStart plus the offset of the node, the routing
+ * daemons DaemonDelay after zebra on the same node, so that they always
+ * find zserv.  Subclasses give the per-node offset; offsets only depend
+ * on the node, so a node installed by several QuaggaHelper::Install ()
+ * calls gets the same start times.
+ */
+class QuaggaStartPolicy : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  QuaggaStartPolicy ();
+  virtual ~QuaggaStartPolicy ();
+
+  /**
+   * \param node The node of the daemon.
+   * \param daemon The daemon binary ("zebra", "ospfd", "bgpd"...).
+   * \returns The start time of the daemon.
+   */
+  Time GetStartTime (Ptr<Node> node, std::string daemon);
+
+protected:
+  /**
+   * \returns The time the daemons of the node start after ZebraStart.
+   */
+  virtual Time GetOffset (Ptr<Node> node) = 0;
+
+private:
+  Time m_zebraStart;
+  Time m_daemonDelay;
+};
+
+/**
+ * \brief spread the nodes evenly over a window, in node id order.
+ *
+ * The default policy: every node gets its own slot, so the hellos and
+ * initial LSAs of the routers are spread evenly over the event queue,
+ * and all daemons are up Window after the first one whatever the number
+ * of nodes.  The slots divide Window by the number of nodes at the first
+ * GetStartTime (), so that later Install () calls agree; nodes created
+ * after that start after Window, in slots of the same size.
+ */
+class QuaggaUniformStartPolicy : public QuaggaStartPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  QuaggaUniformStartPolicy ();
+
+protected:
+  virtual Time GetOffset (Ptr<Node> node);
+
+private:
+  Time m_window;
+  uint32_t m_nNodes;  ///< number of slots, 0 until the first offset
+};
+
+/**
+ * \brief start every node at a random time in a window.
+ */
+class QuaggaJitteredStartPolicy : public QuaggaStartPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  QuaggaJitteredStartPolicy ();
+
+  /**
+   * \brief Assign a fixed random variable stream number to the random
+   * variable used by this policy.
+   *
+   * \param stream The first stream index to use.
+   * \returns The number of stream indices assigned.
+   */
+  int64_t AssignStreams (int64_t stream);
+
+protected:
+  virtual Time GetOffset (Ptr<Node> node);
+  virtual void DoDispose (void);
+
+private:
+  Time m_window;
+  Ptr<UniformRandomVariable> m_random;
+  std::map<uint32_t, Time> m_offsets;
+};
+
+/**
+ * \brief start the nodes hop by hop from a root node.
+ *
+ * Nodes are ordered by their hop distance from the root, following the
+ * channels of their devices; each hop starts HopInterval after the
+ * previous one, the nodes of a hop Spacing apart.  Adjacencies then
+ * come up as a wave from the root instead of everywhere at once.  Nodes
+ * not connected to the root start after the last hop.
+ */
+class QuaggaBfsStartPolicy : public QuaggaStartPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  QuaggaBfsStartPolicy ();
+
+protected:
+  virtual Time GetOffset (Ptr<Node> node);
+
+private:
+  void Compute (void);
+
+  uint32_t m_root;
+  Time m_hopInterval;
+  Time m_spacing;
+  std::vector<Time> m_offsets;  ///< by node id
+};
+
+/**
+ * \brief start the nodes in waves of WaveSize nodes, in node id order.
+ *
+ * The nodes of a wave are Spacing apart and waves WaveInterval apart,
+ * so that each wave has settled before the next one starts.
+ */
+class QuaggaWaveStartPolicy : public QuaggaStartPolicy
+{
+public:
+  static TypeId GetTypeId (void);
+
+  QuaggaWaveStartPolicy ();
+
+protected:
+  virtual Time GetOffset (Ptr<Node> node);
+
+private:
+  uint32_t m_waveSize;
+  Time m_waveInterval;
+  Time m_spacing;
+};
+
+} // namespace ns3
+
+#endif /* QUAGGA_START_POLICY_H */
@@ -0,0 +1,626 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "quagga-vty-client.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/socket.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/linux-socket-fd-factory.h"
+#include "ns3/unix-fd.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <string.h>
+
+NS_LOG_COMPONENT_DEFINE ("QuaggaVtyClient");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (QuaggaVtyClient);
+
+// one read; vty answers come in chunks of at most a few KiB
+static const uint32_t VTY_BUFFER_SIZE = 4096;
+// end of a cut output kept to find the prompt, longer than any prompt
+static const uint32_t VTY_PROMPT_WINDOW = 256;
+
+// telnet commands the vty sends when a session opens
+enum
+{
+  TELNET_SE = 240,
+  TELNET_SB = 250,
+  TELNET_WILL = 251,
+  TELNET_DONT = 254,
+  TELNET_IAC = 255
+};
+
+// states of the telnet option parser
+enum
+{
+  TELNET_STATE_DATA,
+  TELNET_STATE_IAC,
+  TELNET_STATE_OPTION,
+  TELNET_STATE_SB,
+  TELNET_STATE_SB_IAC
+};
+
+TypeId
+QuaggaVtyClient::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::QuaggaVtyClient")
+    .SetParent<Object> ()
+    .AddConstructor<QuaggaVtyClient> ()
+    .AddAttribute ("Password",
+                   "Password of the vty of the daemons.",
+                   StringValue ("zebra"),
+                   MakeStringAccessor (&QuaggaVtyClient::m_password),
+                   MakeStringChecker ())
+    .AddAttribute ("PollInterval",
+                   "Time between two reads of a session.",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&QuaggaVtyClient::m_pollInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Timeout",
+                   "Time after which a session that has not run all its commands is given up.",
+                   TimeValue (Seconds (5)),
+                   MakeTimeAccessor (&QuaggaVtyClient::m_timeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxSessions",
+                   "Number of sessions open at the same time; the others are queued.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&QuaggaVtyClient::m_maxSessions),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxOutput",
+                   "Size in bytes the output of a command is cut to.",
+                   UintegerValue (65536),
+                   MakeUintegerAccessor (&QuaggaVtyClient::m_maxOutput),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+QuaggaVtyClient::QuaggaVtyClient ()
+  : m_maxSessions (64),
+    m_maxOutput (65536),
+    m_nCompleted (0),
+    m_nFailed (0),
+    m_nErrors (0),
+    m_nTruncated (0)
+{
+}
+
+QuaggaVtyClient::~QuaggaVtyClient ()
+{
+}
+
+void
+QuaggaVtyClient::DoDispose (void)
+{
+  m_sessions.clear ();
+  m_freeSlots.clear ();
+  m_queue.clear ();
+  Object::DoDispose ();
+}
+
+uint16_t
+QuaggaVtyClient::GetPort (std::string daemon)
+{
+  // ports of lib/vty.h
+  if (daemon == "zebra")
+    {
+      return 2601;
+    }
+  else if (daemon == "ripd")
+    {
+      return 2602;
+    }
+  else if (daemon == "ripngd")
+    {
+      return 2603;
+    }
+  else if (daemon == "ospfd")
+    {
+      return 2604;
+    }
+  else if (daemon == "bgpd")
+    {
+      return 2605;
+    }
+  else if (daemon == "ospf6d")
+    {
+      return 2606;
+    }
+  return 0;
+}
+
+std::string
+QuaggaVtyClient::GetHostname (std::string daemon)
+{
+  // ospfd.conf of QuaggaHelper shares the hostname of zebra
+  return daemon == "ospfd" ? "zebra" : daemon;
+}
+
+void
+QuaggaVtyClient::Run (Ptr<Node> node, std::string daemon, Time at,
+                      const std::vector<std::string> &commands, OutputCallback callback)
+{
+  Request request;
+  request.m_node = node;
+  request.m_port = GetPort (daemon);
+  request.m_hostname = GetHostname (daemon);
+  request.m_commands = commands;
+  request.m_callback = callback;
+  NS_ABORT_MSG_IF (request.m_port == 0, "no vty port for " << daemon);
+  Simulator::ScheduleWithContext (node->GetId (), at, &QuaggaVtyClient::Open,
+                                  Ptr<QuaggaVtyClient> (this), request);
+}
+
+void
+QuaggaVtyClient::Open (Request request)
+{
+  uint32_t slot;
+  if (!m_freeSlots.empty ())
+    {
+      slot = m_freeSlots.back ();
+      m_freeSlots.pop_back ();
+    }
+  else if (m_sessions.size () < m_maxSessions)
+    {
+      slot = m_sessions.size ();
+      m_sessions.push_back (Session ());
+    }
+  else
+    {
+      m_queue.push_back (request);
+      return;
+    }
+  m_sessions[slot].m_request = request;
+  Start (slot);
+}
+
+void
+QuaggaVtyClient::Start (uint32_t slot)
+{
+  Session &session = m_sessions[slot];
+  NS_LOG_FUNCTION (this << session.m_request.m_node->GetId () << session.m_request.m_port);
+  session.m_next = 0;
+  session.m_state = SESSION_LOGIN;
+  session.m_telnet = TELNET_STATE_DATA;
+  session.m_passwords = 0;
+  session.m_truncated = false;
+  session.m_deadline = Simulator::Now () + m_timeout;
+  session.m_kernel = session.m_request.m_node->GetObject<LinuxSocketFdFactory> ();
+  session.m_fd = 0;
+  if (m_buffer.empty ())
+    {
+      m_buffer.resize (VTY_BUFFER_SIZE);
+    }
+  if (session.m_kernel)
+    {
+      session.m_kernel->ScheduleTask (MakeEvent (&QuaggaVtyClient::OpenSocket,
+                                                 Ptr<QuaggaVtyClient> (this), slot));
+    }
+  else
+    {
+      OpenSocket (slot);
+    }
+  Simulator::Schedule (m_pollInterval, &QuaggaVtyClient::Poll,
+                       Ptr<QuaggaVtyClient> (this), slot);
+}
+
+void
+QuaggaVtyClient::OpenSocket (uint32_t slot)
+{
+  Session &session = m_sessions[slot];
+  if (!session.m_kernel)
+    {
+      session.m_socket = Socket::CreateSocket (session.m_request.m_node,
+                                               TcpSocketFactory::GetTypeId ());
+      session.m_socket->Connect (InetSocketAddress (Ipv4Address::GetLoopback (),
+                                                    session.m_request.m_port));
+      return;
+    }
+
+  UnixFd *fd = session.m_kernel->CreateSocket (AF_INET, SOCK_STREAM, 0);
+  if (fd == 0)
+    {
+      NS_LOG_WARN ("node " << session.m_request.m_node->GetId () << ": unable to open a TCP socket");
+      session.m_state = SESSION_FAILED;
+      return;
+    }
+  // the connection completes while the session is polled
+  fd->Fcntl (F_SETFL, O_NONBLOCK);
+  struct sockaddr_in addr;
+  ::memset (&addr, 0, sizeof (addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons (session.m_request.m_port);
+  addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+  fd->Connect ((struct sockaddr *)&addr, sizeof (addr));
+  session.m_fd = fd;
+}
+
+static void
+CloseFd (UnixFd *fd)
+{
+  fd->Close ();
+  fd->Unref ();
+}
+
+/*
+ * Poll (slot) reads and writes the session in the stack of its node and
+ * reschedules itself until the session is done, failed or timed out.
+ */
+void
+QuaggaVtyClient::Poll (uint32_t slot)
+{
+  Session &session = m_sessions[slot];
+  if (session.m_state < SESSION_DONE && Simulator::Now () >= session.m_deadline)
+    {
+      NS_LOG_WARN ("node " << session.m_request.m_node->GetId () << ": vty "
+                   << session.m_request.m_port << " timed out");
+      session.m_state = SESSION_FAILED;
+    }
+  if (session.m_state >= SESSION_DONE)
+    {
+      Finish (slot);
+      return;
+    }
+  if (session.m_kernel)
+    {
+      session.m_kernel->ScheduleTask (MakeEvent (&QuaggaVtyClient::DoPoll,
+                                                 Ptr<QuaggaVtyClient> (this), slot));
+    }
+  else
+    {
+      DoPoll (slot);
+    }
+  Simulator::Schedule (m_pollInterval, &QuaggaVtyClient::Poll,
+                       Ptr<QuaggaVtyClient> (this), slot);
+}
+
+void
+QuaggaVtyClient::DoPoll (uint32_t slot)
+{
+  Session &session = m_sessions[slot];
+  if (session.m_state >= SESSION_DONE || (session.m_kernel && session.m_fd == 0))
+    {
+      return;
+    }
+  // writes fail until the connection is up, and are retried
+  Flush (session);
+  while (session.m_state < SESSION_DONE)
+    {
+      int length;
+      if (session.m_fd)
+        {
+          length = session.m_fd->Read (&m_buffer[0], m_buffer.size ());
+          if (length == 0)
+            {
+              NS_LOG_WARN ("node " << session.m_request.m_node->GetId () << ": vty "
+                           << session.m_request.m_port << " closed");
+              session.m_state = SESSION_FAILED;
+              break;
+            }
+        }
+      else
+        {
+          length = session.m_socket->Recv (&m_buffer[0], m_buffer.size (), 0);
+        }
+      if (length <= 0)
+        {
+          break;
+        }
+      Receive (session, &m_buffer[0], length);
+    }
+  Flush (session);
+}
+
+// The vty prints its prompt without a newline, on a line of its own:
+// "ospfd> ", "ospfd# ", "ospfd(config-if)# ", or "Password: " when it
+// asks for a password.  Only a last line made of the hostname of the
+// daemon is a prompt: output cut after "*> " in "show ip bgp" is not.
+static char
+GetPrompt (const std::string &text, const std::string &hostname)
+{
+  static const std::string password = "Password: ";
+  std::string::size_type eol = text.rfind ('\n');
+  std::string::size_type begin = eol == std::string::npos ? 0 : eol + 1;
+  if (text.size () - begin == password.size ()
+      && text.compare (begin, password.size (), password) == 0)
+    {
+      return 'P';
+    }
+  if (text.compare (begin, hostname.size (), hostname) != 0)
+    {
+      return 0;
+    }
+  std::string::size_type p = begin + hostname.size ();
+  if (text.compare (p, 7, "(config") == 0)
+    {
+      p = text.find (')', p);
+      if (p == std::string::npos)
+        {
+          return 0;
+        }
+      p++;
+    }
+  if (text.size () - p != 2 || text[p + 1] != ' ' || (text[p] != '>' && text[p] != '#'))
+    {
+      return 0;
+    }
+  return text[p];
+}
+
+void
+QuaggaVtyClient::Receive (Session &session, const uint8_t *buffer, uint32_t size)
+{
+  // drop the telnet option negotiation and the carriage returns
+  for (uint32_t i = 0; i < size; i++)
+    {
+      uint8_t c = buffer[i];
+      switch (session.m_telnet)
+        {
+        case TELNET_STATE_DATA:
+          if (c == TELNET_IAC)
+            {
+              session.m_telnet = TELNET_STATE_IAC;
+            }
+          else if (c != '\r' && c != 0)
+            {
+              session.m_in += (char)c;
+            }
+          break;
+        case TELNET_STATE_IAC:
+          if (c >= TELNET_WILL && c <= TELNET_DONT)
+            {
+              session.m_telnet = TELNET_STATE_OPTION;
+            }
+          else if (c == TELNET_SB)
+            {
+              session.m_telnet = TELNET_STATE_SB;
+            }
+          else
+            {
+              session.m_telnet = TELNET_STATE_DATA;
+            }
+          break;
+        case TELNET_STATE_OPTION:
+          session.m_telnet = TELNET_STATE_DATA;
+          break;
+        case TELNET_STATE_SB:
+          if (c == TELNET_IAC)
+            {
+              session.m_telnet = TELNET_STATE_SB_IAC;
+            }
+          break;
+        case TELNET_STATE_SB_IAC:
+          session.m_telnet = c == TELNET_SE ? TELNET_STATE_DATA : TELNET_STATE_SB;
+          break;
+        }
+    }
+
+  // keep the head of a long output and the end, where the prompt is
+  if (session.m_state == SESSION_COMMAND
+      && session.m_in.size () > m_maxOutput + VTY_PROMPT_WINDOW)
+    {
+      session.m_in.erase (m_maxOutput, session.m_in.size () - m_maxOutput - VTY_PROMPT_WINDOW);
+      session.m_truncated = true;
+    }
+
+  char prompt = GetPrompt (session.m_in, session.m_request.m_hostname);
+  if (prompt)
+    {
+      HandlePrompt (session, prompt);
+    }
+}
+
+void
+QuaggaVtyClient::HandlePrompt (Session &session, char prompt)
+{
+  uint32_t nodeId = session.m_request.m_node->GetId ();
+  const std::vector<std::string> &commands = session.m_request.m_commands;
+  if (prompt == 'P')
+    {
+      // the login password, then the enable one if there is one
+      if (session.m_passwords >= 2)
+        {
+          NS_LOG_WARN ("node " << nodeId << ": vty " << session.m_request.m_port
+                       << " refused the password");
+          session.m_state = SESSION_FAILED;
+          return;
+        }
+      session.m_passwords++;
+      Send (session, m_password);
+      return;
+    }
+  if (prompt == '>')
+    {
+      if (session.m_state != SESSION_LOGIN)
+        {
+          NS_LOG_WARN ("node " << nodeId << ": vty " << session.m_request.m_port
+                       << " refused enable");
+          session.m_state = SESSION_FAILED;
+          return;
+        }
+      session.m_state = SESSION_ENABLE;
+      Send (session, "enable");
+      return;
+    }
+
+  switch (session.m_state)
+    {
+    case SESSION_LOGIN:
+    case SESSION_ENABLE:
+      session.m_state = SESSION_TERMINAL;
+      Send (session, "terminal length 0");
+      return;
+    case SESSION_COMMAND:
+      {
+        // the answer is between the echo of the command and the prompt
+        const std::string &command = commands[session.m_next];
+        std::string::size_type begin = 0;
+        if (session.m_in.compare (0, command.size (), command) == 0)
+          {
+            begin = session.m_in.find ('\n');
+            begin = begin == std::string::npos ? session.m_in.size () : begin + 1;
+          }
+        std::string::size_type end = session.m_in.rfind ('\n');
+        end = end == std::string::npos || end < begin ? begin : end + 1;
+        std::string output = session.m_in.substr (begin, end - begin);
+        bool ok = output.compare (0, 1, "%") != 0 && output.find ("\n%") == std::string::npos;
+        if (!ok)
+          {
+            NS_LOG_WARN ("node " << nodeId << ": \"" << command << "\" failed: "
+                         << output.substr (output.find ('%')));
+            m_nErrors++;
+          }
+        Deliver (session, ok, output);
+        session.m_next++;
+      }
+      break;
+    default:
+      break;
+    }
+  session.m_in.clear ();
+  if (session.m_next < commands.size ())
+    {
+      session.m_state = SESSION_COMMAND;
+      Send (session, commands[session.m_next]);
+    }
+  else
+    {
+      NS_LOG_LOGIC ("node " << nodeId << ": " << commands.size () << " vty commands run");
+      session.m_state = SESSION_DONE;
+      m_nCompleted++;
+    }
+}
+
+void
+QuaggaVtyClient::Deliver (Session &session, bool ok, std::string output)
+{
+  if (session.m_truncated)
+    {
+      NS_LOG_WARN ("node " << session.m_request.m_node->GetId () << ": output of \""
+                   << session.m_request.m_commands[session.m_next] << "\" cut to "
+                   << m_maxOutput << " bytes");
+      session.m_truncated = false;
+      m_nTruncated++;
+    }
+  if (!session.m_request.m_callback.IsNull ())
+    {
+      session.m_request.m_callback (session.m_request.m_node->GetId (),
+                                    session.m_request.m_commands[session.m_next], ok, output);
+    }
+}
+
+void
+QuaggaVtyClient::Send (Session &session, std::string line)
+{
+  session.m_in.clear ();
+  session.m_out += line;
+  session.m_out += '\n';
+}
+
+void
+QuaggaVtyClient::Flush (Session &session)
+{
+  if (session.m_out.empty ())
+    {
+      return;
+    }
+  int sent;
+  if (session.m_fd)
+    {
+      sent = session.m_fd->Write (session.m_out.data (), session.m_out.size ());
+    }
+  else
+    {
+      sent = session.m_socket->Send ((const uint8_t *)session.m_out.data (),
+                                     session.m_out.size (), 0);
+    }
+  if (sent > 0)
+    {
+      session.m_out.erase (0, sent);
+    }
+}
+
+void
+QuaggaVtyClient::Finish (uint32_t slot)
+{
+  Session &session = m_sessions[slot];
+  if (session.m_state == SESSION_FAILED)
+    {
+      m_nFailed++;
+      // the commands that did not run get an empty answer
+      for (; session.m_next < session.m_request.m_commands.size (); session.m_next++)
+        {
+          session.m_truncated = false;
+          Deliver (session, false, "");
+        }
+    }
+  if (session.m_fd)
+    {
+      session.m_kernel->ScheduleTask (MakeEvent (&CloseFd, session.m_fd));
+    }
+  if (session.m_socket)
+    {
+      session.m_socket->Close ();
+    }
+  // drop the buffers of the session, not only their contents
+  session = Session ();
+  m_freeSlots.push_back (slot);
+
+  if (!m_queue.empty ())
+    {
+      Request request = m_queue.front ();
+      m_queue.pop_front ();
+      Simulator::ScheduleWithContext (request.m_node->GetId (), Seconds (0),
+                                      &QuaggaVtyClient::Open, Ptr<QuaggaVtyClient> (this),
+                                      request);
+    }
+}
+
+uint64_t
+QuaggaVtyClient::GetNCompleted (void) const
+{
+  return m_nCompleted;
+}
+
+uint64_t
+QuaggaVtyClient::GetNFailed (void) const
+{
+  return m_nFailed;
+}
+
+uint64_t
+QuaggaVtyClient::GetNErrors (void) const
+{
+  return m_nErrors;
+}
+
+uint64_t
+QuaggaVtyClient::GetNTruncated (void) const
+{
+  return m_nTruncated;
+}
+
+} // namespace ns3
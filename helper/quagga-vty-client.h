@@ -0,0 +1,183 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef QUAGGA_VTY_CLIENT_H
+#define QUAGGA_VTY_CLIENT_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/node.h"
+#include "ns3/callback.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class LinuxSocketFdFactory;
+class UnixFd;
+class Socket;
+
+/**
+ * \brief run vty commands on the Quagga daemons of the nodes, from the
+ * simulator, without a vtysh process.
+ *
+ * A session opens a TCP connection to the vty port of the daemon
+ * (127.0.0.1:2601 for zebra, 2604 for ospfd...) through the stack of the
+ * node: a kernel socket with the Linux stack, an ns-3 TcpSocket with the
+ * ns-3 stack.  It logs in with Password, goes to the enable node, turns
+ * paging off, sends the commands one at a time, each after the prompt
+ * of the previous one, and closes the connection after the last one.
+ * Sessions are polled every PollInterval and given up after Timeout.
+ *
+ * At most MaxSessions sessions are open at a time, the others wait in a
+ * queue, so that a command for thousands of nodes at the same time does
+ * not open thousands of connections at once.  The output of a command
+ * is handed to the callback of the session as soon as its prompt comes
+ * back and is not kept; outputs longer than MaxOutput are cut, so the
+ * memory used is bounded by MaxSessions * MaxOutput whatever the number
+ * of nodes queried.
+ */
+class QuaggaVtyClient : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Receive the answer of a command.
+   *
+   * Arguments: the node id, the command, whether the command ran and
+   * did not answer an error ("% ..."), and its output without the echo
+   * of the command and the next prompt (empty if the session failed
+   * before the command ran).
+   */
+  typedef Callback<void, uint32_t, std::string, bool, std::string> OutputCallback;
+
+  QuaggaVtyClient ();
+  virtual ~QuaggaVtyClient ();
+
+  /**
+   * \param daemon The daemon binary ("zebra", "ospfd", "bgpd"...).
+   * \returns The vty port of the daemon, 0 for an unknown daemon.
+   */
+  static uint16_t GetPort (std::string daemon);
+
+  /**
+   * \param daemon The daemon binary ("zebra", "ospfd", "bgpd"...).
+   * \returns The hostname the configs of QuaggaHelper give the daemon,
+   * which starts its vty prompt.
+   */
+  static std::string GetHostname (std::string daemon);
+
+  /**
+   * \brief Run commands on the vty of a daemon of a node.
+   *
+   * \param node The node of the daemon.
+   * \param daemon The daemon binary ("zebra", "ospfd", "bgpd"...).
+   * \param at The time from now to open the session.
+   * \param commands The commands, in order (e.g. "configure terminal",
+   *                 "interface sim0", "ip ospf cost 10", "end").
+   * \param callback Called with the answer of every command, if any.
+   */
+  void Run (Ptr<Node> node, std::string daemon, Time at, const std::vector<std::string> &commands,
+            OutputCallback callback = OutputCallback ());
+
+  /**
+   * \returns The number of sessions that ran all their commands.
+   */
+  uint64_t GetNCompleted (void) const;
+
+  /**
+   * \returns The number of sessions given up (no daemon, login refused,
+   * timeout).
+   */
+  uint64_t GetNFailed (void) const;
+
+  /**
+   * \returns The number of commands whose answer was an error ("% ...").
+   */
+  uint64_t GetNErrors (void) const;
+
+  /**
+   * \returns The number of outputs cut to MaxOutput.
+   */
+  uint64_t GetNTruncated (void) const;
+
+private:
+  enum SessionState
+  {
+    SESSION_LOGIN,     ///< waiting for the password or a prompt
+    SESSION_ENABLE,    ///< "enable" sent
+    SESSION_TERMINAL,  ///< "terminal length 0" sent
+    SESSION_COMMAND,   ///< a command sent
+    SESSION_DONE,
+    SESSION_FAILED
+  };
+  struct Request
+  {
+    Ptr<Node> m_node;
+    uint16_t m_port;
+    std::string m_hostname;   ///< of the prompt
+    std::vector<std::string> m_commands;
+    OutputCallback m_callback;
+  };
+  struct Session
+  {
+    Request m_request;
+    uint32_t m_next;          ///< next command to send
+    uint8_t m_state;          ///< SessionState
+    uint8_t m_telnet;         ///< telnet option parser state
+    uint8_t m_passwords;      ///< passwords sent (login, enable)
+    bool m_truncated;         ///< output of the current command cut
+    Time m_deadline;
+    Ptr<LinuxSocketFdFactory> m_kernel;
+    UnixFd *m_fd;
+    Ptr<Socket> m_socket;
+    std::string m_in;         ///< text received since the last prompt
+    std::string m_out;        ///< bytes not sent yet
+  };
+
+  virtual void DoDispose (void);
+  void Open (Request request);
+  void Start (uint32_t slot);
+  void OpenSocket (uint32_t slot);
+  void Poll (uint32_t slot);
+  void DoPoll (uint32_t slot);
+  void Receive (Session &session, const uint8_t *buffer, uint32_t size);
+  void HandlePrompt (Session &session, char prompt);
+  void Deliver (Session &session, bool ok, std::string output);
+  void Send (Session &session, std::string line);
+  void Flush (Session &session);
+  void Finish (uint32_t slot);
+
+  Time m_pollInterval;
+  Time m_timeout;
+  uint32_t m_maxSessions;
+  uint32_t m_maxOutput;
+  std::string m_password;
+  std::vector<Session> m_sessions;
+  std::vector<uint32_t> m_freeSlots;
+  std::deque<Request> m_queue;
+  std::vector<uint8_t> m_buffer;
+  uint64_t m_nCompleted;
+  uint64_t m_nFailed;
+  uint64_t m_nErrors;
+  uint64_t m_nTruncated;
+};
+
+} // namespace ns3
+
+#endif /* QUAGGA_VTY_CLIENT_H */
@@ -0,0 +1,57 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef ABORT_CHECKER_H
+#define ABORT_CHECKER_H
+
+#include "ns3/callback.h"
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+/**
+ * \brief Check that a call aborts (NS_ABORT_MSG...) without aborting the
+ * test: the call runs in a child process, with its stderr dropped.
+ *
+ * \param call The call expected to abort.
+ * \returns Whether the child was killed by SIGABRT.
+ */
+inline bool
+CallAborts (Callback<void> call)
+{
+  pid_t pid = ::fork ();
+  if (pid == -1)
+    {
+      return false;
+    }
+  if (pid == 0)
+    {
+      int null = ::open ("/dev/null", O_WRONLY);
+      ::dup2 (null, 2);
+      call ();
+      ::_exit (0);
+    }
+  int status = 0;
+  ::waitpid (pid, &status, 0);
+  return WIFSIGNALED (status) && WTERMSIG (status) == SIGABRT;
+}
+
+} // namespace ns3
+
+#endif /* ABORT_CHECKER_H */
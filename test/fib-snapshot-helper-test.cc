@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dce-module.h"
+#include "ns3/csma-helper.h"
+#include "ns3/ipv4-dce-routing-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/fib-snapshot-helper.h"
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+
+using namespace ns3;
+namespace ns3 {
+
+// two nodes on a CSMA link with the ns-3 stack, so that the snapshots
+// read the static routing of Ipv4DceRouting
+static void
+CreateNodes (NodeContainer &nodes)
+{
+  nodes.Create (2);
+  CsmaHelper csma;
+  NetDeviceContainer devices = csma.Install (nodes);
+  InternetStackHelper stack;
+  Ipv4DceRoutingHelper routing;
+  stack.SetRoutingHelper (routing);
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (devices);
+  DceManagerHelper processManager;
+  processManager.SetNetworkStack ("ns3::Ns3SocketFdFactory");
+  processManager.Install (nodes);
+}
+
+static Ptr<Ipv4StaticRouting>
+GetStaticRouting (Ptr<Node> node)
+{
+  Ipv4StaticRoutingHelper helper;
+  return helper.GetStaticRouting (node->GetObject<Ipv4> ());
+}
+
+static void
+AddRoute (Ptr<Node> node, std::string network)
+{
+  GetStaticRouting (node)->AddNetworkRouteTo (Ipv4Address (network.c_str ()),
+                                              Ipv4Mask ("255.255.255.0"),
+                                              Ipv4Address ("10.0.0.2"), 1, 5);
+}
+
+static void
+RemoveRoute (Ptr<Node> node, std::string network)
+{
+  Ptr<Ipv4StaticRouting> routing = GetStaticRouting (node);
+  for (uint32_t r = 0; r < routing->GetNRoutes (); r++)
+    {
+      if (routing->GetRoute (r).GetDest () == Ipv4Address (network.c_str ()))
+        {
+          routing->RemoveRoute (r);
+          return;
+        }
+    }
+}
+
+// the record headers of a snapshot file, skipping the routes
+static std::vector<FibSnapshotHelper::RecordHeader>
+ReadHeaders (std::string filename)
+{
+  std::vector<FibSnapshotHelper::RecordHeader> headers;
+  std::ifstream in (filename.c_str (), std::ios::binary);
+  char magic[8];
+  in.read (magic, sizeof (magic));
+  FibSnapshotHelper::RecordHeader header;
+  while (in.read (reinterpret_cast<char *> (&header), sizeof (header)))
+    {
+      headers.push_back (header);
+      in.seekg ((header.m_nRemoved + header.m_nAdded) * sizeof (FibSnapshotHelper::Route),
+                std::ios::cur);
+    }
+  return headers;
+}
+
+/**
+ * Snapshot two nodes while routes are added to and removed from one of
+ * them, then check the records of the file and its text from Print ():
+ * the first record of each node is FULL with the whole table, the next
+ * ones only hold the changed routes and an unchanged table writes
+ * nothing.
+ */
+class FibSnapshotDeltaTestCase : public TestCase
+{
+public:
+  FibSnapshotDeltaTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FibSnapshotDeltaTestCase::FibSnapshotDeltaTestCase ()
+  : TestCase ("Write and print delta encoded snapshots")
+{
+}
+
+void
+FibSnapshotDeltaTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateNodes (nodes);
+  Ptr<Node> n0 = nodes.Get (0);
+  Ptr<Node> n1 = nodes.Get (1);
+  uint32_t nRoutes0 = GetStaticRouting (n0)->GetNRoutes ();
+  uint32_t nRoutes1 = GetStaticRouting (n1)->GetNRoutes ();
+
+  std::string filename = "fib-snapshot-helper-test.bin";
+  Ptr<FibSnapshotHelper> snapshots = CreateObject<FibSnapshotHelper> ();
+  NS_TEST_ASSERT_MSG_EQ (snapshots->Open (filename), true, "snapshot file not created");
+  snapshots->Install (nodes);
+  snapshots->SnapshotAt (Seconds (1));
+  Simulator::Schedule (Seconds (1.5), &AddRoute, n0, "192.168.0.0");
+  snapshots->SnapshotAt (Seconds (2));
+  Simulator::Schedule (Seconds (2.5), &RemoveRoute, n0, "192.168.0.0");
+  Simulator::Schedule (Seconds (2.5), &AddRoute, n0, "192.168.1.0");
+  snapshots->SnapshotAt (Seconds (3));
+  snapshots->SnapshotAt (Seconds (4));
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (snapshots->GetNSnapshots (), 4, "snapshots taken");
+  uint32_t id0 = n0->GetId ();
+  uint32_t id1 = n1->GetId ();
+  // closes the file
+  snapshots->Dispose ();
+  Simulator::Destroy ();
+
+  std::vector<FibSnapshotHelper::RecordHeader> headers = ReadHeaders (filename);
+  NS_TEST_ASSERT_MSG_EQ (headers.size (), 4, "records written");
+  NS_TEST_ASSERT_MSG_EQ (headers[0].m_nodeId, id0, "node of the first record");
+  NS_TEST_ASSERT_MSG_EQ (headers[0].m_flags, (uint32_t) FibSnapshotHelper::FULL,
+                         "first record of node 0");
+  NS_TEST_ASSERT_MSG_EQ (headers[0].m_nRemoved, 0, "routes removed in a full record");
+  NS_TEST_ASSERT_MSG_EQ (headers[0].m_nAdded, nRoutes0, "routes of node 0");
+  NS_TEST_ASSERT_MSG_EQ (headers[1].m_nodeId, id1, "node of the second record");
+  NS_TEST_ASSERT_MSG_EQ (headers[1].m_flags, (uint32_t) FibSnapshotHelper::FULL,
+                         "first record of node 1");
+  NS_TEST_ASSERT_MSG_EQ (headers[1].m_nAdded, nRoutes1, "routes of node 1");
+  // node 1 did not change after its first record, and nothing changed at 4 s
+  NS_TEST_ASSERT_MSG_EQ (headers[2].m_nodeId, id0, "node of the third record");
+  NS_TEST_ASSERT_MSG_EQ (headers[2].m_snapshot, 1, "snapshot of the third record");
+  NS_TEST_ASSERT_MSG_EQ (headers[2].m_flags, 0, "delta record");
+  NS_TEST_ASSERT_MSG_EQ (headers[2].m_nRemoved, 0, "routes removed at 2 s");
+  NS_TEST_ASSERT_MSG_EQ (headers[2].m_nAdded, 1, "routes added at 2 s");
+  NS_TEST_ASSERT_MSG_EQ (headers[3].m_snapshot, 2, "snapshot of the fourth record");
+  NS_TEST_ASSERT_MSG_EQ (headers[3].m_flags, 0, "delta record");
+  NS_TEST_ASSERT_MSG_EQ (headers[3].m_nRemoved, 1, "routes removed at 3 s");
+  NS_TEST_ASSERT_MSG_EQ (headers[3].m_nAdded, 1, "routes added at 3 s");
+
+  std::ostringstream text;
+  NS_TEST_ASSERT_MSG_EQ (FibSnapshotHelper::Print (filename, text), true, "file not printed");
+  ::remove (filename.c_str ());
+
+  std::ostringstream full0, full1, delta;
+  full0 << "# t=1 snapshot 0 node " << id0 << " full\n";
+  full1 << "# t=1 snapshot 0 node " << id1 << " full\n";
+  delta << "# t=2 snapshot 1 node " << id0 << " delta\n"
+        << "+ 192.168.0.0/24 via 10.0.0.2 dev 1 metric 5 proto 0\n"
+        << "# t=3 snapshot 2 node " << id0 << " delta\n"
+        << "- 192.168.0.0/24 via 10.0.0.2 dev 1 metric 5 proto 0\n"
+        << "+ 192.168.1.0/24 via 10.0.0.2 dev 1 metric 5 proto 0\n";
+  std::string printed = text.str ();
+  std::string::size_type start1 = printed.find (full1.str ());
+  std::string::size_type startDelta = printed.find (delta.str ());
+  NS_TEST_ASSERT_MSG_EQ (printed.compare (0, full0.str ().size (), full0.str ()), 0,
+                         "first record printed as " << printed);
+  NS_TEST_ASSERT_MSG_NE (start1, std::string::npos, "second record printed as " << printed);
+  NS_TEST_ASSERT_MSG_NE (startDelta, std::string::npos, "delta records printed as " << printed);
+  NS_TEST_ASSERT_MSG_EQ (startDelta + delta.str ().size (), printed.size (),
+                         "records after the delta ones");
+  // the full records list the connected route of the link
+  std::string connected = "+ 10.0.0.0/24 via 0.0.0.0 dev 1 metric 0 proto 0\n";
+  NS_TEST_ASSERT_MSG_NE (printed.substr (0, start1).find (connected), std::string::npos,
+                         "connected route of node 0");
+  NS_TEST_ASSERT_MSG_NE (printed.substr (start1, startDelta - start1).find (connected),
+                         std::string::npos, "connected route of node 1");
+}
+
+/**
+ * Without delta encoding every snapshot writes a FULL record for every
+ * node, changed or not.
+ */
+class FibSnapshotFullTestCase : public TestCase
+{
+public:
+  FibSnapshotFullTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FibSnapshotFullTestCase::FibSnapshotFullTestCase ()
+  : TestCase ("Write full snapshots without delta encoding")
+{
+}
+
+void
+FibSnapshotFullTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateNodes (nodes);
+  uint32_t nRoutes0 = GetStaticRouting (nodes.Get (0))->GetNRoutes ();
+
+  std::string filename = "fib-snapshot-helper-test-full.bin";
+  Ptr<FibSnapshotHelper> snapshots = CreateObject<FibSnapshotHelper> ();
+  snapshots->SetAttribute ("DeltaEncoding", BooleanValue (false));
+  NS_TEST_ASSERT_MSG_EQ (snapshots->Open (filename), true, "snapshot file not created");
+  snapshots->Install (nodes);
+  snapshots->SnapshotEvery (Seconds (1), Seconds (1), Seconds (3));
+  Simulator::Schedule (Seconds (1.5), &AddRoute, nodes.Get (0), "192.168.0.0");
+  Simulator::Stop (Seconds (5));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (snapshots->GetNSnapshots (), 3, "snapshots taken");
+  snapshots->Dispose ();
+  Simulator::Destroy ();
+
+  std::vector<FibSnapshotHelper::RecordHeader> headers = ReadHeaders (filename);
+  ::remove (filename.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (headers.size (), 6, "a record per node and snapshot");
+  for (uint32_t r = 0; r < headers.size (); r++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (headers[r].m_flags, (uint32_t) FibSnapshotHelper::FULL,
+                             "record " << r);
+      NS_TEST_ASSERT_MSG_EQ (headers[r].m_nRemoved, 0, "routes removed in record " << r);
+    }
+  NS_TEST_ASSERT_MSG_EQ (headers[0].m_nAdded, nRoutes0, "routes of node 0 at 1 s");
+  NS_TEST_ASSERT_MSG_EQ (headers[2].m_nAdded, nRoutes0 + 1, "routes of node 0 at 2 s");
+  NS_TEST_ASSERT_MSG_EQ (headers[4].m_nAdded, nRoutes0 + 1, "routes of node 0 at 3 s");
+  NS_TEST_ASSERT_MSG_EQ (headers[5].m_nAdded, headers[1].m_nAdded, "routes of node 1");
+}
+
+static class FibSnapshotHelperTestSuite : public TestSuite
+{
+public:
+  FibSnapshotHelperTestSuite ();
+} g_fibSnapshotHelperTests;
+
+FibSnapshotHelperTestSuite::FibSnapshotHelperTestSuite ()
+  : TestSuite ("fib-snapshot-helper", UNIT)
+{
+  AddTestCase (new FibSnapshotDeltaTestCase (), TestCase::QUICK);
+  AddTestCase (new FibSnapshotFullTestCase (), TestCase::QUICK);
+}
+
+} // namespace ns3
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/link-address-allocator.h"
+#include "abort-checker.h"
+
+using namespace ns3;
+namespace ns3 {
+
+/**
+ * Addresses of both ends of /30 and /31 links, numbered across pools,
+ * and their lookup.
+ */
+class LinkAddressIpv4TestCase : public TestCase
+{
+public:
+  LinkAddressIpv4TestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LinkAddressIpv4TestCase::LinkAddressIpv4TestCase ()
+  : TestCase ("Allocate and look up IPv4 /30 and /31 links")
+{
+}
+
+void
+LinkAddressIpv4TestCase::DoRun (void)
+{
+  LinkAddressAllocator addresses;
+  uint32_t p30 = addresses.AddPool (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 30);
+  uint32_t p31 = addresses.AddPool (Ipv4Address ("10.2.0.0"), Ipv4Mask ("255.255.255.0"), 31);
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetNFree (p30), 16384, "/30 subnets of a /16");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetNFree (p31), 128, "/31 subnets of a /24");
+
+  // links are numbered in allocation order across the pools
+  uint32_t a = addresses.Allocate (p30);
+  uint32_t b = addresses.Allocate (p31);
+  uint32_t c = addresses.Allocate (p30);
+  uint32_t d = addresses.Allocate (p31);
+  NS_TEST_ASSERT_MSG_EQ (a, 0, "first link");
+  NS_TEST_ASSERT_MSG_EQ (d, 3, "fourth link");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetPool (c), p30, "pool of a link");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetNFree (p30), 16382, "two /30 subnets taken");
+
+  // /30: the hosts are .1 and .2 of the subnet
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetPrefixLength (a), 30, "/30 link");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress (a, 0), Ipv4Address ("10.1.0.1"), "/30 side 0");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress (a, 1), Ipv4Address ("10.1.0.2"), "/30 side 1");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress (c, 0), Ipv4Address ("10.1.0.5"), "second /30 side 0");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress (c, 1), Ipv4Address ("10.1.0.6"), "second /30 side 1");
+
+  // /31: the hosts are the two addresses of the subnet
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetPrefixLength (b), 31, "/31 link");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress (b, 0), Ipv4Address ("10.2.0.0"), "/31 side 0");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress (b, 1), Ipv4Address ("10.2.0.1"), "/31 side 1");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress (d, 0), Ipv4Address ("10.2.0.2"), "second /31 side 0");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress (d, 1), Ipv4Address ("10.2.0.3"), "second /31 side 1");
+
+  for (uint32_t link = 0; link < addresses.GetNLinks (); link++)
+    {
+      for (uint32_t side = 0; side < 2; side++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (addresses.GetAddress (link, side)), link,
+                                 "lookup of side " << side << " of link " << link);
+        }
+    }
+
+  // network and broadcast addresses of a /30 are not on the link
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv4Address ("10.1.0.0")),
+                         LinkAddressAllocator::NO_LINK, "network of a /30");
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv4Address ("10.1.0.3")),
+                         LinkAddressAllocator::NO_LINK, "broadcast of a /30");
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv4Address ("10.1.0.4")),
+                         LinkAddressAllocator::NO_LINK, "network of the second /30");
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv4Address ("10.1.0.7")),
+                         LinkAddressAllocator::NO_LINK, "broadcast of the second /30");
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv4Address ("10.1.0.9")),
+                         LinkAddressAllocator::NO_LINK, "subnet not allocated yet");
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv4Address ("10.2.0.4")),
+                         LinkAddressAllocator::NO_LINK, "/31 not allocated yet");
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv4Address ("10.3.0.1")),
+                         LinkAddressAllocator::NO_LINK, "address out of the pools");
+}
+
+/**
+ * Addresses of both ends of IPv6 /127 links and their lookup.
+ */
+class LinkAddressIpv6TestCase : public TestCase
+{
+public:
+  LinkAddressIpv6TestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LinkAddressIpv6TestCase::LinkAddressIpv6TestCase ()
+  : TestCase ("Allocate and look up IPv6 /127 links")
+{
+}
+
+void
+LinkAddressIpv6TestCase::DoRun (void)
+{
+  LinkAddressAllocator addresses;
+  uint32_t pool = addresses.AddPool (Ipv6Address ("2001:db8:0:1::"), Ipv6Prefix (64));
+  addresses.AddPool (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 30);
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetNFree (pool), 0xffffffff, "subnets of a /64, capped");
+
+  uint32_t a = addresses.Allocate (pool);
+  uint32_t b = addresses.Allocate (pool);
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetPrefixLength (a), 127, "/127 link");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress6 (a, 0), Ipv6Address ("2001:db8:0:1::"), "side 0");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress6 (a, 1), Ipv6Address ("2001:db8:0:1::1"), "side 1");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress6 (b, 0), Ipv6Address ("2001:db8:0:1::2"),
+                         "second link side 0");
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetAddress6 (b, 1), Ipv6Address ("2001:db8:0:1::3"),
+                         "second link side 1");
+
+  for (uint32_t link = a; link <= b; link++)
+    {
+      for (uint32_t side = 0; side < 2; side++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (addresses.GetAddress6 (link, side)), link,
+                                 "lookup of side " << side << " of link " << link);
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv6Address ("2001:db8:0:1::4")),
+                         LinkAddressAllocator::NO_LINK, "subnet not allocated yet");
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv6Address ("2001:db8:0:2::")),
+                         LinkAddressAllocator::NO_LINK, "address out of the pools");
+  // the IPv4 pool does not answer for IPv6 addresses
+  NS_TEST_ASSERT_MSG_EQ (addresses.LookupLink (Ipv6Address ("::a01:1")),
+                         LinkAddressAllocator::NO_LINK, "IPv4 pool looked up with IPv6");
+}
+
+static void
+Allocate (LinkAddressAllocator *addresses, uint32_t pool)
+{
+  addresses->Allocate (pool);
+}
+
+/**
+ * Allocating from a full pool aborts rather than wrapping into the next
+ * network.
+ */
+class LinkAddressExhaustedTestCase : public TestCase
+{
+public:
+  LinkAddressExhaustedTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LinkAddressExhaustedTestCase::LinkAddressExhaustedTestCase ()
+  : TestCase ("Abort when a pool is exhausted")
+{
+}
+
+void
+LinkAddressExhaustedTestCase::DoRun (void)
+{
+  LinkAddressAllocator addresses;
+  uint32_t pool = addresses.AddPool (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.255.252"), 31);
+  addresses.Allocate (pool);
+  addresses.Allocate (pool);
+  NS_TEST_ASSERT_MSG_EQ (addresses.GetNFree (pool), 0, "two /31 in a /30");
+
+  NS_TEST_ASSERT_MSG_EQ (CallAborts (MakeBoundCallback (&Allocate, &addresses, pool)), true,
+                         "link allocated from an exhausted pool");
+}
+
+static class LinkAddressAllocatorTestSuite : public TestSuite
+{
+public:
+  LinkAddressAllocatorTestSuite ();
+} g_linkAddressAllocatorTests;
+
+LinkAddressAllocatorTestSuite::LinkAddressAllocatorTestSuite ()
+  : TestSuite ("link-address-allocator", UNIT)
+{
+  AddTestCase (new LinkAddressIpv4TestCase (), TestCase::QUICK);
+  AddTestCase (new LinkAddressIpv6TestCase (), TestCase::QUICK);
+  AddTestCase (new LinkAddressExhaustedTestCase (), TestCase::QUICK);
+}
+
+} // namespace ns3
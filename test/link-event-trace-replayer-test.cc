@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/link-event-trace-replayer.h"
+#include <fstream>
+#include <stdio.h>
+
+using namespace ns3;
+namespace ns3 {
+
+/**
+ * Replay a small trace, as CSV or converted to the binary format, with
+ * 10 s windows and check which events each window scheduled and that
+ * they were applied: the event at the end of a window belongs to the
+ * next one and an empty window only moves on to the next.
+ */
+class LinkEventTraceReplayerTestCase : public TestCase
+{
+public:
+  LinkEventTraceReplayerTestCase (bool binary);
+private:
+  struct Probe
+  {
+    uint64_t m_nEvents;
+    bool m_up;
+    Time m_delay;
+  };
+  virtual void DoRun (void);
+  void DoProbe (void);
+
+  bool m_binary;
+  Ptr<LinkEventTraceReplayer> m_replayer;
+  NetDeviceContainer m_links[2];
+  std::vector<Probe> m_probes;
+};
+
+LinkEventTraceReplayerTestCase::LinkEventTraceReplayerTestCase (bool binary)
+  : TestCase (std::string ("Replay a ") + (binary ? "binary" : "CSV") + " link event trace"),
+    m_binary (binary)
+{
+}
+
+void
+LinkEventTraceReplayerTestCase::DoProbe (void)
+{
+  Ptr<NetDevice> device = m_links[0].Get (0);
+  Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+  TimeValue delay;
+  m_links[1].Get (0)->GetChannel ()->GetAttribute ("Delay", delay);
+  Probe probe;
+  probe.m_nEvents = m_replayer->GetNEvents ();
+  probe.m_up = ipv4->IsUp (ipv4->GetInterfaceForDevice (device));
+  probe.m_delay = delay.Get ();
+  m_probes.push_back (probe);
+}
+
+void
+LinkEventTraceReplayerTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+  PointToPointHelper p2p;
+  p2p.SetChannelAttribute ("Delay", StringValue ("1ms"));
+  m_links[0] = p2p.Install (nodes.Get (0), nodes.Get (1));
+  m_links[1] = p2p.Install (nodes.Get (1), nodes.Get (2));
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  address.Assign (m_links[0]);
+  address.NewNetwork ();
+  address.Assign (m_links[1]);
+
+  std::string csv = "link-event-trace-replayer-test.csv";
+  std::string binary = "link-event-trace-replayer-test.bin";
+  {
+    std::ofstream trace (csv.c_str ());
+    trace << "# time(s),link,event[,delay(s)]" << std::endl
+          << "1.0,0,down" << std::endl
+          << std::endl
+          << "  9.999,1,delay,0.005" << std::endl
+          << "10.0,0,up" << std::endl
+          << "15.0,1,delay,0.020" << std::endl
+          << "# nothing from 20 s to 30 s" << std::endl
+          << "35.0,0,down" << std::endl;
+  }
+  std::string filename = csv;
+  if (m_binary)
+    {
+      NS_TEST_ASSERT_MSG_EQ (LinkEventTraceReplayer::ConvertToBinary (csv, binary), 5,
+                             "records converted");
+      // the magic, then the records as they are in memory
+      std::ifstream in (binary.c_str (), std::ios::binary);
+      char magic[8];
+      LinkEventTraceReplayer::Record record[5];
+      in.read (magic, sizeof (magic));
+      in.read (reinterpret_cast<char *> (record), sizeof (record));
+      NS_TEST_ASSERT_MSG_EQ (in.gcount (), (std::streamsize) sizeof (record), "records written");
+      NS_TEST_ASSERT_MSG_EQ (std::string (magic, sizeof (magic)), "LNKEVT1\n", "magic");
+      NS_TEST_ASSERT_MSG_EQ (record[1].m_time, 9999000000LL, "time of the second record");
+      NS_TEST_ASSERT_MSG_EQ (record[1].m_link, 1, "link of the second record");
+      NS_TEST_ASSERT_MSG_EQ (record[1].m_type, LinkEventTraceReplayer::LINK_DELAY,
+                             "type of the second record");
+      NS_TEST_ASSERT_MSG_EQ (record[1].m_value, 5000000, "delay of the second record");
+      NS_TEST_ASSERT_MSG_EQ (record[2].m_type, LinkEventTraceReplayer::LINK_UP,
+                             "type of the third record");
+      filename = binary;
+    }
+
+  m_replayer = CreateObject<LinkEventTraceReplayer> ();
+  m_replayer->SetAttribute ("Window", TimeValue (Seconds (10)));
+  m_replayer->AddLink (m_links[0]);
+  m_replayer->AddLink (m_links[1]);
+  NS_TEST_ASSERT_MSG_EQ (m_replayer->Open (filename), true, "trace not opened");
+  m_replayer->Start ();
+
+  // in every window, and just before the event at the end of the first
+  double times[] = { 0.5, 5, 9.9995, 10.5, 16, 25, 36 };
+  for (uint32_t i = 0; i < sizeof (times) / sizeof (times[0]); i++)
+    {
+      Simulator::Schedule (Seconds (times[i]), &LinkEventTraceReplayerTestCase::DoProbe, this);
+    }
+  Simulator::Stop (Seconds (40));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_replayer = 0;
+  ::remove (csv.c_str ());
+  ::remove (binary.c_str ());
+
+  NS_TEST_ASSERT_MSG_EQ (m_probes.size (), 7, "probes run");
+  // [0, 10 s): the down at 1 s and the delay at 9.999 s, not the up at 10 s
+  NS_TEST_ASSERT_MSG_EQ (m_probes[0].m_nEvents, 2, "events of the first window");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[0].m_up, true, "link down before its event");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[1].m_up, false, "link not down at 1 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[1].m_delay, MilliSeconds (1), "delay changed before 9.999 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[2].m_nEvents, 2, "event at 10 s loaded with the first window");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[2].m_delay, MilliSeconds (5), "delay not changed at 9.999 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[2].m_up, false, "link up before 10 s");
+  // [10 s, 20 s): the up at 10 s and the delay at 15 s
+  NS_TEST_ASSERT_MSG_EQ (m_probes[3].m_nEvents, 4, "events of the second window");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[3].m_up, true, "link not up at 10 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[4].m_delay, MilliSeconds (20), "delay not changed at 15 s");
+  // [20 s, 30 s) is empty; [30 s, 40 s): the down at 35 s
+  NS_TEST_ASSERT_MSG_EQ (m_probes[5].m_nEvents, 4, "events of the empty window");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[5].m_up, true, "link down before 35 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[6].m_nEvents, 5, "events of the fourth window");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[6].m_up, false, "link not down at 35 s");
+}
+
+static class LinkEventTraceReplayerTestSuite : public TestSuite
+{
+public:
+  LinkEventTraceReplayerTestSuite ();
+} g_linkEventTraceReplayerTests;
+
+LinkEventTraceReplayerTestSuite::LinkEventTraceReplayerTestSuite ()
+  : TestSuite ("link-event-trace-replayer", UNIT)
+{
+  AddTestCase (new LinkEventTraceReplayerTestCase (false), TestCase::QUICK);
+  AddTestCase (new LinkEventTraceReplayerTestCase (true), TestCase::QUICK);
+}
+
+} // namespace ns3
@@ -0,0 +1,210 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dce-module.h"
+#include "ns3/csma-helper.h"
+#include "ns3/linux-link-control-helper.h"
+
+using namespace ns3;
+namespace ns3 {
+
+/**
+ * With the ns-3 stack: set the link state of interfaces through Ipv4 and
+ * Ipv6 at the given times, and add addresses to devices that have no
+ * interface yet without bringing them up.
+ */
+class LinuxLinkControlNs3StackTestCase : public TestCase
+{
+public:
+  LinuxLinkControlNs3StackTestCase ();
+private:
+  struct Probe
+  {
+    bool m_up[2];
+    std::string m_name;
+    bool m_extraUp;
+    bool m_extraV6Up;
+  };
+  virtual void DoRun (void);
+  void DoProbe (void);
+  static bool IsUp (Ptr<NetDevice> device);
+
+  NetDeviceContainer m_devices;
+  NetDeviceContainer m_extra;
+  std::vector<Probe> m_probes;
+};
+
+LinuxLinkControlNs3StackTestCase::LinuxLinkControlNs3StackTestCase ()
+  : TestCase ("Control the links and addresses of the ns-3 stack")
+{
+}
+
+bool
+LinuxLinkControlNs3StackTestCase::IsUp (Ptr<NetDevice> device)
+{
+  Ptr<Ipv4> ipv4 = device->GetNode ()->GetObject<Ipv4> ();
+  int32_t interface = ipv4->GetInterfaceForDevice (device);
+  return interface != -1 && ipv4->IsUp (interface);
+}
+
+void
+LinuxLinkControlNs3StackTestCase::DoProbe (void)
+{
+  Probe probe;
+  probe.m_up[0] = IsUp (m_devices.Get (0));
+  probe.m_up[1] = IsUp (m_devices.Get (1));
+  probe.m_name = LinuxLinkControlHelper::GetInterfaceName (m_extra.Get (0));
+  probe.m_extraUp = IsUp (m_extra.Get (0));
+  Ptr<Ipv6> ipv6 = m_extra.Get (1)->GetNode ()->GetObject<Ipv6> ();
+  int32_t interface = ipv6->GetInterfaceForDevice (m_extra.Get (1));
+  probe.m_extraV6Up = interface != -1 && ipv6->IsUp (interface);
+  m_probes.push_back (probe);
+}
+
+void
+LinuxLinkControlNs3StackTestCase::DoRun (void)
+{
+  // a CSMA link with Ipv4 interfaces (ns3-device1 after the loopback),
+  // and a second one installed after the stack, without interfaces
+  NodeContainer nodes;
+  nodes.Create (2);
+  CsmaHelper csma;
+  m_devices = csma.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (m_devices);
+  m_extra = csma.Install (nodes);
+
+  NS_TEST_ASSERT_MSG_EQ (LinuxLinkControlHelper::GetInterfaceName (m_devices.Get (0)),
+                         "ns3-device1", "name of the first link");
+  NS_TEST_ASSERT_MSG_EQ (LinuxLinkControlHelper::GetInterfaceName (m_extra.Get (0)), "",
+                         "name of a device without Ipv4 interface");
+
+  LinuxLinkControlHelper links;
+  links.SetLinkDown (m_devices, Seconds (1));
+  links.SetLinkUp (m_devices.Get (0), Seconds (2));
+  links.AddAddress (m_extra.Get (0), Seconds (0.5), "10.0.1.1/24");
+  links.AddAddress (m_extra.Get (1), Seconds (0.5), Ipv4Address ("10.0.1.2"), 24);
+  links.AddAddress (m_extra.Get (1), Seconds (0.5), "2001:db8:0:1::2/64");
+  links.SetLinkUp (m_extra, Seconds (1.5));
+
+  double times[] = { 0.25, 0.75, 1.25, 1.75, 2.25 };
+  for (uint32_t i = 0; i < sizeof (times) / sizeof (times[0]); i++)
+    {
+      Simulator::Schedule (Seconds (times[i]), &LinuxLinkControlNs3StackTestCase::DoProbe, this);
+    }
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+
+  // the addresses added, with their prefix length
+  Ptr<Ipv4> ipv4 = m_extra.Get (1)->GetNode ()->GetObject<Ipv4> ();
+  int32_t interface = ipv4->GetInterfaceForDevice (m_extra.Get (1));
+  NS_TEST_ASSERT_MSG_EQ (interface, 2, "Ipv4 interface of the second link");
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetNAddresses (interface), 1, "Ipv4 addresses of the second link");
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetAddress (interface, 0).GetLocal (), Ipv4Address ("10.0.1.2"),
+                         "Ipv4 address of the second link");
+  NS_TEST_ASSERT_MSG_EQ (ipv4->GetAddress (interface, 0).GetMask (), Ipv4Mask ("255.255.255.0"),
+                         "Ipv4 mask of the second link");
+  Ptr<Ipv6> ipv6 = m_extra.Get (1)->GetNode ()->GetObject<Ipv6> ();
+  interface = ipv6->GetInterfaceForDevice (m_extra.Get (1));
+  bool found = false;
+  for (uint32_t i = 0; interface != -1 && i < ipv6->GetNAddresses (interface); i++)
+    {
+      Ipv6InterfaceAddress ifAddress = ipv6->GetAddress (interface, i);
+      found |= ifAddress.GetAddress () == Ipv6Address ("2001:db8:0:1::2")
+        && ifAddress.GetPrefix () == Ipv6Prefix (64);
+    }
+  NS_TEST_ASSERT_MSG_EQ (found, true, "Ipv6 address of the second link");
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_probes.size (), 5, "probes run");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[0].m_up[0], true, "first link down before 1 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[0].m_name, "", "name before the address is added");
+  // an added address does not bring the interface up
+  NS_TEST_ASSERT_MSG_EQ (m_probes[1].m_name, "ns3-device2", "name once the address is added");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[1].m_extraUp, false, "Ipv4 interface up with its address");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[1].m_extraV6Up, false, "Ipv6 interface up with its address");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[2].m_up[0], false, "first link not down at 1 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[2].m_up[1], false, "both ends not down at 1 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[3].m_extraUp, true, "Ipv4 interface not up at 1.5 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[3].m_extraV6Up, true, "Ipv6 interface not up at 1.5 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[4].m_up[0], true, "first end not up at 2 s");
+  NS_TEST_ASSERT_MSG_EQ (m_probes[4].m_up[1], false, "other end up with the first one");
+}
+
+/**
+ * With the Linux stack the interfaces are named after the ifindex of the
+ * devices, whatever their Ipv4 interface.
+ */
+class LinuxLinkControlLinuxStackTestCase : public TestCase
+{
+public:
+  LinuxLinkControlLinuxStackTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LinuxLinkControlLinuxStackTestCase::LinuxLinkControlLinuxStackTestCase ()
+  : TestCase ("Name the interfaces of the Linux stack")
+{
+}
+
+void
+LinuxLinkControlLinuxStackTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  CsmaHelper csma;
+  NetDeviceContainer first = csma.Install (nodes);
+  NetDeviceContainer second = csma.Install (nodes);
+  DceManagerHelper processManager;
+  processManager.SetNetworkStack ("ns3::LinuxSocketFdFactory",
+                                  "Library", StringValue ("liblinux.so"));
+  processManager.Install (nodes);
+
+  NS_TEST_ASSERT_MSG_EQ (LinuxLinkControlHelper::GetInterfaceName (first.Get (0)), "sim0",
+                         "name of the first link");
+  NS_TEST_ASSERT_MSG_EQ (LinuxLinkControlHelper::GetInterfaceName (second.Get (1)), "sim1",
+                         "name of the second link");
+
+  Simulator::Destroy ();
+}
+
+static class LinuxLinkControlHelperTestSuite : public TestSuite
+{
+public:
+  LinuxLinkControlHelperTestSuite ();
+} g_linuxLinkControlHelperTests;
+
+LinuxLinkControlHelperTestSuite::LinuxLinkControlHelperTestSuite ()
+  : TestSuite ("linux-link-control-helper", UNIT)
+{
+  AddTestCase (new LinuxLinkControlNs3StackTestCase (), TestCase::QUICK);
+  TypeId tid;
+  if (TypeId::LookupByNameFailSafe ("ns3::LinuxSocketFdFactory", &tid)
+      && SearchExecFile ("DCE_PATH", "liblinux.so", 0).length () > 0)
+    {
+      AddTestCase (new LinuxLinkControlLinuxStackTestCase (), TestCase::QUICK);
+    }
+}
+
+} // namespace ns3
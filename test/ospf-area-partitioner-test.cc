@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/ospf-area-partitioner.h"
+#include <vector>
+
+using namespace ns3;
+namespace ns3 {
+
+typedef std::vector<std::pair<uint32_t, uint32_t> > EdgeList;
+
+/*
+ * Number of connected pieces the members form with the edges; every
+ * edge joins two members.
+ */
+static uint32_t
+CountPieces (const std::vector<bool> &member, const EdgeList &edges)
+{
+  uint32_t n = member.size ();
+  std::vector<std::vector<uint32_t> > adj (n);
+  for (EdgeList::const_iterator e = edges.begin (); e != edges.end (); ++e)
+    {
+      adj[e->first].push_back (e->second);
+      adj[e->second].push_back (e->first);
+    }
+  std::vector<bool> seen (n, false);
+  std::vector<uint32_t> queue;
+  uint32_t pieces = 0;
+  for (uint32_t s = 0; s < n; s++)
+    {
+      if (!member[s] || seen[s])
+        {
+          continue;
+        }
+      pieces++;
+      seen[s] = true;
+      queue.clear ();
+      queue.push_back (s);
+      for (uint32_t head = 0; head < queue.size (); head++)
+        {
+          uint32_t v = queue[head];
+          for (uint32_t i = 0; i < adj[v].size (); i++)
+            {
+              if (!seen[adj[v][i]])
+                {
+                  seen[adj[v][i]] = true;
+                  queue.push_back (adj[v][i]);
+                }
+            }
+        }
+    }
+  return pieces;
+}
+
+/**
+ * Partition a topology into areas and check that every router is in an
+ * area, that the routers and the links of every area are in one piece,
+ * that the areas are of similar size and that the backbone is connected.
+ */
+class OspfAreaPartitionerTestCase : public TestCase
+{
+public:
+  enum Topology
+  {
+    GRID,       ///< 8x8 grid
+    ROCKETFUEL  ///< ring of 10 PoPs of 6 routers, with chords
+  };
+  OspfAreaPartitionerTestCase (Topology topology, uint32_t nAreas);
+private:
+  virtual void DoRun (void);
+  void Connect (uint32_t a, uint32_t b);
+
+  Topology m_topology;
+  uint32_t m_nAreas;
+  NodeContainer m_nodes;
+  std::vector<NetDeviceContainer> m_links;
+  EdgeList m_edges;
+};
+
+OspfAreaPartitionerTestCase::OspfAreaPartitionerTestCase (Topology topology, uint32_t nAreas)
+  : TestCase (std::string (topology == GRID ? "grid" : "Rocketfuel-like") + " in areas"),
+    m_topology (topology),
+    m_nAreas (nAreas)
+{
+}
+
+void
+OspfAreaPartitionerTestCase::Connect (uint32_t a, uint32_t b)
+{
+  NetDeviceContainer link;
+  uint32_t ends[2] = { a, b };
+  for (uint32_t side = 0; side < 2; side++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      m_nodes.Get (ends[side])->AddDevice (device);
+      link.Add (device);
+    }
+  m_links.push_back (link);
+  m_edges.push_back (std::make_pair (a, b));
+}
+
+void
+OspfAreaPartitionerTestCase::DoRun (void)
+{
+  if (m_topology == GRID)
+    {
+      const uint32_t width = 8;
+      m_nodes.Create (width * width);
+      for (uint32_t y = 0; y < width; y++)
+        {
+          for (uint32_t x = 0; x < width; x++)
+            {
+              if (x + 1 < width)
+                {
+                  Connect (y * width + x, y * width + x + 1);
+                }
+              if (y + 1 < width)
+                {
+                  Connect (y * width + x, (y + 1) * width + x);
+                }
+            }
+        }
+    }
+  else
+    {
+      // a core router per PoP on a ring, access routers hanging off it
+      const uint32_t nPops = 10;
+      const uint32_t popSize = 6;
+      m_nodes.Create (nPops * popSize);
+      for (uint32_t p = 0; p < nPops; p++)
+        {
+          uint32_t core = p * popSize;
+          Connect (core, ((p + 1) % nPops) * popSize);
+          for (uint32_t r = 1; r < popSize; r++)
+            {
+              Connect (core, core + r);
+            }
+          Connect (core + 1, core + 2);
+        }
+      Connect (0, 5 * popSize);
+      Connect (2 * popSize, 7 * popSize);
+    }
+
+  OspfAreaPartitioner partitioner (m_nodes);
+  for (uint32_t l = 0; l < m_links.size (); l++)
+    {
+      partitioner.AddLink (m_links[l]);
+    }
+  partitioner.Partition (m_nAreas);
+
+  uint32_t n = m_nodes.GetN ();
+  std::vector<uint32_t> size (m_nAreas + 1, 0);
+  for (uint32_t v = 0; v < n; v++)
+    {
+      uint32_t area = partitioner.GetNodeArea (v);
+      bool assigned = area >= 1 && area <= m_nAreas;
+      NS_TEST_ASSERT_MSG_EQ (assigned, true, "router " << v << " in area " << area);
+      size[area]++;
+    }
+
+  // within half and one and a half times the average size
+  double average = static_cast<double> (n) / m_nAreas;
+  for (uint32_t a = 1; a <= m_nAreas; a++)
+    {
+      bool balanced = size[a] >= average / 2 && size[a] <= average * 1.5;
+      NS_TEST_ASSERT_MSG_EQ (balanced, true,
+                             "area " << a << " of " << size[a] << " routers out of " << n);
+    }
+
+  for (uint32_t a = 0; a <= m_nAreas; a++)
+    {
+      // the links of the area, and the routers they join
+      std::vector<bool> member (n, false);
+      EdgeList edges;
+      for (uint32_t l = 0; l < m_edges.size (); l++)
+        {
+          if (partitioner.GetLinkArea (l) == a)
+            {
+              member[m_edges[l].first] = true;
+              member[m_edges[l].second] = true;
+              edges.push_back (m_edges[l]);
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (CountPieces (member, edges), 1,
+                             (a == 0 ? "backbone" : "links of an area") << " " << a
+                             << " not in one piece");
+      if (a == 0)
+        {
+          continue;
+        }
+
+      // the routers of the area
+      member.assign (n, false);
+      edges.clear ();
+      for (uint32_t v = 0; v < n; v++)
+        {
+          member[v] = partitioner.GetNodeArea (v) == a;
+        }
+      for (uint32_t l = 0; l < m_edges.size (); l++)
+        {
+          if (member[m_edges[l].first] && member[m_edges[l].second])
+            {
+              edges.push_back (m_edges[l]);
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (CountPieces (member, edges), 1,
+                             "routers of area " << a << " not in one piece");
+    }
+
+  // an ABR has links in the backbone and in its area
+  for (uint32_t v = 0; v < n; v++)
+    {
+      bool backbone = false, area = false;
+      for (uint32_t l = 0; l < m_edges.size (); l++)
+        {
+          if (m_edges[l].first == v || m_edges[l].second == v)
+            {
+              backbone |= partitioner.GetLinkArea (l) == 0;
+              area |= partitioner.GetLinkArea (l) != 0;
+            }
+        }
+      NS_TEST_ASSERT_MSG_EQ (partitioner.IsAbr (v), backbone && area, "ABR flag of router " << v);
+    }
+
+  Simulator::Destroy ();
+}
+
+static class OspfAreaPartitionerTestSuite : public TestSuite
+{
+public:
+  OspfAreaPartitionerTestSuite ();
+} g_ospfAreaPartitionerTests;
+
+OspfAreaPartitionerTestSuite::OspfAreaPartitionerTestSuite ()
+  : TestSuite ("ospf-area-partitioner", UNIT)
+{
+  AddTestCase (new OspfAreaPartitionerTestCase (OspfAreaPartitionerTestCase::GRID, 4),
+               TestCase::QUICK);
+  AddTestCase (new OspfAreaPartitionerTestCase (OspfAreaPartitionerTestCase::ROCKETFUEL, 4),
+               TestCase::QUICK);
+}
+
+} // namespace ns3
@@ -0,0 +1,475 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/network-module.h"
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/dce-module.h"
+#include "ns3/quagga-helper.h"
+#include "ns3/ospf-cost-updater.h"
+#include "ns3/csma-helper.h"
+#include "ns3/point-to-point-helper.h"
+#include "abort-checker.h"
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+using namespace ns3;
+namespace ns3 {
+
+static std::string
+ConfigPath (Ptr<Node> node, std::string daemon)
+{
+  std::ostringstream path;
+  path << "files-" << node->GetId () << "/usr/local/etc/" << daemon << ".conf";
+  return path.str ();
+}
+
+static std::string
+ReadConfig (Ptr<Node> node, std::string daemon)
+{
+  std::ifstream conf (ConfigPath (node, daemon).c_str ());
+  std::ostringstream body;
+  body << conf.rdbuf ();
+  return body.str ();
+}
+
+// replaces the file, not the files hard linked to it
+static void
+WriteConfig (Ptr<Node> node, std::string daemon, std::string body)
+{
+  std::string path = ConfigPath (node, daemon);
+  ::unlink (path.c_str ());
+  std::ofstream conf (path.c_str ());
+  conf << body;
+}
+
+// two nodes on a CSMA link with the ns-3 stack: the link is ns3-device1
+// on both, after the loopback
+static NetDeviceContainer
+CreateNodes (NodeContainer &nodes)
+{
+  nodes.Create (2);
+  CsmaHelper csma;
+  NetDeviceContainer devices = csma.Install (nodes);
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.0");
+  address.Assign (devices);
+  DceManagerHelper processManager;
+  processManager.SetNetworkStack ("ns3::Ns3SocketFdFactory");
+  processManager.Install (nodes);
+  return devices;
+}
+
+// three nodes in a line of point-to-point links with the ns-3 stack:
+// ns3-device1 on n0 and n2, ns3-device1 (to n0) and ns3-device2 (to n2)
+// on n1
+static void
+CreateLine (NodeContainer &nodes, NetDeviceContainer links[2])
+{
+  nodes.Create (3);
+  PointToPointHelper p2p;
+  links[0] = p2p.Install (nodes.Get (0), nodes.Get (1));
+  links[1] = p2p.Install (nodes.Get (1), nodes.Get (2));
+  InternetStackHelper stack;
+  stack.Install (nodes);
+  Ipv4AddressHelper address;
+  address.SetBase ("10.0.0.0", "255.255.255.252");
+  address.Assign (links[0]);
+  address.NewNetwork ();
+  address.Assign (links[1]);
+  DceManagerHelper processManager;
+  processManager.SetNetworkStack ("ns3::Ns3SocketFdFactory");
+  processManager.Install (nodes);
+}
+
+/**
+ * Render the config of every daemon for a small topology and compare
+ * them with the expected files, then install the nodes again and check
+ * that only the configs changed since are written and only the daemons
+ * enabled since are added.
+ */
+class QuaggaConfigRenderTestCase : public TestCase
+{
+public:
+  QuaggaConfigRenderTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+QuaggaConfigRenderTestCase::QuaggaConfigRenderTestCase ()
+  : TestCase ("Render the daemon configs and install again")
+{
+}
+
+void
+QuaggaConfigRenderTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  NetDeviceContainer devices = CreateNodes (nodes);
+  Ptr<Node> n0 = nodes.Get (0);
+  Ptr<Node> n1 = nodes.Get (1);
+
+  QuaggaHelper quagga;
+  quagga.EnableOspf (nodes, "10.0.0.0/24");
+  quagga.SetOspfRouterId (n0, "10.0.0.1");
+  quagga.SetOspfTimers (nodes, 1, 4, 2);
+  quagga.EnableBgp (nodes);
+  quagga.BgpAddNeighbor (n0, "10.0.0.2", quagga.GetAsn (n1));
+  quagga.EnableOspf6 (NodeContainer (n0), "ns3-device1");
+  quagga.EnableRip (NodeContainer (n0), "ns3-device1");
+  uint32_t nApps0 = n0->GetNApplications ();
+  uint32_t nApps1 = n1->GetNApplications ();
+  ApplicationContainer apps = quagga.Install (nodes);
+
+  // zebra, ospfd, bgpd, ospf6d and ripd on n0; zebra, ospfd and bgpd on n1
+  NS_TEST_ASSERT_MSG_EQ (apps.GetN (), 8, "one application per daemon");
+  NS_TEST_ASSERT_MSG_EQ (n0->GetNApplications (), nApps0 + 5, "daemons of n0");
+  NS_TEST_ASSERT_MSG_EQ (n1->GetNApplications (), nApps1 + 3, "daemons of n1");
+
+  // the router-id goes to zebra.conf, which makes ospfd.conf the same
+  // on both nodes
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "zebra"),
+                         "hostname zebra\n"
+                         "password zebra\n"
+                         "log stdout\n"
+                         "router-id 10.0.0.1\n",
+                         "zebra.conf of n0");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n1, "zebra"),
+                         "hostname zebra\n"
+                         "password zebra\n"
+                         "log stdout\n",
+                         "zebra.conf of n1");
+  std::string ospfd = "hostname zebra\n"
+    "password zebra\n"
+    "log stdout\n"
+    "interface ns3-device1\n"
+    " ip ospf hello-interval 1\n"
+    " ip ospf dead-interval 4\n"
+    " ip ospf retransmit-interval 2\n"
+    "!\n"
+    "router ospf \n"
+    "  network 10.0.0.0/24 area 0\n"
+    " redistribute connected\n"
+    "!\n";
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "ospfd"), ospfd, "ospfd.conf of n0");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n1, "ospfd"), ospfd, "ospfd.conf of n1");
+
+  std::ostringstream bgpd;
+  uint32_t asn = quagga.GetAsn (n0);
+  bgpd << "hostname bgpd\n"
+       << "password zebra\n"
+       << "log stdout\n"
+       << "debug bgp\n"
+       << "debug bgp fsm\n"
+       << "debug bgp events\n"
+       << "debug bgp updates\n"
+       << "router bgp " << asn << "\n"
+       << "  bgp router-id 192.168.0." << asn << "\n"
+       << "  neighbor 10.0.0.2 remote-as " << quagga.GetAsn (n1) << "\n"
+       << "  neighbor 10.0.0.2 advertisement-interval 5\n"
+       << "  redistribute connected\n"
+       << "  address-family ipv4 unicast\n"
+       << "   neighbor 10.0.0.2 activate\n"
+       << "   neighbor 10.0.0.2 next-hop-self\n"
+       << "  exit-address-family\n"
+       << "  address-family ipv6 unicast\n"
+       << "   redistribute connected\n"
+       << "  exit-address-family\n"
+       << "!\n";
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "bgpd"), bgpd.str (), "bgpd.conf of n0");
+
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "ospf6d"),
+                         "hostname ospf6d\n"
+                         "password zebra\n"
+                         "log stdout\n"
+                         "service advanced-vty\n"
+                         "interface ns3-device1\n"
+                         " ipv6 ospf6 retransmit-interval 8\n"
+                         "!\n"
+                         "router ospf6\n"
+                         " router-id 255.1.1.0\n"
+                         " interface ns3-device1 area 0.0.0.0\n"
+                         " redistribute connected\n"
+                         "!\n",
+                         "ospf6d.conf of n0");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "ripd"),
+                         "hostname ripd\n"
+                         "password zebra\n"
+                         "log stdout\n"
+                         "service advanced-vty\n"
+                         "router rip\n"
+                         " network ns3-device1\n"
+                         " redistribute connected\n"
+                         "!\n",
+                         "ripd.conf of n0");
+
+  // nothing changed: no file is written and no daemon added
+  WriteConfig (n0, "zebra", "stale\n");
+  WriteConfig (n0, "ospf6d", "stale\n");
+  ApplicationContainer again = quagga.Install (nodes);
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "zebra"), "stale\n", "clean zebra.conf written again");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "ospf6d"), "stale\n", "clean ospf6d.conf written again");
+  NS_TEST_ASSERT_MSG_EQ (again.GetN (), apps.GetN (), "every daemon returned again");
+  for (uint32_t i = 0; i < apps.GetN (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (again.Get (i), apps.Get (i), "daemon " << i << " installed again");
+    }
+  NS_TEST_ASSERT_MSG_EQ (n0->GetNApplications (), nApps0 + 5, "daemons of n0 duplicated");
+  NS_TEST_ASSERT_MSG_EQ (n1->GetNApplications (), nApps1 + 3, "daemons of n1 duplicated");
+
+  // a new router-id only rewrites zebra.conf; ripd is added to n1 only
+  quagga.SetOspfRouterId (n0, "10.0.0.9");
+  quagga.EnableRip (NodeContainer (n1), "ns3-device1");
+  again = quagga.Install (nodes);
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "zebra"),
+                         "hostname zebra\n"
+                         "password zebra\n"
+                         "log stdout\n"
+                         "router-id 10.0.0.9\n",
+                         "dirty zebra.conf of n0");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "ospf6d"), "stale\n", "clean ospf6d.conf written again");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n1, "ripd"),
+                         "hostname ripd\n"
+                         "password zebra\n"
+                         "log stdout\n"
+                         "service advanced-vty\n"
+                         "router rip\n"
+                         " network ns3-device1\n"
+                         " redistribute connected\n"
+                         "!\n",
+                         "ripd.conf of n1");
+  NS_TEST_ASSERT_MSG_EQ (again.GetN (), apps.GetN () + 1, "ripd of n1 returned");
+  NS_TEST_ASSERT_MSG_EQ (n0->GetNApplications (), nApps0 + 5, "daemons of n0 duplicated");
+  NS_TEST_ASSERT_MSG_EQ (n1->GetNApplications (), nApps1 + 4, "ripd of n1 not added");
+
+  // the cost of a delay is rounded and clamped to 1-65535
+  Ptr<Channel> channel = devices.Get (0)->GetChannel ();
+  channel->SetAttribute ("Delay", TimeValue (MicroSeconds (2500)));
+  NS_TEST_ASSERT_MSG_EQ (OspfCostUpdater::GetDelayCost (devices.Get (0), MilliSeconds (1)), 3,
+                         "cost of 2.5 ms in ms");
+  NS_TEST_ASSERT_MSG_EQ (OspfCostUpdater::GetDelayCost (devices.Get (0), MicroSeconds (10)), 250,
+                         "cost of 2.5 ms in 10 us");
+  NS_TEST_ASSERT_MSG_EQ (OspfCostUpdater::GetDelayCost (devices.Get (0), Seconds (1)), 1,
+                         "cost of 2.5 ms in s");
+  NS_TEST_ASSERT_MSG_EQ (OspfCostUpdater::GetDelayCost (devices.Get (0), NanoSeconds (1)), 65535,
+                         "cost of 2.5 ms in ns");
+
+  // costs from the delay, except the one set on n1
+  std::string ospfdHead = "hostname zebra\n"
+    "password zebra\n"
+    "log stdout\n"
+    "interface ns3-device1\n"
+    " ip ospf hello-interval 1\n"
+    " ip ospf dead-interval 4\n"
+    " ip ospf retransmit-interval 2\n";
+  std::string ospfdTail = "!\n"
+    "router ospf \n"
+    "  network 10.0.0.0/24 area 0\n"
+    " redistribute connected\n"
+    "!\n";
+  quagga.SetOspfCostFromDelay (nodes, MicroSeconds (100));
+  quagga.SetOspfCost (NetDeviceContainer (devices.Get (1)), 10);
+  quagga.Install (nodes);
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "ospfd"), ospfdHead + " ip ospf cost 25\n" + ospfdTail,
+                         "ospfd.conf of n0 with the cost of the delay");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n1, "ospfd"), ospfdHead + " ip ospf cost 10\n" + ospfdTail,
+                         "ospfd.conf of n1 with an explicit cost");
+
+  // a new delay changes the cost of n0 only, clamped
+  channel->SetAttribute ("Delay", TimeValue (Seconds (10)));
+  quagga.Install (nodes);
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n0, "ospfd"), ospfdHead + " ip ospf cost 65535\n" + ospfdTail,
+                         "ospfd.conf of n0 with the clamped cost of the delay");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n1, "ospfd"), ospfdHead + " ip ospf cost 10\n" + ospfdTail,
+                         "ospfd.conf of n1 with an explicit cost");
+
+  // without an explicit cost n1 takes the cost of the delay as well
+  quagga.SetOspfCost (NetDeviceContainer (devices.Get (1)), 0);
+  quagga.Install (nodes);
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (n1, "ospfd"), ospfdHead + " ip ospf cost 65535\n" + ospfdTail,
+                         "ospfd.conf of n1 with the cost of the delay");
+
+  Simulator::Destroy ();
+}
+
+static void
+AddAreaAndInstall (QuaggaHelper *quagga, NodeContainer nodes)
+{
+  quagga->EnableOspfArea (nodes, "10.1.0.0/24", 1);
+  quagga->Install (nodes);
+}
+
+/**
+ * With ReleaseConfigs, installing the nodes again is fine as long as
+ * their configs did not change, and aborts once one did: its settings
+ * are gone.
+ */
+class QuaggaReleaseConfigsTestCase : public TestCase
+{
+public:
+  QuaggaReleaseConfigsTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+QuaggaReleaseConfigsTestCase::QuaggaReleaseConfigsTestCase ()
+  : TestCase ("Abort on a config changed after it was released")
+{
+}
+
+void
+QuaggaReleaseConfigsTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateNodes (nodes);
+
+  QuaggaHelper quagga;
+  quagga.SetAttribute ("ReleaseConfigs", BooleanValue (true));
+  quagga.EnableOspf (nodes, "10.0.0.0/24");
+  ApplicationContainer apps = quagga.Install (nodes);
+  ApplicationContainer again = quagga.Install (nodes);
+  NS_TEST_ASSERT_MSG_EQ (again.GetN (), apps.GetN (), "released configs installed again");
+
+  NS_TEST_ASSERT_MSG_EQ (CallAborts (MakeBoundCallback (&AddAreaAndInstall, &quagga, nodes)), true,
+                         "a released config changed and was installed again");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * The OSPF interfaces of point-to-point devices are point-to-point,
+ * unless OspfPointToPoint is false, and SetOspfPointToPoint () overrides
+ * that for some devices either way.
+ */
+class QuaggaOspfPointToPointTestCase : public TestCase
+{
+public:
+  QuaggaOspfPointToPointTestCase (bool pointToPoint);
+private:
+  virtual void DoRun (void);
+
+  bool m_pointToPoint;
+};
+
+QuaggaOspfPointToPointTestCase::QuaggaOspfPointToPointTestCase (bool pointToPoint)
+  : TestCase (std::string ("Render point-to-point OSPF interfaces with OspfPointToPoint ")
+              + (pointToPoint ? "true" : "false")),
+    m_pointToPoint (pointToPoint)
+{
+}
+
+void
+QuaggaOspfPointToPointTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  NetDeviceContainer links[2];
+  CreateLine (nodes, links);
+
+  QuaggaHelper quagga;
+  quagga.SetAttribute ("OspfPointToPoint", BooleanValue (m_pointToPoint));
+  quagga.EnableOspf (nodes, "10.0.0.0/16");
+  // the other way round on the first link
+  quagga.SetOspfPointToPoint (links[0], !m_pointToPoint);
+  quagga.Install (nodes);
+
+  std::string head = "hostname zebra\n"
+    "password zebra\n"
+    "log stdout\n";
+  std::string tail = "router ospf \n"
+    "  network 10.0.0.0/16 area 0\n"
+    " redistribute connected\n"
+    "!\n";
+  std::string first = m_pointToPoint ? " ip ospf network broadcast\n"
+    : " ip ospf network point-to-point\n";
+  std::string n0 = head + "interface ns3-device1\n" + first + "!\n" + tail;
+  std::string n1 = head + "interface ns3-device1\n" + first + "!\n";
+  std::string n2 = head;
+  // the second link follows the attribute: nothing to write without it
+  if (m_pointToPoint)
+    {
+      n1 += "interface ns3-device2\n ip ospf network point-to-point\n!\n";
+      n2 += "interface ns3-device1\n ip ospf network point-to-point\n!\n";
+    }
+  n1 += tail;
+  n2 += tail;
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (nodes.Get (0), "ospfd"), n0, "ospfd.conf of n0");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (nodes.Get (1), "ospfd"), n1, "ospfd.conf of n1");
+  NS_TEST_ASSERT_MSG_EQ (ReadConfig (nodes.Get (2), "ospfd"), n2, "ospfd.conf of n2");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Attribute defaults set with Config::SetDefault (or NS_ATTRIBUTE_DEFAULT
+ * and the command line) apply to a QuaggaHelper and its configs.
+ */
+class QuaggaAttributeDefaultTestCase : public TestCase
+{
+public:
+  QuaggaAttributeDefaultTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+QuaggaAttributeDefaultTestCase::QuaggaAttributeDefaultTestCase ()
+  : TestCase ("Take the attribute defaults")
+{
+}
+
+void
+QuaggaAttributeDefaultTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  CreateNodes (nodes);
+
+  Config::SetDefault ("ns3::QuaggaHelper::BgpAdvertisementInterval", UintegerValue (7));
+  QuaggaHelper quagga;
+  Config::SetDefault ("ns3::QuaggaHelper::BgpAdvertisementInterval", UintegerValue (5));
+  UintegerValue interval;
+  quagga.GetAttribute ("BgpAdvertisementInterval", interval);
+  NS_TEST_ASSERT_MSG_EQ (interval.Get (), 7, "attribute default not taken");
+
+  quagga.EnableBgp (nodes);
+  quagga.BgpAddNeighbor (nodes.Get (0), "10.0.0.2", quagga.GetAsn (nodes.Get (1)));
+  quagga.Install (nodes);
+  std::string bgpd = ReadConfig (nodes.Get (0), "bgpd");
+  NS_TEST_ASSERT_MSG_NE (bgpd.find ("  neighbor 10.0.0.2 advertisement-interval 7\n"),
+                         std::string::npos, "bgpd.conf of n0 is " << bgpd);
+
+  Simulator::Destroy ();
+}
+
+static class QuaggaHelperTestSuite : public TestSuite
+{
+public:
+  QuaggaHelperTestSuite ();
+} g_quaggaHelperTests;
+
+QuaggaHelperTestSuite::QuaggaHelperTestSuite ()
+  : TestSuite ("quagga-helper", UNIT)
+{
+  AddTestCase (new QuaggaConfigRenderTestCase (), TestCase::QUICK);
+  AddTestCase (new QuaggaReleaseConfigsTestCase (), TestCase::QUICK);
+  AddTestCase (new QuaggaAttributeDefaultTestCase (), TestCase::QUICK);
+  AddTestCase (new QuaggaOspfPointToPointTestCase (true), TestCase::QUICK);
+  AddTestCase (new QuaggaOspfPointToPointTestCase (false), TestCase::QUICK);
+}
+
+} // namespace ns3
@@ -0,0 +1,220 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/quagga-start-policy.h"
+
+using namespace ns3;
+namespace ns3 {
+
+/**
+ * Uniform slots over Window, kept when nodes are created after the
+ * first start time.
+ */
+class QuaggaUniformStartTestCase : public TestCase
+{
+public:
+  QuaggaUniformStartTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+QuaggaUniformStartTestCase::QuaggaUniformStartTestCase ()
+  : TestCase ("Spread the nodes evenly over a window")
+{
+}
+
+void
+QuaggaUniformStartTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  uint32_t n = NodeList::GetNNodes ();
+  Ptr<QuaggaStartPolicy> policy = CreateObject<QuaggaUniformStartPolicy> ();
+  policy->SetAttribute ("Window", TimeValue (Seconds (2)));
+  std::vector<Time> zebra;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Node> node = nodes.Get (i);
+      Time expected = Seconds (1 + 2.0 * node->GetId () / n);
+      zebra.push_back (policy->GetStartTime (node, "zebra"));
+      NS_TEST_ASSERT_MSG_EQ_TOL (zebra[i], expected, NanoSeconds (1), "zebra of node " << i);
+      NS_TEST_ASSERT_MSG_EQ_TOL (policy->GetStartTime (node, "ospfd"), expected + Seconds (4),
+                                 NanoSeconds (1), "ospfd of node " << i);
+    }
+
+  // nodes created since do not move the others
+  NodeContainer more;
+  more.Create (4);
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (policy->GetStartTime (nodes.Get (i), "zebra"), zebra[i],
+                             "zebra of node " << i << " after more nodes");
+    }
+  Ptr<Node> last = more.Get (3);
+  NS_TEST_ASSERT_MSG_EQ_TOL (policy->GetStartTime (last, "zebra"),
+                             Seconds (1 + 2.0 * last->GetId () / n), NanoSeconds (1),
+                             "zebra of a node created after the first start time");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Random offsets in [0, Window), drawn once per node.
+ */
+class QuaggaJitteredStartTestCase : public TestCase
+{
+public:
+  QuaggaJitteredStartTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+QuaggaJitteredStartTestCase::QuaggaJitteredStartTestCase ()
+  : TestCase ("Start the nodes at random times in a window")
+{
+}
+
+void
+QuaggaJitteredStartTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (20);
+  Ptr<QuaggaJitteredStartPolicy> policy = CreateObject<QuaggaJitteredStartPolicy> ();
+  policy->SetAttribute ("Window", TimeValue (Seconds (2)));
+  policy->AssignStreams (1);
+  bool spread = false;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Time zebra = policy->GetStartTime (nodes.Get (i), "zebra");
+      bool inWindow = zebra >= Seconds (1) && zebra < Seconds (3);
+      NS_TEST_ASSERT_MSG_EQ (inWindow, true, "zebra of node " << i << " at " << zebra);
+      NS_TEST_ASSERT_MSG_EQ (policy->GetStartTime (nodes.Get (i), "bgpd"), zebra + Seconds (4),
+                             "bgpd of node " << i);
+      NS_TEST_ASSERT_MSG_EQ (policy->GetStartTime (nodes.Get (i), "zebra"), zebra,
+                             "zebra of node " << i << " asked again");
+      spread |= zebra != policy->GetStartTime (nodes.Get (0), "zebra");
+    }
+  NS_TEST_ASSERT_MSG_EQ (spread, true, "every node at the same time");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Hop by hop from the root over a line of point-to-point links, and an
+ * isolated node after the last hop.
+ */
+class QuaggaBfsStartTestCase : public TestCase
+{
+public:
+  QuaggaBfsStartTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+QuaggaBfsStartTestCase::QuaggaBfsStartTestCase ()
+  : TestCase ("Start the nodes hop by hop from a root")
+{
+}
+
+void
+QuaggaBfsStartTestCase::DoRun (void)
+{
+  // n0 - n1 - n2 - n3, and n4 alone
+  NodeContainer nodes;
+  nodes.Create (5);
+  PointToPointHelper p2p;
+  for (uint32_t i = 0; i + 1 < 4; i++)
+    {
+      p2p.Install (nodes.Get (i), nodes.Get (i + 1));
+    }
+
+  Ptr<QuaggaStartPolicy> policy = CreateObject<QuaggaBfsStartPolicy> ();
+  policy->SetAttribute ("Root", UintegerValue (nodes.Get (1)->GetId ()));
+  policy->SetAttribute ("HopInterval", TimeValue (MilliSeconds (200)));
+  policy->SetAttribute ("Spacing", TimeValue (MicroSeconds (100)));
+  policy->SetAttribute ("ZebraStart", TimeValue (Seconds (0)));
+  // n0 is reached before n2: the link to n0 is the first device of n1
+  Time expected[] = { MilliSeconds (200), Seconds (0), MilliSeconds (200) + MicroSeconds (100),
+                      MilliSeconds (400) };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (policy->GetStartTime (nodes.Get (i), "zebra"), expected[i],
+                                 NanoSeconds (1), "zebra of node " << i);
+    }
+  // one hop after the last, behind the unconnected nodes of lower id
+  bool after = policy->GetStartTime (nodes.Get (4), "zebra") >= MilliSeconds (600);
+  NS_TEST_ASSERT_MSG_EQ (after, true, "zebra of the isolated node");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Waves of WaveSize nodes in node id order.
+ */
+class QuaggaWaveStartTestCase : public TestCase
+{
+public:
+  QuaggaWaveStartTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+QuaggaWaveStartTestCase::QuaggaWaveStartTestCase ()
+  : TestCase ("Start the nodes in waves")
+{
+}
+
+void
+QuaggaWaveStartTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (7);
+  Ptr<QuaggaStartPolicy> policy = CreateObject<QuaggaWaveStartPolicy> ();
+  policy->SetAttribute ("WaveSize", UintegerValue (3));
+  policy->SetAttribute ("WaveInterval", TimeValue (Seconds (1)));
+  policy->SetAttribute ("Spacing", TimeValue (MilliSeconds (10)));
+  policy->SetAttribute ("ZebraStart", TimeValue (Seconds (0)));
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      uint32_t id = nodes.Get (i)->GetId ();
+      Time expected = Seconds (id / 3) + MilliSeconds (10 * (id % 3));
+      NS_TEST_ASSERT_MSG_EQ_TOL (policy->GetStartTime (nodes.Get (i), "zebra"), expected,
+                                 NanoSeconds (1), "zebra of node " << id);
+    }
+
+  Simulator::Destroy ();
+}
+
+static class QuaggaStartPolicyTestSuite : public TestSuite
+{
+public:
+  QuaggaStartPolicyTestSuite ();
+} g_quaggaStartPolicyTests;
+
+QuaggaStartPolicyTestSuite::QuaggaStartPolicyTestSuite ()
+  : TestSuite ("quagga-start-policy", UNIT)
+{
+  AddTestCase (new QuaggaUniformStartTestCase (), TestCase::QUICK);
+  AddTestCase (new QuaggaJitteredStartTestCase (), TestCase::QUICK);
+  AddTestCase (new QuaggaBfsStartTestCase (), TestCase::QUICK);
+  AddTestCase (new QuaggaWaveStartTestCase (), TestCase::QUICK);
+}
+
+} // namespace ns3
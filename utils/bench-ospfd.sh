@@ -1,15 +1,52 @@
 #!/bin/bash
 
+# Sweep the ospfd benchmark over topologies, sizes, fiber managers and
+# loaders.  Every run appends one CSV line (wall time, events/s, peak
+# RSS, process count, OSPF convergence) to ${RESULTS}, tagged with the
+# current commit, so results of successive revisions can be compared.
+#
+# Run from the DCE top directory, e.g.:
+#   SIZES="16 64" TOPOLOGIES="grid leo" ./myscripts/ns-3-dce-quagga/utils/bench-ospfd.sh
+#
+# QuaggaHelper attributes apply to every run through NS_ATTRIBUTE_DEFAULT:
+#   NS_ATTRIBUTE_DEFAULT='ns3::QuaggaHelper::OspfdStackSize=131072' ./.../bench-ospfd.sh
+
 #. ./utils/setenv.sh
-#VERBOSE=""
-STOPTIME=80
-
-echo -n "Cooja (non-vdl) + Pthread:  "
-NS_ATTRIBUTE_DEFAULT='ns3::TaskManager::FiberManagerType=PthreadFiberManager' time ./build/bin/dce-quagga-ospfd-rocketfuel --stopTime=${STOPTIME}  |grep -v Unsupported|grep -v bytes
-echo -n "Cooja (non-vdl) + Ucontext: "
-NS_ATTRIBUTE_DEFAULT='ns3::TaskManager::FiberManagerType=UcontextFiberManager' time ./build/bin/dce-quagga-ospfd-rocketfuel  --stopTime=${STOPTIME} |grep -v Unsupported|grep -v bytes
-
-echo -n "Dlm (vdl) + Pthread:        "
-NS_ATTRIBUTE_DEFAULT='ns3::DceManagerHelper::LoaderFactory=ns3::DlmLoaderFactory[];ns3::TaskManager::FiberManagerType=PthreadFiberManager' time ../build/bin/dce-runner ./build/bin/dce-quagga-ospfd-rocketfuel --stopTime=${STOPTIME}  |grep -v Unsupported|grep -v bytes
-echo -n "Dlm (vdl) + Ucontext:       "
-NS_ATTRIBUTE_DEFAULT='ns3::DceManagerHelper::LoaderFactory=ns3::DlmLoaderFactory[];ns3::TaskManager::FiberManagerType=UcontextFiberManager' time ../build/bin/dce-runner ./build/bin/dce-quagga-ospfd-rocketfuel --stopTime=${STOPTIME}  |grep -v Unsupported |grep -v bytes
+STOPTIME=${STOPTIME:-200}
+RESULTS=${RESULTS:-bench-ospfd.csv}
+TOPOLOGIES=${TOPOLOGIES:-"grid leo rocketfuel caida"}
+SIZES=${SIZES:-"16 64 256"}
+FIBERS=${FIBERS:-"PthreadFiberManager UcontextFiberManager"}
+LOADERS=${LOADERS:-"cooja dlm"}
+BENCH=./build/bin/dce-quagga-ospfd-bench
+COMMIT=$(git -C "$(dirname "$0")" rev-parse --short HEAD 2>/dev/null || echo unknown)
+
+set -o pipefail
+failed=0
+for topology in ${TOPOLOGIES}; do
+  case ${topology} in
+    grid|leo) sizes=${SIZES} ;;
+    *) sizes=0 ;;            # the file gives the size
+  esac
+  for nodes in ${sizes}; do
+    for fiber in ${FIBERS}; do
+      for loader in ${LOADERS}; do
+        runner=""
+        if [ "${loader}" = "dlm" ]; then
+          runner=../build/bin/dce-runner
+        fi
+        echo "${topology} nodes=${nodes} ${fiber} ${loader}"
+        if ! ${runner} ${BENCH} --topology=${topology} --nodes=${nodes} \
+             --fiberManager=${fiber} --loader=${loader} --stopTime=${STOPTIME} \
+             --results=${RESULTS} --commit=${COMMIT} \
+             | grep -v Unsupported | grep -v bytes; then
+          echo "  failed"
+          failed=$((failed + 1))
+        fi
+      done
+    done
+  done
+done
+
+echo "results in ${RESULTS}"
+exit ${failed}